@@ -18,4 +18,21 @@ struct MeshletPayload
 {
     uint instanceIndices[32];
     uint meshletIndices[32];
-};
\ No newline at end of file
+};
+
+#ifndef __cplusplus
+
+#include "gpu_scene.hlsli"
+
+//meshlets of skinned meshes live in the animation buffer, their bounds are refreshed every frame after vertex skinning
+Meshlet LoadMeshlet(InstanceData instanceData, uint meshletIndex)
+{
+    if (instanceData.bVertexAnimation)
+    {
+        return LoadSceneAnimationBuffer<Meshlet>(instanceData.meshletBufferAddress, meshletIndex);
+    }
+    
+    return LoadSceneStaticBuffer<Meshlet>(instanceData.meshletBufferAddress, meshletIndex);
+}
+
+#endif //__cplusplus
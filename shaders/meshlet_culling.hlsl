@@ -93,7 +93,7 @@ void main_as(uint3 dispatchThreadID : SV_DispatchThreadID)
         uint instanceIndex = dataPerMeshlet.x;
         uint meshletIndex = dataPerMeshlet.y;
         
-        Meshlet meshlet = LoadSceneStaticBuffer<Meshlet>(GetInstanceData(instanceIndex).meshletBufferAddress, meshletIndex);
+        Meshlet meshlet = LoadMeshlet(GetInstanceData(instanceIndex), meshletIndex);
         
         visible = Cull(meshlet, instanceIndex, meshletIndex);
         
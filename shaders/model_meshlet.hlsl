@@ -19,7 +19,7 @@ void main_ms(
         return;
     }
     
-    Meshlet meshlet = LoadSceneStaticBuffer<Meshlet>(instanceData.meshletBufferAddress, meshletIndex);
+    Meshlet meshlet = LoadMeshlet(instanceData, meshletIndex);
     
     SetMeshOutputCounts(meshlet.vertexCount, meshlet.triangleCount);
     
@@ -0,0 +1,49 @@
+#include "common.hlsli"
+#include "gpu_scene.hlsli"
+#include "meshlet.hlsli"
+
+cbuffer CB : register(b1)
+{
+    uint c_meshletCount;
+    uint c_meshletBufferAddress;
+    uint c_meshletVerticesBufferAddress;
+
+    uint c_animPosBufferAddress;
+    uint c_animMeshletBufferAddress;
+};
+
+[numthreads(64, 1, 1)]
+void main(uint3 dispatchThreadID : SV_DispatchThreadID)
+{
+    uint meshlet_id = dispatchThreadID.x;
+    if (meshlet_id >= c_meshletCount)
+    {
+        return;
+    }
+
+    Meshlet meshlet = LoadSceneStaticBuffer<Meshlet>(c_meshletBufferAddress, meshlet_id);
+
+    //the animation buffer is in UAV state during the animation pass
+    RWByteAddressBuffer animationBuffer = ResourceDescriptorHeap[SceneCB.sceneAnimationBufferUAV];
+
+    float3 bound_min = asfloat(0x7f7fffff);
+    float3 bound_max = -asfloat(0x7f7fffff);
+
+    for (uint i = 0; i < meshlet.vertexCount; ++i)
+    {
+        uint vertex_id = LoadSceneStaticBuffer<uint>(c_meshletVerticesBufferAddress, meshlet.vertexOffset + i);
+        float3 pos = animationBuffer.Load<float3>(c_animPosBufferAddress + sizeof(float3) * vertex_id);
+
+        bound_min = min(bound_min, pos);
+        bound_max = max(bound_max, pos);
+    }
+
+    meshlet.center = (bound_min + bound_max) * 0.5;
+    meshlet.radius = length(bound_max - bound_min) * 0.5;
+
+    //the normal cone is baked in bind pose and is not valid after skinning,
+    //axis (0, 0, 1) with a cutoff of 1.0 never passes the backface test
+    meshlet.cone = 0x7f7f0000;
+
+    StoreSceneAnimationBuffer<Meshlet>(c_animMeshletBufferAddress, meshlet_id, meshlet);
+}
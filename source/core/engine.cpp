@@ -1,4 +1,5 @@
 #include "engine.h"
+#include "renderer/pipeline_cache.h"
 #include "utils/log.h"
 #include "utils/profiler.h"
 #include "utils/system.h"
@@ -50,6 +51,13 @@ void Engine::Init(const eastl::string& work_path, void* window_handle, uint32_t
     m_pRenderer = eastl::make_unique<Renderer>();
     m_pRenderer->CreateDevice(window_handle, window_width, window_height);
     m_pRenderer->SetAsyncComputeEnabled(m_configIni.GetBoolValue("Render", "AsyncCompute"));
+    m_pRenderer->GetPipelineStateCache()->SetAsyncCreation(m_configIni.GetBoolValue("Render", "AsyncPipelineCreation"));
+    m_pRenderer->GetRenderGraph()->SetHeapPoolBudget((uint64_t)m_configIni.GetLongValue("Render", "HeapPoolBudgetMB", 512) * 1024 * 1024);
+
+    if (m_configIni.GetBoolValue("Render", "PipelineWarmUp"))
+    {
+        m_pRenderer->GetPipelineStateCache()->LoadManifest(m_workPath + "pipeline_manifest.bin");
+    }
 
     m_pWorld = eastl::make_unique<World>();
     m_pWorld->LoadScene(m_assetPath + m_configIni.GetValue("World", "Scene"));
@@ -64,6 +72,14 @@ void Engine::Init(const eastl::string& work_path, void* window_handle, uint32_t
 
 void Engine::Shut()
 {
+    //the compile and PSO tasks add to the cached shaders and PSOs, which are written to the manifest and the pipeline cache
+    PipelineStateCache* pipelineCache = m_pRenderer->GetPipelineStateCache();
+    m_pRenderer->GetShaderCache()->WaitForCompilation();
+    pipelineCache->WaitForCreation();
+
+    pipelineCache->SaveManifest(m_workPath + "pipeline_manifest.bin");
+    pipelineCache->SavePipelineCache(m_workPath + "pipeline_cache.bin");
+
     m_pTaskScheduler->WaitforAllAndShutdown();
     m_pTaskScheduler.reset();
 
@@ -2,6 +2,7 @@
 
 #include "renderer/renderer.h"
 #include "EASTL/functional.h"
+#include <mutex>
 
 class GUI
 {
@@ -13,7 +14,11 @@ public:
     void Tick();
     void Render(IGfxCommandList* pCommandList);
 
-    void AddCommand(const eastl::function<void()>& command) { m_commands.push_back(command); }
+    void AddCommand(const eastl::function<void()>& command)
+    {
+        std::lock_guard<std::mutex> lock(m_commandMutex);
+        m_commands.push_back(command);
+    }
 
 private:
     void SetupRenderStates(IGfxCommandList* pCommandList, uint32_t frame_index);
@@ -27,4 +32,5 @@ private:
     eastl::unique_ptr<IndexBuffer> m_pIndexBuffer[GFX_MAX_INFLIGHT_FRAMES];
 
     std::vector<eastl::function<void()>> m_commands;
+    std::mutex m_commandMutex;
 };
\ No newline at end of file
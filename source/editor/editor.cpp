@@ -1,7 +1,11 @@
 #include "editor.h"
 #include "core/engine.h"
+#include "renderer/render_graph_benchmark.h"
+#include "renderer/renderer_tests.h"
 #include "renderer/texture_loader.h"
+#include "world/animation_benchmark.h"
 #include "utils/assert.h"
+#include "utils/log.h"
 #include "utils/system.h"
 #include "imgui/imgui.h"
 #include "ImFileDialog/ImFileDialog.h"
@@ -63,6 +67,7 @@ void Editor::Tick()
 
 void Editor::AddGuiCommand(const eastl::string& window, const eastl::string& section, const eastl::function<void()>& command)
 {
+    std::lock_guard<std::mutex> lock(m_commandMutex);
     m_commands[window].push_back({ section, command });
 }
 
@@ -146,6 +151,33 @@ void Editor::DrawMenu()
                 ShowRenderGraph();
             }
 
+            if (ImGui::MenuItem("Capture Render Graph", ""))
+            {
+                Engine* pEngine = Engine::GetInstance();
+                pEngine->GetRenderer()->GetRenderGraph()->CaptureTopology(pEngine->GetWorkPath() + "rendergraph.bin");
+            }
+
+            if (ImGui::MenuItem("Export Render Graph Memory", ""))
+            {
+                Engine* pEngine = Engine::GetInstance();
+                pEngine->GetRenderer()->GetRenderGraph()->ExportMemoryTimeline(pEngine->GetWorkPath() + "rendergraph_memory.json");
+            }
+
+            if (ImGui::MenuItem("Benchmark Render Graph Compile", ""))
+            {
+                BenchmarkRenderGraph();
+            }
+
+            if (ImGui::MenuItem("Benchmark Animation", ""))
+            {
+                BenchmarkAnimation();
+            }
+
+            if (ImGui::MenuItem("Run Renderer Tests", ""))
+            {
+                RunRendererTests();
+            }
+
             ImGui::MenuItem("Imgui Demo", "", &m_bShowImguiDemo);
 
             ImGui::EndMenu();
@@ -341,6 +373,19 @@ void Editor::DrawFrameStats()
     ImGui::Begin("Frame Stats", nullptr, ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_NoBackground |
         ImGuiWindowFlags_NoScrollWithMouse | ImGuiWindowFlags_NoNavInputs | ImGuiWindowFlags_NoNavFocus);
     ImGui::Text("%.3f ms/frame (%.1f FPS)", 1000.0f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
+
+    const RenderGraphBarrierStats& barrierStats = Engine::GetInstance()->GetRenderer()->GetRenderGraph()->GetBarrierStats();
+    ImGui::Text("Barriers : %u (split %u)", barrierStats.transitionBarriers, barrierStats.splitBarriers);
+    ImGui::Text("UAV/Aliasing Barriers : %u/%u", barrierStats.uavBarriers, barrierStats.aliasingBarriers);
+
+    const RenderGraphDescriptorCacheStats& descriptorStats = Engine::GetInstance()->GetRenderer()->GetRenderGraph()->GetDescriptorCacheStats();
+    ImGui::Text("View Cache : %u/%u (hit/miss)", descriptorStats.hits, descriptorStats.misses);
+
+    const RGReorderResult& reorderResult = Engine::GetInstance()->GetRenderer()->GetRenderGraph()->GetReorderResult();
+    if (reorderResult.peakBytesBefore > 0)
+    {
+        ImGui::Text("Transient Peak : %.1f/%.1f MB", reorderResult.peakBytesAfter / (1024.0f * 1024.0f), reorderResult.peakBytesBefore / (1024.0f * 1024.0f));
+    }
     ImGui::End();
 }
 
@@ -383,6 +428,41 @@ void Editor::ShowRenderGraph()
     }
 }
 
+void Editor::BenchmarkRenderGraph()
+{
+    eastl::string file = Engine::GetInstance()->GetWorkPath() + "rendergraph.bin";
+
+    RGCompileBenchmarkResult result;
+    if (BenchmarkRenderGraphCompile(file, 100, false, false, result))
+    {
+        RE_LOG("render graph compile : {} passes ({} culled), {} resource nodes, {} edges", result.passes, result.culledPasses, result.resourceNodes, result.edges);
+        RE_LOG("    min {:.3f} ms, avg {:.3f} ms, max {:.3f} ms ({} iterations)", result.minTime, result.avgTime, result.maxTime, result.iterations);
+        RE_LOG("    barriers : {} (split {}), uav/aliasing barriers : {}/{}", result.barrierStats.transitionBarriers, result.barrierStats.splitBarriers,
+            result.barrierStats.uavBarriers, result.barrierStats.aliasingBarriers);
+    }
+}
+
+void Editor::BenchmarkAnimation()
+{
+    AnimationBenchmarkResult result;
+    if (::BenchmarkAnimation("model/biped_robot/scene.gltf", 1000, 100, 1.0f / 60.0f, result))
+    {
+        RE_LOG("animation update : {} instances, {} nodes, {} joints", result.instances, result.nodes, result.joints);
+        RE_LOG("    min {:.3f} ms, avg {:.3f} ms, max {:.3f} ms ({} ticks)", result.minTime, result.avgTime, result.maxTime, result.ticks);
+    }
+}
+
+void Editor::RunRendererTests()
+{
+    Engine* pEngine = Engine::GetInstance();
+
+    bool result = TestAsyncComputeScheduling();
+    result &= TestParallelSetup();
+    result &= TestPipelineCacheWarmUp(pEngine->GetWorkPath() + "pipeline_manifest.bin", pEngine->GetWorkPath() + "pipeline_cache_test.bin");
+
+    RE_LOG("renderer tests : {}", result ? "passed" : "failed");
+}
+
 void Editor::FlushPendingTextureDeletions()
 {
     for (size_t i = 0; i < m_pendingDeletions.size(); ++i)
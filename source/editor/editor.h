@@ -3,6 +3,7 @@
 #include "renderer/renderer.h"
 #include "EASTL/hash_map.h"
 #include "EASTL/functional.h"
+#include <mutex>
 
 class Editor
 {
@@ -12,6 +13,7 @@ public:
 
     void Tick();
 
+    //thread-safe, the render graph setup tasks may run on the worker threads (see RenderGraph::RunSetupTasks)
     void AddGuiCommand(const eastl::string& window, const eastl::string& section, const eastl::function<void()>& command);
 
 private:
@@ -22,6 +24,9 @@ private:
 
     void CreateGpuMemoryStats();
     void ShowRenderGraph();
+    void BenchmarkRenderGraph();
+    void BenchmarkAnimation();
+    void RunRendererTests();
     void FlushPendingTextureDeletions();
 
     void DrawWindow(const eastl::string& window, bool* open);
@@ -46,6 +51,7 @@ private:
     };
     using WindowCommand = eastl::vector<Command>;
     eastl::hash_map<eastl::string, WindowCommand> m_commands;
+    std::mutex m_commandMutex;
 
     eastl::hash_map<IGfxDescriptor*, Texture2D*> m_fileDialogIcons;
     eastl::vector<IGfxDescriptor*> m_pendingDeletions;
@@ -366,10 +366,11 @@ void D3D12CommandList::UpdateTileMappings(IGfxTexture* texture, IGfxHeap* heap,
         D3D12_TILE_MAPPING_FLAG_NONE);
 }
 
-void D3D12CommandList::ResourceBarrier(IGfxResource* resource, uint32_t sub_resource, GfxResourceState old_state, GfxResourceState new_state)
+void D3D12CommandList::ResourceBarrier(IGfxResource* resource, uint32_t sub_resource, GfxResourceState old_state, GfxResourceState new_state, GfxBarrierFlag flag)
 {
     D3D12_RESOURCE_BARRIER barrier = {};
     barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+    barrier.Flags = d3d12_barrier_flag(flag);
     barrier.Transition.pResource = (ID3D12Resource*)resource->GetHandle();
     barrier.Transition.Subresource = sub_resource;
     barrier.Transition.StateBefore = d3d12_resource_state(old_state);
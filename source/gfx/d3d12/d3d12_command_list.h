@@ -39,7 +39,7 @@ public:
     virtual void WriteBuffer(IGfxBuffer* buffer, uint32_t offset, uint32_t data) override;
     virtual void UpdateTileMappings(IGfxTexture* texture, IGfxHeap* heap, uint32_t mapping_count, const GfxTileMapping* mappings) override;
 
-    virtual void ResourceBarrier(IGfxResource* resource, uint32_t sub_resource, GfxResourceState old_state, GfxResourceState new_state) override;
+    virtual void ResourceBarrier(IGfxResource* resource, uint32_t sub_resource, GfxResourceState old_state, GfxResourceState new_state, GfxBarrierFlag flag = GfxBarrierFlag::None) override;
     virtual void UavBarrier(IGfxResource* resource) override;
     virtual void AliasingBarrier(IGfxResource* resource_before, IGfxResource* resource_after) override;
     virtual void FlushBarriers() override;
@@ -79,6 +79,7 @@ D3D12Device::~D3D12Device()
     SAFE_RELEASE(m_pMultiDispatchSignature);
     SAFE_RELEASE(m_pMultiDispatchMeshSignature);
     SAFE_RELEASE(m_pRootSignature);
+    SAFE_RELEASE(m_pPipelineLibrary);
     SAFE_RELEASE(m_pResourceAllocator);
     SAFE_RELEASE(m_pGraphicsQueue);
     SAFE_RELEASE(m_pComputeQueue);
@@ -205,35 +206,17 @@ IGfxShader* D3D12Device::CreateShader(const GfxShaderDesc& desc, const eastl::ve
 
 IGfxPipelineState* D3D12Device::CreateGraphicsPipelineState(const GfxGraphicsPipelineDesc& desc, const eastl::string& name)
 {
-    D3D12GraphicsPipelineState* pPipeline = new D3D12GraphicsPipelineState(this, desc, name);
-    if (!pPipeline->Create())
-    {
-        delete pPipeline;
-        return nullptr;
-    }
-    return pPipeline;
+    return new D3D12GraphicsPipelineState(this, desc, name);
 }
 
 IGfxPipelineState* D3D12Device::CreateMeshShadingPipelineState(const GfxMeshShadingPipelineDesc& desc, const eastl::string& name)
 {
-    D3D12MeshShadingPipelineState* pPipeline = new D3D12MeshShadingPipelineState(this, desc, name);
-    if (!pPipeline->Create())
-    {
-        delete pPipeline;
-        return nullptr;
-    }
-    return pPipeline;
+    return new D3D12MeshShadingPipelineState(this, desc, name);
 }
 
 IGfxPipelineState* D3D12Device::CreateComputePipelineState(const GfxComputePipelineDesc& desc, const eastl::string& name)
 {
-    D3D12ComputePipelineState* pPipeline = new D3D12ComputePipelineState(this, desc, name);
-    if (!pPipeline->Create())
-    {
-        delete pPipeline;
-        return nullptr;
-    }
-    return pPipeline;
+    return new D3D12ComputePipelineState(this, desc, name);
 }
 
 IGfxDescriptor* D3D12Device::CreateShaderResourceView(IGfxResource* resource, const GfxShaderResourceViewDesc& desc, const eastl::string& name)
@@ -329,6 +312,93 @@ bool D3D12Device::DumpMemoryStats(const eastl::string& file)
     return true;
 }
 
+bool D3D12Device::LoadPipelineCache(const eastl::vector<uint8_t>& data)
+{
+    if (data.empty())
+    {
+        return false;
+    }
+
+    eastl::vector<uint8_t> libraryData = data;
+
+    ID3D12PipelineLibrary1* pLibrary = nullptr;
+    HRESULT hr = m_pDevice->CreatePipelineLibrary(libraryData.data(), libraryData.size(), IID_PPV_ARGS(&pLibrary));
+    if (FAILED(hr))
+    {
+        //D3D12_ERROR_DRIVER_VERSION_MISMATCH or D3D12_ERROR_ADAPTER_NOT_FOUND, keeps the empty library
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(m_pipelineLibraryMutex);
+
+    SAFE_RELEASE(m_pPipelineLibrary);
+    m_pPipelineLibrary = pLibrary;
+    m_pipelineLibraryData.swap(libraryData);
+
+    return true;
+}
+
+bool D3D12Device::SavePipelineCache(eastl::vector<uint8_t>& data)
+{
+    std::lock_guard<std::mutex> lock(m_pipelineLibraryMutex);
+
+    if (m_pPipelineLibrary == nullptr)
+    {
+        return false;
+    }
+
+    data.resize(m_pPipelineLibrary->GetSerializedSize());
+    return SUCCEEDED(m_pPipelineLibrary->Serialize(data.data(), data.size()));
+}
+
+//loading the same PSO from multiple threads is not thread safe, the library calls are serialized with a mutex
+ID3D12PipelineState* D3D12Device::LoadPipelineState(const eastl::wstring& key, const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc)
+{
+    std::lock_guard<std::mutex> lock(m_pipelineLibraryMutex);
+
+    ID3D12PipelineState* pipelineState = nullptr;
+    if (m_pPipelineLibrary)
+    {
+        m_pPipelineLibrary->LoadGraphicsPipeline(key.c_str(), &desc, IID_PPV_ARGS(&pipelineState));
+    }
+    return pipelineState;
+}
+
+ID3D12PipelineState* D3D12Device::LoadPipelineState(const eastl::wstring& key, const D3D12_COMPUTE_PIPELINE_STATE_DESC& desc)
+{
+    std::lock_guard<std::mutex> lock(m_pipelineLibraryMutex);
+
+    ID3D12PipelineState* pipelineState = nullptr;
+    if (m_pPipelineLibrary)
+    {
+        m_pPipelineLibrary->LoadComputePipeline(key.c_str(), &desc, IID_PPV_ARGS(&pipelineState));
+    }
+    return pipelineState;
+}
+
+ID3D12PipelineState* D3D12Device::LoadPipelineState(const eastl::wstring& key, const D3D12_PIPELINE_STATE_STREAM_DESC& desc)
+{
+    std::lock_guard<std::mutex> lock(m_pipelineLibraryMutex);
+
+    ID3D12PipelineState* pipelineState = nullptr;
+    if (m_pPipelineLibrary)
+    {
+        m_pPipelineLibrary->LoadPipeline(key.c_str(), &desc, IID_PPV_ARGS(&pipelineState));
+    }
+    return pipelineState;
+}
+
+void D3D12Device::StorePipelineState(const eastl::wstring& key, ID3D12PipelineState* state)
+{
+    std::lock_guard<std::mutex> lock(m_pipelineLibraryMutex);
+
+    if (m_pPipelineLibrary)
+    {
+        //fails with E_INVALIDARG if another PSO with the same key was stored, which is fine
+        m_pPipelineLibrary->StorePipeline(key.c_str(), state);
+    }
+}
+
 void D3D12Device::BeginFrame()
 {
     DoDeferredDeletion();
@@ -456,6 +526,10 @@ bool D3D12Device::Init()
     CreateRootSignature();
     CreateIndirectCommandSignatures();
 
+    //an empty library, replaced by LoadPipelineCache if there is a serialized one.
+    //some drivers don't support it, PSOs are created without the library then
+    m_pDevice->CreatePipelineLibrary(nullptr, 0, IID_PPV_ARGS(&m_pPipelineLibrary));
+
     pix::Init();
 
 #if MICROPROFILE_GPU_TIMERS_D3D12
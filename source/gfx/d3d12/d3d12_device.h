@@ -4,6 +4,7 @@
 #include "../gfx_device.h"
 #include "EASTL/unique_ptr.h"
 #include "EASTL/queue.h"
+#include <mutex>
 
 namespace D3D12MA
 {
@@ -79,6 +80,8 @@ public:
 
     virtual uint32_t GetAllocationSize(const GfxTextureDesc& desc) override;
     virtual bool DumpMemoryStats(const eastl::string& file) override;
+    virtual bool LoadPipelineCache(const eastl::vector<uint8_t>& data) override;
+    virtual bool SavePipelineCache(eastl::vector<uint8_t>& data) override;
 
     bool Init();
     IDXGIFactory5* GetDxgiFactory() const { return m_pDxgiFactory; }
@@ -98,6 +101,11 @@ public:
     ID3D12CommandSignature* GetMultiDispatchSignature() const { return m_pMultiDispatchSignature; }
     ID3D12CommandSignature* GetMultiDispatchMeshSignature() const { return m_pMultiDispatchMeshSignature; }
 
+    ID3D12PipelineState* LoadPipelineState(const eastl::wstring& key, const D3D12_GRAPHICS_PIPELINE_STATE_DESC& desc);
+    ID3D12PipelineState* LoadPipelineState(const eastl::wstring& key, const D3D12_COMPUTE_PIPELINE_STATE_DESC& desc);
+    ID3D12PipelineState* LoadPipelineState(const eastl::wstring& key, const D3D12_PIPELINE_STATE_STREAM_DESC& desc);
+    void StorePipelineState(const eastl::wstring& key, ID3D12PipelineState* state);
+
     D3D12_GPU_VIRTUAL_ADDRESS AllocateConstantBuffer(const void* data, size_t data_size);
 
     void FlushDeferredDeletions();
@@ -151,6 +159,11 @@ private:
 
     D3D12MA::Allocator* m_pResourceAllocator = nullptr;
 
+    //the library references the serialized data, which should be alive as long as the library
+    ID3D12PipelineLibrary1* m_pPipelineLibrary = nullptr;
+    eastl::vector<uint8_t> m_pipelineLibraryData;
+    std::mutex m_pipelineLibraryMutex;
+
     static const uint32_t CB_ALLOCATOR_COUNT = 3;
     eastl::unique_ptr<D3D12ConstantBufferAllocator> m_pConstantBufferAllocators[CB_ALLOCATOR_COUNT];
 
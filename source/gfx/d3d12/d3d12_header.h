@@ -76,6 +76,19 @@ inline D3D12_RESOURCE_STATES d3d12_resource_state(GfxResourceState state)
     }
 }
 
+inline D3D12_RESOURCE_BARRIER_FLAGS d3d12_barrier_flag(GfxBarrierFlag flag)
+{
+    switch (flag)
+    {
+    case GfxBarrierFlag::BeginOnly:
+        return D3D12_RESOURCE_BARRIER_FLAG_BEGIN_ONLY;
+    case GfxBarrierFlag::EndOnly:
+        return D3D12_RESOURCE_BARRIER_FLAG_END_ONLY;
+    default:
+        return D3D12_RESOURCE_BARRIER_FLAG_NONE;
+    }
+}
+
 inline DXGI_FORMAT dxgi_format(GfxFormat format, bool depth_srv = false, bool uav = false)
 {
     switch (format)
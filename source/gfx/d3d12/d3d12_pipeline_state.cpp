@@ -1,6 +1,8 @@
 #include "d3d12_pipeline_state.h"
 #include "d3d12_device.h"
 #include "d3d12_shader.h"
+#include "xxHash/xxhash.h"
+#include "fmt/format.h"
 
 template<class T>
 inline bool has_rt_binding(const T& desc)
@@ -15,6 +17,19 @@ inline bool has_rt_binding(const T& desc)
     return false;
 }
 
+//the pipeline library key covers the shader bytecodes and the states, the root signature is the same for all PSOs
+inline eastl::wstring pipeline_library_key(std::initializer_list<const IGfxShader*> shaders, const void* states, size_t state_size)
+{
+    uint64_t hash = state_size > 0 ? XXH3_64bits(states, state_size) : 0;
+    for (const IGfxShader* shader : shaders)
+    {
+        uint64_t shader_hash = shader ? shader->GetHash() : 0;
+        hash = XXH3_64bits_withSeed(&shader_hash, sizeof(shader_hash), hash);
+    }
+
+    return string_to_wstring(fmt::format("{:016x}", hash).c_str());
+}
+
 D3D12GraphicsPipelineState::D3D12GraphicsPipelineState(D3D12Device* pDevice, const GfxGraphicsPipelineDesc& desc, const eastl::string& name)
 {
     m_pDevice = pDevice;
@@ -55,11 +70,20 @@ bool D3D12GraphicsPipelineState::Create()
     desc.SampleMask = 0xFFFFFFFF;
     desc.SampleDesc.Count = 1;
 
-    ID3D12PipelineState* pipelineState = nullptr;
-    ID3D12Device* pDevice = (ID3D12Device*)m_pDevice->GetHandle();
-    if (FAILED(pDevice->CreateGraphicsPipelineState(&desc, IID_PPV_ARGS(&pipelineState))))
+    const size_t state_offset = offsetof(GfxGraphicsPipelineDesc, rasterizer_state);
+    eastl::wstring key = pipeline_library_key({ m_desc.vs, m_desc.ps }, (char*)&m_desc + state_offset, sizeof(GfxGraphicsPipelineDesc) - state_offset);
+
+    D3D12Device* pD3D12Device = (D3D12Device*)m_pDevice;
+    ID3D12PipelineState* pipelineState = pD3D12Device->LoadPipelineState(key, desc);
+    if (pipelineState == nullptr)
     {
-        return false;
+        ID3D12Device* pDevice = (ID3D12Device*)m_pDevice->GetHandle();
+        if (FAILED(pDevice->CreateGraphicsPipelineState(&desc, IID_PPV_ARGS(&pipelineState))))
+        {
+            return false;
+        }
+
+        pD3D12Device->StorePipelineState(key, pipelineState);
     }
 
     pipelineState->SetName(string_to_wstring(m_name).c_str());
@@ -93,11 +117,19 @@ bool D3D12ComputePipelineState::Create()
     desc.pRootSignature = ((D3D12Device*)m_pDevice)->GetRootSignature();
     desc.CS = ((D3D12Shader*)m_desc.cs)->GetByteCode();
 
-    ID3D12PipelineState* pipelineState = nullptr;
-    ID3D12Device* pDevice = (ID3D12Device*)m_pDevice->GetHandle();
-    if (FAILED(pDevice->CreateComputePipelineState(&desc, IID_PPV_ARGS(&pipelineState))))
+    eastl::wstring key = pipeline_library_key({ m_desc.cs }, nullptr, 0);
+
+    D3D12Device* pD3D12Device = (D3D12Device*)m_pDevice;
+    ID3D12PipelineState* pipelineState = pD3D12Device->LoadPipelineState(key, desc);
+    if (pipelineState == nullptr)
     {
-        return false;
+        ID3D12Device* pDevice = (ID3D12Device*)m_pDevice->GetHandle();
+        if (FAILED(pDevice->CreateComputePipelineState(&desc, IID_PPV_ARGS(&pipelineState))))
+        {
+            return false;
+        }
+
+        pD3D12Device->StorePipelineState(key, pipelineState);
     }
 
     pipelineState->SetName(string_to_wstring(m_name).c_str());
@@ -161,12 +193,21 @@ bool D3D12MeshShadingPipelineState::Create()
     streamDesc.pPipelineStateSubobjectStream = &psoStream;
     streamDesc.SizeInBytes = sizeof(psoStream);
 
-    ID3D12PipelineState* pipelineState = nullptr;
-    ID3D12Device2* pDevice = (ID3D12Device2*)m_pDevice->GetHandle();
-    HRESULT hr = pDevice->CreatePipelineState(&streamDesc, IID_PPV_ARGS(&pipelineState));
-    if (FAILED(hr))
+    const size_t state_offset = offsetof(GfxMeshShadingPipelineDesc, rasterizer_state);
+    eastl::wstring key = pipeline_library_key({ m_desc.as, m_desc.ms, m_desc.ps }, (char*)&m_desc + state_offset, sizeof(GfxMeshShadingPipelineDesc) - state_offset);
+
+    D3D12Device* pD3D12Device = (D3D12Device*)m_pDevice;
+    ID3D12PipelineState* pipelineState = pD3D12Device->LoadPipelineState(key, streamDesc);
+    if (pipelineState == nullptr)
     {
-        return false;
+        ID3D12Device2* pDevice = (ID3D12Device2*)m_pDevice->GetHandle();
+        HRESULT hr = pDevice->CreatePipelineState(&streamDesc, IID_PPV_ARGS(&pipelineState));
+        if (FAILED(hr))
+        {
+            return false;
+        }
+
+        pD3D12Device->StorePipelineState(key, pipelineState);
     }
 
     pipelineState->SetName(string_to_wstring(m_name).c_str());
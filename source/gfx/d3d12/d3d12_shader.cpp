@@ -10,6 +10,7 @@ D3D12Shader::D3D12Shader(D3D12Device* pDevice, const GfxShaderDesc& desc, const
     m_name = name;
 
     m_hash = XXH3_64bits(data.data(), data.size());
+    m_bCompiled = !data.empty();
 }
 
 bool D3D12Shader::SetShaderData(const uint8_t* data, uint32_t data_size)
@@ -18,6 +19,7 @@ bool D3D12Shader::SetShaderData(const uint8_t* data, uint32_t data_size)
     memcpy(m_data.data(), data, data_size);
 
     m_hash = XXH3_64bits(data, data_size);
+    m_bCompiled = true;
 
     return true;
 }
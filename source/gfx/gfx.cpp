@@ -1,5 +1,6 @@
 #include "gfx.h"
 #include "d3d12/d3d12_device.h"
+#include "mock/mock_device.h"
 #include "utils/assert.h"
 #include "xxHash/xxhash.h"
 #include "microprofile/microprofile.h"
@@ -18,6 +19,9 @@ IGfxDevice* CreateGfxDevice(const GfxDeviceDesc& desc)
             pDevice = nullptr;
         }
         break;
+    case GfxRenderBackend::Mock:
+        pDevice = new MockDevice(desc);
+        break;
     default:
         break;
     }
@@ -40,7 +40,7 @@ public:
     virtual void WriteBuffer(IGfxBuffer* buffer, uint32_t offset, uint32_t data) = 0;
     virtual void UpdateTileMappings(IGfxTexture* texture, IGfxHeap* heap, uint32_t mapping_count, const GfxTileMapping* mappings) = 0;
 
-    virtual void ResourceBarrier(IGfxResource* resource, uint32_t sub_resource, GfxResourceState old_state, GfxResourceState new_state) = 0;
+    virtual void ResourceBarrier(IGfxResource* resource, uint32_t sub_resource, GfxResourceState old_state, GfxResourceState new_state, GfxBarrierFlag flag = GfxBarrierFlag::None) = 0;
     virtual void UavBarrier(IGfxResource* resource) = 0;
     virtual void AliasingBarrier(IGfxResource* resource_before, IGfxResource* resource_after) = 0;
     virtual void FlushBarriers() = 0;
@@ -13,6 +13,7 @@ const static int GFX_MAX_INFLIGHT_FRAMES = 3;
 enum class GfxRenderBackend
 {
     D3D12,
+    Mock, //no GPU work, for tests and offline tools
     //todo : maybe Vulkan
 };
 
@@ -155,6 +156,13 @@ enum class GfxResourceState
     Present,
 };
 
+enum class GfxBarrierFlag
+{
+    None,
+    BeginOnly, //split barrier, the transition can overlap with the work until the EndOnly one
+    EndOnly,
+};
+
 enum class GfxRenderPassLoadOp
 {
     Load,
@@ -656,6 +664,7 @@ enum class GfxVendor
     AMD,
     Nvidia,
     Intel,
+    Unknown,
 };
 
 enum GfxRayTracingASFlagBit
@@ -35,6 +35,7 @@ public:
     virtual IGfxTexture* CreateTexture(const GfxTextureDesc& desc, const eastl::string& name) = 0;
     virtual IGfxTexture* CreateTexture(const GfxTextureDesc& desc, IGfxHeap* heap, uint32_t offset, const eastl::string& name) = 0;
     virtual IGfxShader* CreateShader(const GfxShaderDesc& desc, const eastl::vector<uint8_t>& data, const eastl::string& name) = 0;
+    //pipeline states are compiled by IGfxPipelineState::Create, so the caller can do it when the shaders are ready
     virtual IGfxPipelineState* CreateGraphicsPipelineState(const GfxGraphicsPipelineDesc& desc, const eastl::string& name) = 0;
     virtual IGfxPipelineState* CreateMeshShadingPipelineState(const GfxMeshShadingPipelineDesc& desc, const eastl::string& name) = 0;
     virtual IGfxPipelineState* CreateComputePipelineState(const GfxComputePipelineDesc& desc, const eastl::string& name) = 0;
@@ -47,4 +48,9 @@ public:
 
     virtual uint32_t GetAllocationSize(const GfxTextureDesc& desc) = 0;
     virtual bool DumpMemoryStats(const eastl::string& file) = 0;
+
+    //driver pipeline cache, the data is opaque and only valid for the same adapter and driver.
+    //it should be loaded before any pipeline state is created
+    virtual bool LoadPipelineCache(const eastl::vector<uint8_t>& data) = 0;
+    virtual bool SavePipelineCache(eastl::vector<uint8_t>& data) = 0;
 };
\ No newline at end of file
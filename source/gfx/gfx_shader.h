@@ -1,6 +1,7 @@
 #pragma once
 
 #include "gfx_resource.h"
+#include <atomic>
 
 class IGfxShader : public IGfxResource
 {
@@ -9,9 +10,14 @@ public:
 
     uint64_t GetHash() const { return m_hash; }
 
+    //false until the shader data is set, a shader whose compilation failed has no data.
+    //the data is set on the worker threads, so this can be checked before the compile task is completed
+    bool IsCompiled() const { return m_bCompiled; }
+
     virtual bool SetShaderData(const uint8_t* data, uint32_t data_size) = 0;
 
 protected:
     GfxShaderDesc m_desc = {};
     uint64_t m_hash = 0;
+    std::atomic<bool> m_bCompiled { false };
 };
\ No newline at end of file
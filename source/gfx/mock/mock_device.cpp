@@ -0,0 +1,191 @@
+#include "mock_device.h"
+#include "mock_resource.h"
+#include "mock_command_list.h"
+#include "../gfx.h"
+
+#define MOCK_PIPELINE_CACHE_MAGIC 0x4350524d //"MRPC"
+
+MockDevice::MockDevice(const GfxDeviceDesc& desc)
+{
+    m_desc = desc;
+}
+
+MockDevice::~MockDevice()
+{
+}
+
+void MockDevice::BeginFrame()
+{
+}
+
+void MockDevice::EndFrame()
+{
+    ++m_nFrameID;
+}
+
+IGfxSwapchain* MockDevice::CreateSwapchain(const GfxSwapchainDesc& desc, const eastl::string& name)
+{
+    return new MockSwapchain(this, desc, name);
+}
+
+IGfxCommandList* MockDevice::CreateCommandList(GfxCommandQueue queue_type, const eastl::string& name)
+{
+    return new MockCommandList(this, queue_type, name);
+}
+
+IGfxFence* MockDevice::CreateFence(const eastl::string& name)
+{
+    return new MockFence(this, name);
+}
+
+IGfxHeap* MockDevice::CreateHeap(const GfxHeapDesc& desc, const eastl::string& name)
+{
+    return new MockHeap(this, desc, name);
+}
+
+IGfxBuffer* MockDevice::CreateBuffer(const GfxBufferDesc& desc, const eastl::string& name)
+{
+    return new MockBuffer(this, desc, name);
+}
+
+IGfxBuffer* MockDevice::CreateBuffer(const GfxBufferDesc& desc, IGfxHeap* heap, uint32_t offset, const eastl::string& name)
+{
+    return new MockBuffer(this, desc, name);
+}
+
+IGfxTexture* MockDevice::CreateTexture(const GfxTextureDesc& desc, const eastl::string& name)
+{
+    return new MockTexture(this, desc, name);
+}
+
+IGfxTexture* MockDevice::CreateTexture(const GfxTextureDesc& desc, IGfxHeap* heap, uint32_t offset, const eastl::string& name)
+{
+    return new MockTexture(this, desc, name);
+}
+
+IGfxShader* MockDevice::CreateShader(const GfxShaderDesc& desc, const eastl::vector<uint8_t>& data, const eastl::string& name)
+{
+    return new MockShader(this, desc, data, name);
+}
+
+IGfxPipelineState* MockDevice::CreateGraphicsPipelineState(const GfxGraphicsPipelineDesc& desc, const eastl::string& name)
+{
+    const size_t state_offset = offsetof(GfxGraphicsPipelineDesc, rasterizer_state);
+    return new MockPipelineState(this, GfxPipelineType::Graphics, { desc.vs, desc.ps }, (char*)&desc + state_offset, sizeof(GfxGraphicsPipelineDesc) - state_offset, name);
+}
+
+IGfxPipelineState* MockDevice::CreateMeshShadingPipelineState(const GfxMeshShadingPipelineDesc& desc, const eastl::string& name)
+{
+    const size_t state_offset = offsetof(GfxMeshShadingPipelineDesc, rasterizer_state);
+    return new MockPipelineState(this, GfxPipelineType::MeshShading, { desc.as, desc.ms, desc.ps }, (char*)&desc + state_offset, sizeof(GfxMeshShadingPipelineDesc) - state_offset, name);
+}
+
+IGfxPipelineState* MockDevice::CreateComputePipelineState(const GfxComputePipelineDesc& desc, const eastl::string& name)
+{
+    return new MockPipelineState(this, GfxPipelineType::Compute, { desc.cs }, nullptr, 0, name);
+}
+
+IGfxDescriptor* MockDevice::CreateShaderResourceView(IGfxResource* resource, const GfxShaderResourceViewDesc& desc, const eastl::string& name)
+{
+    return new MockDescriptor(this, resource, name);
+}
+
+IGfxDescriptor* MockDevice::CreateUnorderedAccessView(IGfxResource* resource, const GfxUnorderedAccessViewDesc& desc, const eastl::string& name)
+{
+    return new MockDescriptor(this, resource, name);
+}
+
+IGfxDescriptor* MockDevice::CreateConstantBufferView(IGfxBuffer* buffer, const GfxConstantBufferViewDesc& desc, const eastl::string& name)
+{
+    return new MockDescriptor(this, buffer, name);
+}
+
+IGfxDescriptor* MockDevice::CreateSampler(const GfxSamplerDesc& desc, const eastl::string& name)
+{
+    return new MockDescriptor(this, nullptr, name);
+}
+
+IGfxRayTracingBLAS* MockDevice::CreateRayTracingBLAS(const GfxRayTracingBLASDesc& desc, const eastl::string& name)
+{
+    return new MockRayTracingBLAS(this, desc, name);
+}
+
+IGfxRayTracingTLAS* MockDevice::CreateRayTracingTLAS(const GfxRayTracingTLASDesc& desc, const eastl::string& name)
+{
+    return new MockRayTracingTLAS(this, desc, name);
+}
+
+uint32_t MockDevice::GetAllocationSize(const GfxTextureDesc& desc)
+{
+    MockTexture texture(this, desc, "");
+    return texture.GetRequiredStagingBufferSize();
+}
+
+bool MockDevice::DumpMemoryStats(const eastl::string& file)
+{
+    return false;
+}
+
+bool MockDevice::LoadPipelineCache(const eastl::vector<uint8_t>& data)
+{
+    if (data.size() < sizeof(uint32_t) * 2)
+    {
+        return false;
+    }
+
+    const uint32_t* header = (const uint32_t*)data.data();
+    uint32_t count = header[1];
+    if (header[0] != MOCK_PIPELINE_CACHE_MAGIC || data.size() != sizeof(uint32_t) * 2 + sizeof(uint64_t) * count)
+    {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(m_pipelineCacheMutex);
+
+    const uint64_t* keys = (const uint64_t*)(header + 2);
+    m_pipelineCache.clear();
+    m_pipelineCache.insert(keys, keys + count);
+
+    return true;
+}
+
+bool MockDevice::SavePipelineCache(eastl::vector<uint8_t>& data)
+{
+    std::lock_guard<std::mutex> lock(m_pipelineCacheMutex);
+
+    uint32_t count = (uint32_t)m_pipelineCache.size();
+    data.resize(sizeof(uint32_t) * 2 + sizeof(uint64_t) * count);
+
+    uint32_t* header = (uint32_t*)data.data();
+    header[0] = MOCK_PIPELINE_CACHE_MAGIC;
+    header[1] = count;
+
+    uint64_t* keys = (uint64_t*)(header + 2);
+    for (auto iter = m_pipelineCache.begin(); iter != m_pipelineCache.end(); ++iter)
+    {
+        *keys++ = *iter;
+    }
+
+    return true;
+}
+
+uint64_t MockDevice::AllocateGpuAddress(uint64_t size)
+{
+    //256 bytes aligned, like D3D12 buffers
+    return m_nGpuAddress.fetch_add((size + 255) & ~255ull);
+}
+
+bool MockDevice::LoadPipelineState(uint64_t key)
+{
+    std::lock_guard<std::mutex> lock(m_pipelineCacheMutex);
+
+    if (m_pipelineCache.find(key) != m_pipelineCache.end())
+    {
+        ++m_nPipelineCacheHits;
+        return true;
+    }
+
+    m_pipelineCache.insert(key);
+    ++m_nPipelineCacheMisses;
+    return false;
+}
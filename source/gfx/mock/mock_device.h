@@ -0,0 +1,65 @@
+#pragma once
+
+#include "../gfx_device.h"
+#include "EASTL/hash_set.h"
+#include "EASTL/atomic.h"
+#include <mutex>
+
+//a device without GPU, resources and command lists do nothing.
+//it is used to run the renderer side logic (shader/PSO caches, render graph compilation) in tests and offline tools
+class MockDevice : public IGfxDevice
+{
+public:
+    MockDevice(const GfxDeviceDesc& desc);
+    ~MockDevice();
+
+    virtual void BeginFrame() override;
+    virtual void EndFrame() override;
+    virtual uint64_t GetFrameID() const override { return m_nFrameID; }
+    virtual void* GetHandle() const override { return nullptr; }
+    virtual GfxVendor GetVendor() const override { return GfxVendor::Unknown; }
+
+    virtual IGfxSwapchain* CreateSwapchain(const GfxSwapchainDesc& desc, const eastl::string& name) override;
+    virtual IGfxCommandList* CreateCommandList(GfxCommandQueue queue_type, const eastl::string& name) override;
+    virtual IGfxFence* CreateFence(const eastl::string& name) override;
+    virtual IGfxHeap* CreateHeap(const GfxHeapDesc& desc, const eastl::string& name) override;
+    virtual IGfxBuffer* CreateBuffer(const GfxBufferDesc& desc, const eastl::string& name) override;
+    virtual IGfxBuffer* CreateBuffer(const GfxBufferDesc& desc, IGfxHeap* heap, uint32_t offset, const eastl::string& name) override;
+    virtual IGfxTexture* CreateTexture(const GfxTextureDesc& desc, const eastl::string& name) override;
+    virtual IGfxTexture* CreateTexture(const GfxTextureDesc& desc, IGfxHeap* heap, uint32_t offset, const eastl::string& name) override;
+    virtual IGfxShader* CreateShader(const GfxShaderDesc& desc, const eastl::vector<uint8_t>& data, const eastl::string& name) override;
+    virtual IGfxPipelineState* CreateGraphicsPipelineState(const GfxGraphicsPipelineDesc& desc, const eastl::string& name) override;
+    virtual IGfxPipelineState* CreateMeshShadingPipelineState(const GfxMeshShadingPipelineDesc& desc, const eastl::string& name) override;
+    virtual IGfxPipelineState* CreateComputePipelineState(const GfxComputePipelineDesc& desc, const eastl::string& name) override;
+    virtual IGfxDescriptor* CreateShaderResourceView(IGfxResource* resource, const GfxShaderResourceViewDesc& desc, const eastl::string& name) override;
+    virtual IGfxDescriptor* CreateUnorderedAccessView(IGfxResource* resource, const GfxUnorderedAccessViewDesc& desc, const eastl::string& name) override;
+    virtual IGfxDescriptor* CreateConstantBufferView(IGfxBuffer* buffer, const GfxConstantBufferViewDesc& desc, const eastl::string& name) override;
+    virtual IGfxDescriptor* CreateSampler(const GfxSamplerDesc& desc, const eastl::string& name) override;
+    virtual IGfxRayTracingBLAS* CreateRayTracingBLAS(const GfxRayTracingBLASDesc& desc, const eastl::string& name) override;
+    virtual IGfxRayTracingTLAS* CreateRayTracingTLAS(const GfxRayTracingTLASDesc& desc, const eastl::string& name) override;
+
+    virtual uint32_t GetAllocationSize(const GfxTextureDesc& desc) override;
+    virtual bool DumpMemoryStats(const eastl::string& file) override;
+    virtual bool LoadPipelineCache(const eastl::vector<uint8_t>& data) override;
+    virtual bool SavePipelineCache(eastl::vector<uint8_t>& data) override;
+
+    uint32_t AllocateDescriptor() { return m_nDescriptorCount++; }
+    uint64_t AllocateGpuAddress(uint64_t size);
+
+    //returns true if the PSO was in the pipeline cache, otherwise adds it
+    bool LoadPipelineState(uint64_t key);
+    uint32_t GetPipelineCacheHitCount() const { return m_nPipelineCacheHits; }
+    uint32_t GetPipelineCacheMissCount() const { return m_nPipelineCacheMisses; }
+
+private:
+    GfxDeviceDesc m_desc;
+    uint64_t m_nFrameID = 0;
+
+    eastl::atomic<uint32_t> m_nDescriptorCount { 0 };
+    eastl::atomic<uint64_t> m_nGpuAddress { 0x10000 };
+
+    eastl::hash_set<uint64_t> m_pipelineCache;
+    std::mutex m_pipelineCacheMutex;
+    uint32_t m_nPipelineCacheHits = 0;
+    uint32_t m_nPipelineCacheMisses = 0;
+};
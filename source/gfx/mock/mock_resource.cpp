@@ -0,0 +1,174 @@
+#include "mock_resource.h"
+#include "mock_device.h"
+#include "../gfx.h"
+#include "utils/assert.h"
+#include "xxHash/xxhash.h"
+
+MockBuffer::MockBuffer(MockDevice* pDevice, const GfxBufferDesc& desc, const eastl::string& name)
+{
+    m_pDevice = pDevice;
+    m_desc = desc;
+    m_name = name;
+
+    if (desc.memory_type != GfxMemoryType::GpuOnly)
+    {
+        m_cpuData.resize(desc.size);
+    }
+
+    m_gpuAddress = pDevice->AllocateGpuAddress(desc.size);
+}
+
+MockTexture::MockTexture(MockDevice* pDevice, const GfxTextureDesc& desc, const eastl::string& name)
+{
+    m_pDevice = pDevice;
+    m_desc = desc;
+    m_name = name;
+}
+
+uint32_t MockTexture::GetRequiredStagingBufferSize() const
+{
+    uint32_t size = 0;
+
+    for (uint32_t mip = 0; mip < m_desc.mip_levels; ++mip)
+    {
+        uint32_t height = eastl::max(m_desc.height >> mip, 1u);
+        uint32_t depth = eastl::max(m_desc.depth >> mip, 1u);
+        uint32_t block_height = GetFormatBlockHeight(m_desc.format);
+        uint32_t row_count = (height + block_height - 1) / block_height;
+
+        size += GetRowPitch(mip) * row_count * depth;
+    }
+
+    return size * m_desc.array_size;
+}
+
+uint32_t MockTexture::GetRowPitch(uint32_t mip_level) const
+{
+    RE_ASSERT(mip_level < m_desc.mip_levels);
+
+    uint32_t width = eastl::max(m_desc.width >> mip_level, 1u);
+    uint32_t block_width = GetFormatBlockWidth(m_desc.format);
+    width = (width + block_width - 1) / block_width * block_width;
+
+    return GetFormatRowPitch(m_desc.format, width);
+}
+
+MockFence::MockFence(MockDevice* pDevice, const eastl::string& name)
+{
+    m_pDevice = pDevice;
+    m_name = name;
+}
+
+MockHeap::MockHeap(MockDevice* pDevice, const GfxHeapDesc& desc, const eastl::string& name)
+{
+    m_pDevice = pDevice;
+    m_desc = desc;
+    m_name = name;
+}
+
+MockShader::MockShader(MockDevice* pDevice, const GfxShaderDesc& desc, const eastl::vector<uint8_t>& data, const eastl::string& name)
+{
+    m_pDevice = pDevice;
+    m_desc = desc;
+    m_name = name;
+
+    m_hash = XXH3_64bits(data.data(), data.size());
+    m_bCompiled = !data.empty();
+}
+
+bool MockShader::SetShaderData(const uint8_t* data, uint32_t data_size)
+{
+    m_hash = XXH3_64bits(data, data_size);
+    m_bCompiled = true;
+    return true;
+}
+
+MockPipelineState::MockPipelineState(MockDevice* pDevice, GfxPipelineType type, const eastl::vector<IGfxShader*>& shaders, const void* states, size_t state_size, const eastl::string& name)
+{
+    m_pDevice = pDevice;
+    m_name = name;
+    m_type = type;
+    m_shaders = shaders;
+    m_states.resize(state_size);
+    memcpy(m_states.data(), states, state_size);
+}
+
+bool MockPipelineState::Create()
+{
+    //same key as the D3D12 pipeline library : the shader bytecodes and the states
+    uint64_t key = m_states.empty() ? 0 : XXH3_64bits(m_states.data(), m_states.size());
+    for (size_t i = 0; i < m_shaders.size(); ++i)
+    {
+        uint64_t shader_hash = m_shaders[i] ? m_shaders[i]->GetHash() : 0;
+        key = XXH3_64bits_withSeed(&shader_hash, sizeof(shader_hash), key);
+    }
+
+    ((MockDevice*)m_pDevice)->LoadPipelineState(key);
+
+    m_bCreated = true;
+    return true;
+}
+
+MockDescriptor::MockDescriptor(MockDevice* pDevice, IGfxResource* pResource, const eastl::string& name)
+{
+    m_pDevice = pDevice;
+    m_pResource = pResource;
+    m_name = name;
+    m_heapIndex = pDevice->AllocateDescriptor();
+}
+
+MockSwapchain::MockSwapchain(MockDevice* pDevice, const GfxSwapchainDesc& desc, const eastl::string& name)
+{
+    m_pDevice = pDevice;
+    m_desc = desc;
+    m_name = name;
+
+    CreateBackBuffers();
+}
+
+bool MockSwapchain::Present()
+{
+    m_nCurrentBackBuffer = (m_nCurrentBackBuffer + 1) % m_desc.backbuffer_count;
+    return true;
+}
+
+bool MockSwapchain::Resize(uint32_t width, uint32_t height)
+{
+    m_desc.width = width;
+    m_desc.height = height;
+
+    CreateBackBuffers();
+    return true;
+}
+
+void MockSwapchain::CreateBackBuffers()
+{
+    m_backBuffers.clear();
+    m_nCurrentBackBuffer = 0;
+
+    GfxTextureDesc textureDesc;
+    textureDesc.width = m_desc.width;
+    textureDesc.height = m_desc.height;
+    textureDesc.format = m_desc.backbuffer_format;
+    textureDesc.usage = GfxTextureUsageRenderTarget;
+
+    for (uint32_t i = 0; i < m_desc.backbuffer_count; ++i)
+    {
+        eastl::string name = m_name + " back buffer " + eastl::to_string(i);
+        m_backBuffers.emplace_back(new MockTexture((MockDevice*)m_pDevice, textureDesc, name));
+    }
+}
+
+MockRayTracingBLAS::MockRayTracingBLAS(MockDevice* pDevice, const GfxRayTracingBLASDesc& desc, const eastl::string& name)
+{
+    m_pDevice = pDevice;
+    m_desc = desc;
+    m_name = name;
+}
+
+MockRayTracingTLAS::MockRayTracingTLAS(MockDevice* pDevice, const GfxRayTracingTLASDesc& desc, const eastl::string& name)
+{
+    m_pDevice = pDevice;
+    m_desc = desc;
+    m_name = name;
+}
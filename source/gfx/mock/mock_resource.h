@@ -0,0 +1,132 @@
+#pragma once
+
+#include "../gfx_buffer.h"
+#include "../gfx_texture.h"
+#include "../gfx_fence.h"
+#include "../gfx_heap.h"
+#include "../gfx_shader.h"
+#include "../gfx_pipeline_state.h"
+#include "../gfx_descriptor.h"
+#include "../gfx_swapchain.h"
+#include "../gfx_rt_blas.h"
+#include "../gfx_rt_tlas.h"
+#include "EASTL/unique_ptr.h"
+
+class MockDevice;
+
+class MockBuffer : public IGfxBuffer
+{
+public:
+    MockBuffer(MockDevice* pDevice, const GfxBufferDesc& desc, const eastl::string& name);
+
+    virtual void* GetHandle() const override { return nullptr; }
+    virtual void* GetCpuAddress() override { return m_cpuData.empty() ? nullptr : m_cpuData.data(); }
+    virtual uint64_t GetGpuAddress() override { return m_gpuAddress; }
+    virtual uint32_t GetRequiredStagingBufferSize() const override { return m_desc.size; }
+
+private:
+    eastl::vector<uint8_t> m_cpuData;
+    uint64_t m_gpuAddress = 0;
+};
+
+class MockTexture : public IGfxTexture
+{
+public:
+    MockTexture(MockDevice* pDevice, const GfxTextureDesc& desc, const eastl::string& name);
+
+    virtual void* GetHandle() const override { return nullptr; }
+    virtual uint32_t GetRequiredStagingBufferSize() const override;
+    virtual uint32_t GetRowPitch(uint32_t mip_level) const override;
+    virtual GfxTilingDesc GetTilingDesc() const override { return {}; }
+    virtual GfxSubresourceTilingDesc GetTilingDesc(uint32_t subresource) const override { return {}; }
+};
+
+class MockFence : public IGfxFence
+{
+public:
+    MockFence(MockDevice* pDevice, const eastl::string& name);
+
+    virtual void* GetHandle() const override { return nullptr; }
+    virtual void Wait(uint64_t value) override {}
+    virtual void Signal(uint64_t value) override {}
+};
+
+class MockHeap : public IGfxHeap
+{
+public:
+    MockHeap(MockDevice* pDevice, const GfxHeapDesc& desc, const eastl::string& name);
+
+    virtual void* GetHandle() const override { return nullptr; }
+};
+
+class MockShader : public IGfxShader
+{
+public:
+    MockShader(MockDevice* pDevice, const GfxShaderDesc& desc, const eastl::vector<uint8_t>& data, const eastl::string& name);
+
+    virtual void* GetHandle() const override { return nullptr; }
+    virtual bool SetShaderData(const uint8_t* data, uint32_t data_size) override;
+};
+
+class MockPipelineState : public IGfxPipelineState
+{
+public:
+    MockPipelineState(MockDevice* pDevice, GfxPipelineType type, const eastl::vector<IGfxShader*>& shaders, const void* states, size_t state_size, const eastl::string& name);
+
+    //non null after the PSO is created, like the D3D12 ones
+    virtual void* GetHandle() const override { return m_bCreated ? (void*)this : nullptr; }
+    virtual bool Create() override;
+
+private:
+    eastl::vector<IGfxShader*> m_shaders;
+    eastl::vector<uint8_t> m_states;
+    bool m_bCreated = false;
+};
+
+class MockDescriptor : public IGfxDescriptor
+{
+public:
+    MockDescriptor(MockDevice* pDevice, IGfxResource* pResource, const eastl::string& name);
+
+    virtual void* GetHandle() const override { return m_pResource; }
+    virtual uint32_t GetHeapIndex() const override { return m_heapIndex; }
+
+private:
+    IGfxResource* m_pResource = nullptr;
+    uint32_t m_heapIndex = GFX_INVALID_RESOURCE;
+};
+
+class MockSwapchain : public IGfxSwapchain
+{
+public:
+    MockSwapchain(MockDevice* pDevice, const GfxSwapchainDesc& desc, const eastl::string& name);
+
+    virtual void* GetHandle() const override { return nullptr; }
+    virtual bool Present() override;
+    virtual bool Resize(uint32_t width, uint32_t height) override;
+    virtual void SetVSyncEnabled(bool value) override {}
+    virtual IGfxTexture* GetBackBuffer() const override { return m_backBuffers[m_nCurrentBackBuffer].get(); }
+
+private:
+    void CreateBackBuffers();
+
+private:
+    eastl::vector<eastl::unique_ptr<IGfxTexture>> m_backBuffers;
+    uint32_t m_nCurrentBackBuffer = 0;
+};
+
+class MockRayTracingBLAS : public IGfxRayTracingBLAS
+{
+public:
+    MockRayTracingBLAS(MockDevice* pDevice, const GfxRayTracingBLASDesc& desc, const eastl::string& name);
+
+    virtual void* GetHandle() const override { return nullptr; }
+};
+
+class MockRayTracingTLAS : public IGfxRayTracingTLAS
+{
+public:
+    MockRayTracingTLAS(MockDevice* pDevice, const GfxRayTracingTLASDesc& desc, const eastl::string& name);
+
+    virtual void* GetHandle() const override { return nullptr; }
+};
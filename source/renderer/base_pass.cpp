@@ -137,10 +137,8 @@ void BasePass::Render1stPhase(RenderGraph* pRenderGraph)
 
             data.secondPhaseObjectListCounterBuffer = builder.Write(clear_counter_pass->secondPhaseObjectListCounterBuffer);
 
-            for (uint32_t i = 0; i < pHZB->GetHZBMipCount(); ++i)
-            {
-                data.hzbTexture = builder.Read(pHZB->Get1stPhaseCullingHZBMip(i), i);
-            }
+            data.hzbTexture = builder.Read(pHZB->Get1stPhaseCullingHZBMip(0), 0);
+            data.hzbTexture = builder.ReadViews(pHZB->Get1stPhaseCullingHZBMip(1), 1, pHZB->GetHZBMipCount() - 1);
         },
         [=](const InstanceCullingData& data, IGfxCommandList* pCommandList)
         {
@@ -214,7 +212,7 @@ void BasePass::Render1stPhase(RenderGraph* pRenderGraph)
             data.outSpecularRT = builder.Create<RGTexture>(desc, "Specular RT");
 
             desc.format = GfxFormat::RGBA8UNORM;
-            data.outNormalRT = builder.Create<RGTexture>(desc, "Normal RT");
+            data.outNormalRT = builder.CreateHistory(desc, "Normal RT");
             data.outCustomRT = builder.Create<RGTexture>(desc, "CustomData RT");
 
             desc.format = GfxFormat::R11G11B10F;
@@ -230,10 +228,8 @@ void BasePass::Render1stPhase(RenderGraph* pRenderGraph)
             data.outCustomRT = builder.WriteColor(4, data.outCustomRT, 0, GfxRenderPassLoadOp::Clear, float4(0.0f));
             data.outDepthRT = builder.WriteDepth(data.outDepthRT, 0, GfxRenderPassLoadOp::Clear, GfxRenderPassLoadOp::Clear);
 
-            for (uint32_t i = 0; i < pHZB->GetHZBMipCount(); ++i)
-            {
-                data.inHZB = builder.Read(pHZB->Get1stPhaseCullingHZBMip(i), i, RGBuilderFlag::ShaderStageNonPS);
-            }
+            data.inHZB = builder.Read(pHZB->Get1stPhaseCullingHZBMip(0), 0, RGBuilderFlag::ShaderStageNonPS);
+            data.inHZB = builder.ReadViews(pHZB->Get1stPhaseCullingHZBMip(1), 1, pHZB->GetHZBMipCount() - 1, 0, RGBuilderFlag::ShaderStageNonPS);
 
             data.indirectCommandBuffer = builder.ReadIndirectArg(build_indirect_command->indirectCommandBuffer);
             data.meshletListBuffer = builder.Read(build_meshlet_list_pass->meshletListBuffer, 0, RGBuilderFlag::ShaderStageNonPS);
@@ -333,10 +329,8 @@ void BasePass::Render2ndPhase(RenderGraph* pRenderGraph)
             data.objectListBuffer = builder.Read(m_secondPhaseObjectListBuffer);
             data.objectListCounterBuffer = builder.Read(m_secondPhaseObjectListCounterBuffer);
 
-            for (uint32_t i = 0; i < pHZB->GetHZBMipCount(); ++i)
-            {
-                data.hzbTexture = builder.Read(pHZB->Get2ndPhaseCullingHZBMip(i), i);
-            }
+            data.hzbTexture = builder.Read(pHZB->Get2ndPhaseCullingHZBMip(0), 0);
+            data.hzbTexture = builder.ReadViews(pHZB->Get2ndPhaseCullingHZBMip(1), 1, pHZB->GetHZBMipCount() - 1);
         },
         [=](const InstanceCullingData& data, IGfxCommandList* pCommandList)
         {
@@ -404,10 +398,8 @@ void BasePass::Render2ndPhase(RenderGraph* pRenderGraph)
             data.outCustomRT = builder.WriteColor(4, m_customDataRT, 0, GfxRenderPassLoadOp::Load);
             data.outDepthRT = builder.WriteDepth(m_depthRT, 0, GfxRenderPassLoadOp::Load, GfxRenderPassLoadOp::Load);
 
-            for (uint32_t i = 0; i < pHZB->GetHZBMipCount(); ++i)
-            {
-                data.inHZB = builder.Read(pHZB->Get2ndPhaseCullingHZBMip(i), i, RGBuilderFlag::ShaderStageNonPS);
-            }
+            data.inHZB = builder.Read(pHZB->Get2ndPhaseCullingHZBMip(0), 0, RGBuilderFlag::ShaderStageNonPS);
+            data.inHZB = builder.ReadViews(pHZB->Get2ndPhaseCullingHZBMip(1), 1, pHZB->GetHZBMipCount() - 1, 0, RGBuilderFlag::ShaderStageNonPS);
 
             data.meshletListBuffer = builder.Read(build_meshlet_list_pass->meshletListBuffer, 0, RGBuilderFlag::ShaderStageNonPS);
             data.meshletListCounterBuffer = builder.Read(build_meshlet_list_pass->meshletListCounterBuffer, 0, RGBuilderFlag::ShaderStageNonPS);
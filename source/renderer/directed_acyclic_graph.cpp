@@ -40,6 +40,14 @@ void DirectedAcyclicGraph::RegisterNode(DAGNode* node)
     m_nodes.push_back(node);
 }
 
+void DirectedAcyclicGraph::AddNode(DAGNode* node)
+{
+    RE_ASSERT(node->m_ID == UINT32_MAX);
+    node->m_ID = GenerateNodeId();
+
+    RegisterNode(node);
+}
+
 void DirectedAcyclicGraph::RegisterEdge(DAGEdge* edge)
 {
     m_edges.push_back(edge);
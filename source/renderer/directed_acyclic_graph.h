@@ -28,6 +28,7 @@ class DAGNode
     friend class DirectedAcyclicGraph;
 public:
     DAGNode(DirectedAcyclicGraph& graph);
+    DAGNode() {} //not registered until DirectedAcyclicGraph::AddNode
     virtual ~DAGNode() {}
 
     DAGNodeID GetId() const { return m_ID; }
@@ -46,7 +47,7 @@ public:
     eastl::string Graphvizify() const;
 
 private:
-    DAGNodeID m_ID;
+    DAGNodeID m_ID = UINT32_MAX;
     uint32_t m_nRefCount = 0;
 
     static const uint32_t TARGET = 0x80000000u;
@@ -57,9 +58,12 @@ class DirectedAcyclicGraph
 public:
     DAGNodeID GenerateNodeId() { return (DAGNodeID)m_nodes.size(); }
     DAGNode* GetNode(DAGNodeID id) const { return m_nodes[id]; }
+    uint32_t GetNodeCount() const { return (uint32_t)m_nodes.size(); }
+    const eastl::vector<DAGEdge*>& GetEdges() const { return m_edges; } //in the creation order
     DAGEdge* GetEdge(DAGNodeID from, DAGNodeID to) const;
 
     void RegisterNode(DAGNode* node);
+    void AddNode(DAGNode* node);
     void RegisterEdge(DAGEdge* edge);
 
     void Clear();
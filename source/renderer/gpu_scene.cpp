@@ -117,11 +117,10 @@ void GpuScene::BuildRayTracingAS(IGfxCommandList* pCommandList)
 
 uint32_t GpuScene::AllocateConstantBuffer(uint32_t size)
 {
-    RE_ASSERT(m_nConstantBufferOffset + size <= MAX_CONSTANT_BUFFER_SIZE);
     RE_ASSERT(size % 4 == 0);
 
-    uint32_t address = m_nConstantBufferOffset;
-    m_nConstantBufferOffset += size;
+    uint32_t address = m_nConstantBufferOffset.fetch_add(size);
+    RE_ASSERT(address + size <= MAX_CONSTANT_BUFFER_SIZE);
 
     return address;
 }
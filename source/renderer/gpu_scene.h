@@ -3,6 +3,7 @@
 #include "resource/raw_buffer.h"
 #include "utils/math.h"
 #include "gpu_scene.hlsli"
+#include "EASTL/atomic.h"
 
 class Renderer;
 namespace D3D12MA { class VirtualBlock; }
@@ -19,7 +20,7 @@ public:
     uint32_t AllocateAnimationBuffer(uint32_t size, uint32_t alignment);
     void FreeAnimationBuffer(uint32_t address);
 
-    uint32_t AllocateConstantBuffer(uint32_t size);
+    uint32_t AllocateConstantBuffer(uint32_t size); //thread safe
 
     uint32_t AddInstance(const InstanceData& data, IGfxRayTracingBLAS* blas, GfxRayTracingInstanceFlag flags);
     uint32_t GetInstanceCount() const { return (uint32_t)m_instanceData.size(); }
@@ -58,7 +59,7 @@ private:
     D3D12MA::VirtualBlock* m_pSceneAnimationBufferAllocator = nullptr;
 
     eastl::unique_ptr<RawBuffer> m_pConstantBuffer[GFX_MAX_INFLIGHT_FRAMES]; //todo : change to gpu memory, and only update dirty regions
-    uint32_t m_nConstantBufferOffset = 0;
+    eastl::atomic<uint32_t> m_nConstantBufferOffset{ 0 };
 
     eastl::unique_ptr<IGfxRayTracingTLAS> m_pSceneTLAS;
     eastl::unique_ptr<IGfxDescriptor> m_pSceneTLASSRV;
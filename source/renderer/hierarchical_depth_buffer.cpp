@@ -97,10 +97,13 @@ void HZB::Generate1stPhaseCullingHZB(RenderGraph* graph)
         {
             data.hzb = builder.Read(dilation_pass->dilatedDepth);
 
+            //the mips are written by one dispatch, they are one version in the graph
+            RGHandle hzb_mips = builder.WriteViews(hzb, 1, m_nHZBMipCount - 1);
+
             m_1stPhaseCullingHZBMips[0] = data.hzb;
             for (uint32_t i = 1; i < m_nHZBMipCount; ++i)
             {
-                m_1stPhaseCullingHZBMips[i] = builder.Write(hzb, i);
+                m_1stPhaseCullingHZBMips[i] = hzb_mips;
             }
         },
         [=](const BuildHZBData& data, IGfxCommandList* pCommandList)
@@ -151,10 +154,13 @@ void HZB::Generate2ndPhaseCullingHZB(RenderGraph* graph, RGHandle depthRT)
         {
             data.hzb = builder.Read(init_hzb->hzb);
 
+            //the mips are written by one dispatch, they are one version in the graph
+            RGHandle hzb_mips = builder.WriteViews(hzb, 1, m_nHZBMipCount - 1);
+
             m_2ndPhaseCullingHZBMips[0] = data.hzb;
             for (uint32_t i = 1; i < m_nHZBMipCount; ++i)
             {
-                m_2ndPhaseCullingHZBMips[i] = builder.Write(hzb, i);
+                m_2ndPhaseCullingHZBMips[i] = hzb_mips;
             }
         },
         [=](const BuildHZBData& data, IGfxCommandList* pCommandList)
@@ -205,10 +211,13 @@ void HZB::GenerateSceneHZB(RenderGraph* graph, RGHandle depthRT)
         {
             data.hzb = builder.Read(init_hzb->hzb);
 
+            //the mips are written by one dispatch, they are one version in the graph
+            RGHandle hzb_mips = builder.WriteViews(hzb, 1, m_nHZBMipCount - 1);
+
             m_sceneHZBMips[0] = data.hzb;
             for (uint32_t i = 1; i < m_nHZBMipCount; ++i)
             {
-                m_sceneHZBMips[i] = builder.Write(hzb, i);
+                m_sceneHZBMips[i] = hzb_mips;
             }
         },
         [=](const BuildHZBData& data, IGfxCommandList* pCommandList)
@@ -94,6 +94,8 @@ RGHandle GTAO::Render(RenderGraph* pRenderGraph, RGHandle depthRT, RGHandle norm
     auto gtao_filter_depth_pass = pRenderGraph->AddPass<FilterDepthPassData>("GTAO filter depth", RenderPassType::Compute,
         [&](FilterDepthPassData& data, RGBuilder& builder)
         {
+            builder.AllowAsyncCompute();
+
             data.inputDepth = builder.Read(depthRT);
 
             RGTexture::Desc desc;
@@ -128,6 +130,8 @@ RGHandle GTAO::Render(RenderGraph* pRenderGraph, RGHandle depthRT, RGHandle norm
     auto gtao_pass = pRenderGraph->AddPass<GTAOPassData>("GTAO", RenderPassType::Compute,
         [&](GTAOPassData& data, RGBuilder& builder)
         {
+            builder.AllowAsyncCompute();
+
             data.inputFilteredDepth = builder.Read(gtao_filter_depth_pass->outputDepthMip0, 0);
             data.inputFilteredDepth = builder.Read(gtao_filter_depth_pass->outputDepthMip1, 1);
             data.inputFilteredDepth = builder.Read(gtao_filter_depth_pass->outputDepthMip2, 2);
@@ -167,6 +171,8 @@ RGHandle GTAO::Render(RenderGraph* pRenderGraph, RGHandle depthRT, RGHandle norm
     auto gtao_denoise_pass = pRenderGraph->AddPass<DenoisePassData>("GTAO denoise", RenderPassType::Compute,
         [&](DenoisePassData& data, RGBuilder& builder)
         {
+            builder.AllowAsyncCompute();
+
             data.inputAOTerm = builder.Read(gtao_pass->outputAOTerm);
             data.inputEdge = builder.Read(gtao_pass->outputEdge);
 
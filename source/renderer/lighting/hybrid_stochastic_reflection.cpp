@@ -171,10 +171,8 @@ RGHandle HybridStochasticReflection::Render(RenderGraph* pRenderGraph, RGHandle
             data.prevSceneColor = builder.Read(m_pRenderer->GetPrevSceneColorHandle());
 
             HZB* pHZB = m_pRenderer->GetHZB();
-            for (uint32_t i = 0; i < pHZB->GetHZBMipCount(); ++i)
-            {
-                data.sceneHZB = builder.Read(pHZB->GetSceneHZBMip(i), i);
-            }
+            data.sceneHZB = builder.Read(pHZB->GetSceneHZBMip(0), 0);
+            data.sceneHZB = builder.ReadViews(pHZB->GetSceneHZBMip(1), 1, pHZB->GetHZBMipCount() - 1);
 
             RGTexture::Desc desc;
             desc.width = width;
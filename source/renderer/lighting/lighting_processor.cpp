@@ -87,7 +87,7 @@ RGHandle LightingProcessor::CompositeLight(RenderGraph* pRenderGraph, RGHandle d
             desc.width = width;
             desc.height = height;
             desc.format = GfxFormat::RGBA16F;
-            data.output = builder.Create<RGTexture>(desc, "SceneColor RT");
+            data.output = builder.CreateHistory(desc, "SceneColor RT");
             data.output = builder.Write(data.output);
         },
         [=](const CompositeLightData& data, IGfxCommandList* pCommandList)
@@ -104,75 +104,75 @@ RGHandle LightingProcessor::CompositeLight(RenderGraph* pRenderGraph, RGHandle d
             RGTexture* indirectSpecularRT = nullptr;
             RGTexture* indirectDiffuseRT = nullptr;
 
-            eastl::vector<eastl::string> defines;
+            ShaderPermutation permutation("composite_light.hlsl", "main", "cs_6_6");
             if (data.ao.IsValid())
             {
                 aoRT = pRenderGraph->GetTexture(data.ao);
 
-                defines.push_back("GTAO=1");
+                permutation.AddDefine("GTAO=1");
 
                 if (aoRT->GetTexture()->GetDesc().format == GfxFormat::R32UI)
                 {
-                    defines.push_back("GTSO=1");
+                    permutation.AddDefine("GTSO=1");
                 }
             }
 
             if (data.indirectSpecular.IsValid())
             {
                 indirectSpecularRT = pRenderGraph->GetTexture(data.indirectSpecular);
-                defines.push_back("SPECULAR_GI=1");
+                permutation.AddDefine("SPECULAR_GI=1");
             }
 
             if (data.indirectDiffuse.IsValid())
             {
                 indirectDiffuseRT = pRenderGraph->GetTexture(data.indirectDiffuse);
-                defines.push_back("DIFFUSE_GI=1");
+                permutation.AddDefine("DIFFUSE_GI=1");
             }
 
             switch (m_pRenderer->GetOutputType())
             {
             case RendererOutput::Default:
-                defines.push_back("OUTPUT_DEFAULT=1");
+                permutation.AddDefine("OUTPUT_DEFAULT=1");
                 break;
             case RendererOutput::Diffuse:
-                defines.push_back("OUTPUT_DIFFUSE=1");
+                permutation.AddDefine("OUTPUT_DIFFUSE=1");
                 break;
             case RendererOutput::Specular:
-                defines.push_back("OUTPUT_SPECULAR=1");
+                permutation.AddDefine("OUTPUT_SPECULAR=1");
                 break;
             case RendererOutput::WorldNormal:
-                defines.push_back("OUTPUT_WORLDNORMAL=1");
+                permutation.AddDefine("OUTPUT_WORLDNORMAL=1");
                 break;
             case RendererOutput::Roughness:
-                defines.push_back("OUTPUT_ROUGHNESS=1");
+                permutation.AddDefine("OUTPUT_ROUGHNESS=1");
                 break;
             case RendererOutput::Emissive:
-                defines.push_back("OUTPUT_EMISSIVE=1");
+                permutation.AddDefine("OUTPUT_EMISSIVE=1");
                 break;
             case RendererOutput::ShadingModel:
-                defines.push_back("OUTPUT_SHADING_MODEL=1");
+                permutation.AddDefine("OUTPUT_SHADING_MODEL=1");
                 break;
             case RendererOutput::CustomData:
-                defines.push_back("OUTPUT_CUSTOM_DATA=1");
+                permutation.AddDefine("OUTPUT_CUSTOM_DATA=1");
                 break;
             case RendererOutput::AO:
-                defines.push_back("OUTPUT_AO=1");
+                permutation.AddDefine("OUTPUT_AO=1");
                 break;
             case RendererOutput::DirectLighting:
-                defines.push_back("OUTPUT_DIRECT_LIGHTING=1");
+                permutation.AddDefine("OUTPUT_DIRECT_LIGHTING=1");
                 break;
             case RendererOutput::IndirectSpecular:
-                defines.push_back("OUTPUT_INDIRECT_SPECULAR=1");
+                permutation.AddDefine("OUTPUT_INDIRECT_SPECULAR=1");
                 break;
             case RendererOutput::IndirectDiffuse:
-                defines.push_back("OUTPUT_INDIRECT_DIFFUSE=1");
+                permutation.AddDefine("OUTPUT_INDIRECT_DIFFUSE=1");
                 break;
             default:
                 break;
             }
 
             GfxComputePipelineDesc psoDesc;
-            psoDesc.cs = m_pRenderer->GetShader("composite_light.hlsl", "main", "cs_6_6", defines);
+            psoDesc.cs = m_pRenderer->GetShader(permutation);
             IGfxPipelineState* pso = m_pRenderer->GetPipelineState(psoDesc, "CompositeLight PSO");
 
             pCommandList->SetPipelineState(pso);
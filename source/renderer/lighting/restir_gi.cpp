@@ -120,6 +120,8 @@ RGHandle ReSTIRGI::Render(RenderGraph* pRenderGraph, RGHandle halfDepthNormal, R
         auto temporal_reuse_pass = pRenderGraph->AddPass<TemporalReusePassData>("ReSTIR GI - temporal resampling", RenderPassType::Compute,
             [&](TemporalReusePassData& data, RGBuilder& builder)
             {
+                builder.AllowAsyncCompute();
+
                 data.halfDepthNormal = builder.Read(halfDepthNormal);
                 data.velocity = builder.Read(velocity);
                 data.candidateRadiance = builder.Read(raytrace_pass->outputRadiance);
@@ -161,6 +163,8 @@ RGHandle ReSTIRGI::Render(RenderGraph* pRenderGraph, RGHandle halfDepthNormal, R
         auto spatial_reuse_pass0 = pRenderGraph->AddPass<SpatialReusePassData>("ReSTIR GI - spatial resampling", RenderPassType::Compute,
             [&](SpatialReusePassData& data, RGBuilder& builder)
             {
+                builder.AllowAsyncCompute();
+
                 data.halfDepthNormal = builder.Read(halfDepthNormal);
                 data.inputReservoirSampleRadiance = builder.Read(temporal_reuse_pass->outputReservoirSampleRadiance);
                 data.inputReservoirRayDirection = builder.Read(temporal_reuse_pass->outputReservoirRayDirection);
@@ -194,6 +198,8 @@ RGHandle ReSTIRGI::Render(RenderGraph* pRenderGraph, RGHandle halfDepthNormal, R
         auto spatial_reuse_pass1 = pRenderGraph->AddPass<SpatialReusePassData>("ReSTIR GI - spatial resampling", RenderPassType::Compute,
             [&](SpatialReusePassData& data, RGBuilder& builder)
             {
+                builder.AllowAsyncCompute();
+
                 data.halfDepthNormal = builder.Read(halfDepthNormal);
                 data.inputReservoirSampleRadiance = builder.Read(spatial_reuse_pass0->outputReservoirSampleRadiance);
                 data.inputReservoirRayDirection = builder.Read(spatial_reuse_pass0->outputReservoirRayDirection);
@@ -244,6 +250,8 @@ RGHandle ReSTIRGI::Render(RenderGraph* pRenderGraph, RGHandle halfDepthNormal, R
     auto resolve_pass = pRenderGraph->AddPass<ResolvePassData>("ReSTIR GI - resolve", RenderPassType::Compute,
         [&](ResolvePassData& data, RGBuilder& builder)
         {
+            builder.AllowAsyncCompute();
+
             if (m_bEnableReSTIR)
             {
                 data.reservoir = builder.Read(reservoir);
@@ -394,20 +402,20 @@ void ReSTIRGI::SpatialResampling(IGfxCommandList* pCommandList, RGTexture* halfD
 void ReSTIRGI::Resolve(IGfxCommandList* pCommandList, RGTexture* reservoir, RGTexture* radiance, RGTexture* rayDirection, RGTexture* halfDepthNormal, RGTexture* depth, RGTexture* normal, 
     RGTexture* output, RGTexture* outputVariance, uint32_t width, uint32_t height)
 {
-    eastl::vector<eastl::string> defines;
+    ShaderPermutation permutation("restir_gi/restir_resolve.hlsl", "main", "cs_6_6");
 
     if (m_bEnableReSTIR)
     {
-        defines.push_back("ENABLE_RESTIR=1");
+        permutation.AddDefine("ENABLE_RESTIR=1");
     }
 
     if (m_bEnableDenoiser)
     {
-        defines.push_back("OUTPUT_SH=1");
+        permutation.AddDefine("OUTPUT_SH=1");
     }
 
     GfxComputePipelineDesc desc;
-    desc.cs = m_pRenderer->GetShader("restir_gi/restir_resolve.hlsl", "main", "cs_6_6", defines);
+    desc.cs = m_pRenderer->GetShader(permutation);
     IGfxPipelineState* pso = m_pRenderer->GetPipelineState(desc, "ReSTIR GI/resolve PSO");
 
     pCommandList->SetPipelineState(pso);
@@ -99,7 +99,7 @@ RGHandle PathTracer::Render(RenderGraph* pRenderGraph, RGHandle depth, uint32_t
             desc.width = width;
             desc.height = height;
             desc.format = GfxFormat::RGBA16F;
-            data.output = builder.Create<RGTexture>(desc, "SceneColor RT");
+            data.output = builder.CreateHistory(desc, "SceneColor RT");
             data.output = builder.Write(data.output);
         },
         [=](const AccumulationData& data, IGfxCommandList* pCommandList)
@@ -1,16 +1,16 @@
 #include "pipeline_cache.h"
 #include "renderer.h"
+#include "shader_cache.h"
+#include "utils/log.h"
+#include "utils/profiler.h"
+#include "core/engine.h"
+#include "enkiTS/TaskScheduler.h"
+#include <fstream>
+#include <filesystem>
 
 inline bool operator==(const GfxGraphicsPipelineDesc& lhs, const GfxGraphicsPipelineDesc& rhs)
 {
-    if (lhs.vs->GetHash() != rhs.vs->GetHash())
-    {
-        return false;
-    }
-
-    uint64_t lhs_ps_hash = lhs.ps ? lhs.ps->GetHash() : 0;
-    uint64_t rhs_ps_hash = rhs.ps ? rhs.ps->GetHash() : 0;
-    if (lhs_ps_hash != rhs_ps_hash)
+    if (lhs.vs != rhs.vs || lhs.ps != rhs.ps)
     {
         return false;
     }
@@ -24,21 +24,7 @@ inline bool operator==(const GfxGraphicsPipelineDesc& lhs, const GfxGraphicsPipe
 
 inline bool operator==(const GfxMeshShadingPipelineDesc& lhs, const GfxMeshShadingPipelineDesc& rhs)
 {
-    if (lhs.ms->GetHash() != rhs.ms->GetHash())
-    {
-        return false;
-    }
-
-    uint64_t lhs_ps_hash = lhs.ps ? lhs.ps->GetHash() : 0;
-    uint64_t rhs_ps_hash = rhs.ps ? rhs.ps->GetHash() : 0;
-    if (lhs_ps_hash != rhs_ps_hash)
-    {
-        return false;
-    }
-
-    uint64_t lhs_as_hash = lhs.as ? lhs.as->GetHash() : 0;
-    uint64_t rhs_as_hash = rhs.as ? rhs.as->GetHash() : 0;
-    if (lhs_as_hash != rhs_as_hash)
+    if (lhs.ms != rhs.ms || lhs.ps != rhs.ps || lhs.as != rhs.as)
     {
         return false;
     }
@@ -52,7 +38,87 @@ inline bool operator==(const GfxMeshShadingPipelineDesc& lhs, const GfxMeshShadi
 
 inline bool operator==(const GfxComputePipelineDesc& lhs, const GfxComputePipelineDesc& rhs)
 {
-    return lhs.cs->GetHash() == rhs.cs->GetHash();
+    return lhs.cs == rhs.cs;
+}
+
+#define PIPELINE_MANIFEST_MAGIC 0x4d505245 //"ERPM"
+#define PIPELINE_MANIFEST_VERSION 1
+
+struct PipelineManifestHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t shaderCount;
+    uint32_t graphicsPSOCount;
+    uint32_t meshShadingPSOCount;
+    uint32_t computePSOCount;
+};
+
+inline void WriteString(std::ofstream& os, const eastl::string& s)
+{
+    uint32_t length = (uint32_t)s.size();
+    os.write((const char*)&length, sizeof(length));
+    os.write(s.data(), length);
+}
+
+inline eastl::string ReadString(std::ifstream& is)
+{
+    uint32_t length = 0;
+    is.read((char*)&length, sizeof(length));
+
+    eastl::string s;
+    if (!is.fail())
+    {
+        s.resize(length);
+        is.read((char*)s.data(), length);
+    }
+    return s;
+}
+
+inline void WriteShaderIndex(std::ofstream& os, const eastl::hash_map<IGfxShader*, uint32_t>& shaderIndices, IGfxShader* shader)
+{
+    uint32_t index = shader ? shaderIndices.find(shader)->second : -1;
+    os.write((const char*)&index, sizeof(index));
+}
+
+inline IGfxShader* ReadShaderIndex(std::ifstream& is, const eastl::vector<IGfxShader*>& shaders)
+{
+    uint32_t index = -1;
+    is.read((char*)&index, sizeof(index));
+    return index < shaders.size() ? shaders[index] : nullptr;
+}
+
+//the states of the pipeline descs are POD (#pragma pack 1) after the shader pointers
+template<typename T>
+inline void WritePipelineStates(std::ofstream& os, const T& desc)
+{
+    const size_t state_offset = offsetof(T, rasterizer_state);
+    os.write((const char*)&desc + state_offset, sizeof(T) - state_offset);
+}
+
+template<typename T>
+inline void ReadPipelineStates(std::ifstream& is, T& desc)
+{
+    const size_t state_offset = offsetof(T, rasterizer_state);
+    is.read((char*)&desc + state_offset, sizeof(T) - state_offset);
+}
+
+//a shader whose compilation failed has no data, the PSOs using it are created by RecreatePSO after it is fixed
+static inline bool IsCompiled(const IGfxShader* shader)
+{
+    return shader == nullptr || shader->IsCompiled();
+}
+
+static inline bool AreShadersCompiled(const eastl::vector<IGfxShader*>& shaders)
+{
+    for (size_t i = 0; i < shaders.size(); ++i)
+    {
+        if (!IsCompiled(shaders[i]))
+        {
+            return false;
+        }
+    }
+    return true;
 }
 
 PipelineStateCache::PipelineStateCache(Renderer* pRenderer)
@@ -60,66 +126,73 @@ PipelineStateCache::PipelineStateCache(Renderer* pRenderer)
     m_pRenderer = pRenderer;
 }
 
-IGfxPipelineState* PipelineStateCache::GetPipelineState(const GfxGraphicsPipelineDesc& desc, const eastl::string& name)
+PipelineStateCache::~PipelineStateCache()
 {
+    //the pending tasks are completed by the task scheduler shutdown, which happens before the renderer is destroyed
+}
+
+IGfxPipelineState* PipelineStateCache::GetPipelineState(const GfxGraphicsPipelineDesc& desc, const char* name, bool async)
+{
+    //nullptr until the shaders are compiled, or if their compilation failed
     auto iter = m_cachedGraphicsPSO.find(desc);
     if (iter != m_cachedGraphicsPSO.end())
     {
-        return iter->second.get();
+        return IsCompiled(desc.vs) && IsCompiled(desc.ps) ? iter->second.get() : nullptr;
     }
 
     IGfxPipelineState* pPSO = m_pRenderer->GetDevice()->CreateGraphicsPipelineState(desc, name);
-    if (pPSO)
-    {
-        m_cachedGraphicsPSO.insert(eastl::make_pair(desc, eastl::unique_ptr<IGfxPipelineState>(pPSO)));
-    }
+    m_cachedGraphicsPSO.insert(eastl::make_pair(desc, eastl::unique_ptr<IGfxPipelineState>(pPSO)));
+
+    CreatePSO(pPSO, { desc.vs, desc.ps }, async);
 
-    return pPSO;
+    return IsCompiled(desc.vs) && IsCompiled(desc.ps) ? pPSO : nullptr;
 }
 
-IGfxPipelineState* PipelineStateCache::GetPipelineState(const GfxMeshShadingPipelineDesc& desc, const eastl::string& name)
+IGfxPipelineState* PipelineStateCache::GetPipelineState(const GfxMeshShadingPipelineDesc& desc, const char* name, bool async)
 {
+    //nullptr until the shaders are compiled, or if their compilation failed
     auto iter = m_cachedMeshShadingPSO.find(desc);
     if (iter != m_cachedMeshShadingPSO.end())
     {
-        return iter->second.get();
+        return IsCompiled(desc.as) && IsCompiled(desc.ms) && IsCompiled(desc.ps) ? iter->second.get() : nullptr;
     }
 
     IGfxPipelineState* pPSO = m_pRenderer->GetDevice()->CreateMeshShadingPipelineState(desc, name);
-    if (pPSO)
-    {
-        m_cachedMeshShadingPSO.insert(eastl::make_pair(desc, eastl::unique_ptr<IGfxPipelineState>(pPSO)));
-    }
+    m_cachedMeshShadingPSO.insert(eastl::make_pair(desc, eastl::unique_ptr<IGfxPipelineState>(pPSO)));
+
+    CreatePSO(pPSO, { desc.as, desc.ms, desc.ps }, async);
 
-    return pPSO;
+    return IsCompiled(desc.as) && IsCompiled(desc.ms) && IsCompiled(desc.ps) ? pPSO : nullptr;
 }
 
-IGfxPipelineState* PipelineStateCache::GetPipelineState(const GfxComputePipelineDesc& desc, const eastl::string& name)
+IGfxPipelineState* PipelineStateCache::GetPipelineState(const GfxComputePipelineDesc& desc, const char* name, bool async)
 {
+    //nullptr until the shaders are compiled, or if their compilation failed
     auto iter = m_cachedComputePSO.find(desc);
     if (iter != m_cachedComputePSO.end())
     {
-        return iter->second.get();
+        return IsCompiled(desc.cs) ? iter->second.get() : nullptr;
     }
 
     IGfxPipelineState* pPSO = m_pRenderer->GetDevice()->CreateComputePipelineState(desc, name);
-    if (pPSO)
-    {
-        m_cachedComputePSO.insert(eastl::make_pair(desc, eastl::unique_ptr<IGfxPipelineState>(pPSO)));
-    }
+    m_cachedComputePSO.insert(eastl::make_pair(desc, eastl::unique_ptr<IGfxPipelineState>(pPSO)));
 
-    return pPSO;
+    CreatePSO(pPSO, { desc.cs }, async);
+
+    return IsCompiled(desc.cs) ? pPSO : nullptr;
 }
 
 void PipelineStateCache::RecreatePSO(IGfxShader* shader)
 {
+    WaitForCreation();
+
     for (auto iter = m_cachedGraphicsPSO.begin(); iter != m_cachedGraphicsPSO.end(); ++iter)
     {
         const GfxGraphicsPipelineDesc& desc = iter->first;
         IGfxPipelineState* pso = iter->second.get();
 
-        if (desc.vs == shader ||
-            desc.ps == shader)
+        if ((desc.vs == shader || desc.ps == shader) &&
+            IsCompiled(desc.vs) && IsCompiled(desc.ps))
         {
             pso->Create();
         }
@@ -130,9 +203,8 @@ void PipelineStateCache::RecreatePSO(IGfxShader* shader)
         const GfxMeshShadingPipelineDesc& desc = iter->first;
         IGfxPipelineState* pso = iter->second.get();
 
-        if (desc.as == shader ||
-            desc.ms == shader ||
-            desc.ps == shader)
+        if ((desc.as == shader || desc.ms == shader || desc.ps == shader) &&
+            IsCompiled(desc.as) && IsCompiled(desc.ms) && IsCompiled(desc.ps))
         {
             pso->Create();
         }
@@ -149,3 +221,331 @@ void PipelineStateCache::RecreatePSO(IGfxShader* shader)
         }
     }
 }
+
+bool PipelineStateCache::IsReady(IGfxPipelineState* pso) const
+{
+    auto iter = m_asyncCreateTasks.find(pso);
+    if (iter != m_asyncCreateTasks.end())
+    {
+        return iter->second->GetIsComplete();
+    }
+    return true;
+}
+
+void PipelineStateCache::WaitForCreation()
+{
+    if (m_createTasks.empty() && m_asyncCreateTasks.empty())
+    {
+        return;
+    }
+
+    CPU_EVENT("Render", "PipelineStateCache::WaitForCreation");
+
+    enki::TaskScheduler* ts = Engine::GetInstance()->GetTaskScheduler();
+    for (size_t i = 0; i < m_createTasks.size(); ++i)
+    {
+        ts->WaitforTask(m_createTasks[i].get());
+    }
+
+    for (auto iter = m_asyncCreateTasks.begin(); iter != m_asyncCreateTasks.end(); ++iter)
+    {
+        ts->WaitforTask(iter->second.get());
+    }
+
+    m_createTasks.clear();
+    m_asyncCreateTasks.clear();
+}
+
+void PipelineStateCache::Update()
+{
+    CPU_EVENT("Render", "PipelineStateCache::Update");
+
+    enki::TaskScheduler* ts = Engine::GetInstance()->GetTaskScheduler();
+    for (size_t i = 0; i < m_createTasks.size(); ++i)
+    {
+        ts->WaitforTask(m_createTasks[i].get());
+    }
+    m_createTasks.clear();
+
+    for (auto iter = m_asyncCreateTasks.begin(); iter != m_asyncCreateTasks.end();)
+    {
+        if (iter->second->GetIsComplete())
+        {
+            iter = m_asyncCreateTasks.erase(iter);
+        }
+        else
+        {
+            ++iter;
+        }
+    }
+
+    //pending PSO tasks hold the compile tasks of their shaders
+    if (m_asyncCreateTasks.empty())
+    {
+        m_pRenderer->GetShaderCache()->ReleaseCompletedTasks();
+    }
+}
+
+bool PipelineStateCache::LoadPipelineCache(const eastl::string& file)
+{
+    std::ifstream is;
+    is.open(file.c_str(), std::ios::binary);
+    if (is.fail())
+    {
+        return false;
+    }
+
+    is.seekg(0, std::ios::end);
+    eastl::vector<uint8_t> data((size_t)is.tellg());
+    is.seekg(0, std::ios::beg);
+    is.read((char*)data.data(), data.size());
+
+    if (is.fail() || !m_pRenderer->GetDevice()->LoadPipelineCache(data))
+    {
+        RE_LOG("the pipeline cache is invalid or outdated : {}", file.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+void PipelineStateCache::SavePipelineCache(const eastl::string& file)
+{
+    WaitForCreation();
+
+    eastl::vector<uint8_t> data;
+    if (!m_pRenderer->GetDevice()->SavePipelineCache(data))
+    {
+        return;
+    }
+
+    std::ofstream os;
+    os.open(file.c_str(), std::ios::binary);
+    if (!os.fail())
+    {
+        os.write((const char*)data.data(), data.size());
+    }
+}
+
+void PipelineStateCache::CreatePSO(IGfxPipelineState* pPSO, const eastl::vector<IGfxShader*>& shaders, bool async)
+{
+    async = async && m_bAsyncCreation;
+
+    ShaderCache* shaderCache = m_pRenderer->GetShaderCache();
+
+    eastl::vector<enki::TaskSet*> shaderTasks;
+    for (size_t i = 0; i < shaders.size(); ++i)
+    {
+        enki::TaskSet* task = shaders[i] ? shaderCache->GetCompileTask(shaders[i]) : nullptr;
+        if (task != nullptr)
+        {
+            shaderTasks.push_back(task);
+        }
+    }
+
+    //PSOs requested in the frame are bound right away, so they are created before returning.
+    //only the async ones (checked with IsReady) and the manifest warm-up (waited for in BeginFrame) are deferred
+    if (!async && !m_bDeferCreation)
+    {
+        enki::TaskScheduler* ts = Engine::GetInstance()->GetTaskScheduler();
+        for (size_t i = 0; i < shaderTasks.size(); ++i)
+        {
+            ts->WaitforTask(shaderTasks[i]);
+        }
+
+        if (AreShadersCompiled(shaders) && !pPSO->Create())
+        {
+            RE_LOG("failed to create PSO : {}", pPSO->GetName().c_str());
+        }
+        return;
+    }
+
+    //the PSO is created on a worker thread after its shaders are compiled
+    enki::TaskSet* task = new enki::TaskSet([pPSO, shaders, shaderTasks](enki::TaskSetPartition range, uint32_t threadnum)
+        {
+            enki::TaskScheduler* ts = Engine::GetInstance()->GetTaskScheduler();
+            for (size_t i = 0; i < shaderTasks.size(); ++i)
+            {
+                ts->WaitforTask(shaderTasks[i]);
+            }
+
+            if (AreShadersCompiled(shaders) && !pPSO->Create())
+            {
+                RE_LOG("failed to create PSO : {}", pPSO->GetName().c_str());
+            }
+        });
+
+    if (async)
+    {
+        m_asyncCreateTasks.insert(eastl::make_pair(pPSO, eastl::unique_ptr<enki::TaskSet>(task)));
+    }
+    else
+    {
+        m_createTasks.emplace_back(task);
+    }
+
+    Engine::GetInstance()->GetTaskScheduler()->AddTaskSetToPipe(task);
+}
+
+void PipelineStateCache::SaveManifest(const eastl::string& file)
+{
+    std::ofstream os;
+    os.open(file.c_str(), std::ios::binary);
+    if (os.fail())
+    {
+        return;
+    }
+
+    eastl::vector<IGfxShader*> shaders = m_pRenderer->GetShaderCache()->GetCachedShaders();
+    eastl::hash_map<IGfxShader*, uint32_t> shaderIndices;
+
+    PipelineManifestHeader header;
+    header.magic = PIPELINE_MANIFEST_MAGIC;
+    header.version = PIPELINE_MANIFEST_VERSION;
+    header.shaderCount = (uint32_t)shaders.size();
+    header.graphicsPSOCount = (uint32_t)m_cachedGraphicsPSO.size();
+    header.meshShadingPSOCount = (uint32_t)m_cachedMeshShadingPSO.size();
+    header.computePSOCount = (uint32_t)m_cachedComputePSO.size();
+    os.write((const char*)&header, sizeof(header));
+
+    //shader files are stored relative to the shader path, like the ones passed to ShaderCache::GetShader
+    std::filesystem::path shader_path = std::filesystem::absolute(Engine::GetInstance()->GetShaderPath().c_str());
+
+    for (size_t i = 0; i < shaders.size(); ++i)
+    {
+        const GfxShaderDesc& desc = shaders[i]->GetDesc();
+        shaderIndices.insert(eastl::make_pair(shaders[i], (uint32_t)i));
+
+        WriteString(os, std::filesystem::relative(desc.file.c_str(), shader_path).generic_string().c_str());
+        WriteString(os, desc.entry_point);
+        WriteString(os, desc.profile);
+
+        uint32_t define_count = (uint32_t)desc.defines.size();
+        os.write((const char*)&define_count, sizeof(define_count));
+        for (uint32_t d = 0; d < define_count; ++d)
+        {
+            WriteString(os, desc.defines[d]);
+        }
+
+        os.write((const char*)&desc.flags, sizeof(desc.flags));
+    }
+
+    for (auto iter = m_cachedGraphicsPSO.begin(); iter != m_cachedGraphicsPSO.end(); ++iter)
+    {
+        WriteString(os, iter->second->GetName());
+        WriteShaderIndex(os, shaderIndices, iter->first.vs);
+        WriteShaderIndex(os, shaderIndices, iter->first.ps);
+        WritePipelineStates(os, iter->first);
+    }
+
+    for (auto iter = m_cachedMeshShadingPSO.begin(); iter != m_cachedMeshShadingPSO.end(); ++iter)
+    {
+        WriteString(os, iter->second->GetName());
+        WriteShaderIndex(os, shaderIndices, iter->first.as);
+        WriteShaderIndex(os, shaderIndices, iter->first.ms);
+        WriteShaderIndex(os, shaderIndices, iter->first.ps);
+        WritePipelineStates(os, iter->first);
+    }
+
+    for (auto iter = m_cachedComputePSO.begin(); iter != m_cachedComputePSO.end(); ++iter)
+    {
+        WriteString(os, iter->second->GetName());
+        WriteShaderIndex(os, shaderIndices, iter->first.cs);
+    }
+}
+
+void PipelineStateCache::LoadManifest(const eastl::string& file)
+{
+    CPU_EVENT("Render", "PipelineStateCache::LoadManifest");
+
+    std::ifstream is;
+    is.open(file.c_str(), std::ios::binary);
+    if (is.fail())
+    {
+        return;
+    }
+
+    PipelineManifestHeader header;
+    is.read((char*)&header, sizeof(header));
+    if (is.fail() || header.magic != PIPELINE_MANIFEST_MAGIC || header.version != PIPELINE_MANIFEST_VERSION)
+    {
+        return;
+    }
+
+    //shaders and PSOs are compiled on the worker threads, Renderer::BeginFrame waits for all of them
+    m_bDeferCreation = true;
+
+    eastl::vector<IGfxShader*> shaders(header.shaderCount);
+
+    for (uint32_t i = 0; i < header.shaderCount && !is.fail(); ++i)
+    {
+        eastl::string shader_file = ReadString(is);
+        eastl::string entry_point = ReadString(is);
+        eastl::string profile = ReadString(is);
+
+        uint32_t define_count = 0;
+        is.read((char*)&define_count, sizeof(define_count));
+
+        eastl::vector<eastl::string> defines;
+        for (uint32_t d = 0; d < define_count && !is.fail(); ++d)
+        {
+            defines.push_back(ReadString(is));
+        }
+
+        GfxShaderCompilerFlags flags = 0;
+        is.read((char*)&flags, sizeof(flags));
+
+        if (!is.fail())
+        {
+            shaders[i] = m_pRenderer->GetShader(shader_file, entry_point, profile, defines, flags);
+        }
+    }
+
+    for (uint32_t i = 0; i < header.graphicsPSOCount && !is.fail(); ++i)
+    {
+        eastl::string name = ReadString(is);
+
+        GfxGraphicsPipelineDesc desc;
+        desc.vs = ReadShaderIndex(is, shaders);
+        desc.ps = ReadShaderIndex(is, shaders);
+        ReadPipelineStates(is, desc);
+
+        if (!is.fail() && desc.vs != nullptr)
+        {
+            GetPipelineState(desc, name.c_str());
+        }
+    }
+
+    for (uint32_t i = 0; i < header.meshShadingPSOCount && !is.fail(); ++i)
+    {
+        eastl::string name = ReadString(is);
+
+        GfxMeshShadingPipelineDesc desc;
+        desc.as = ReadShaderIndex(is, shaders);
+        desc.ms = ReadShaderIndex(is, shaders);
+        desc.ps = ReadShaderIndex(is, shaders);
+        ReadPipelineStates(is, desc);
+
+        if (!is.fail() && desc.ms != nullptr)
+        {
+            GetPipelineState(desc, name.c_str());
+        }
+    }
+
+    for (uint32_t i = 0; i < header.computePSOCount && !is.fail(); ++i)
+    {
+        eastl::string name = ReadString(is);
+
+        GfxComputePipelineDesc desc;
+        desc.cs = ReadShaderIndex(is, shaders);
+
+        if (!is.fail() && desc.cs != nullptr)
+        {
+            GetPipelineState(desc, name.c_str());
+        }
+    }
+
+    m_bDeferCreation = false;
+
+    RE_LOG("pipeline manifest : {} shaders, {} PSOs", header.shaderCount, header.graphicsPSOCount + header.meshShadingPSOCount + header.computePSOCount);
+}
\ No newline at end of file
@@ -16,6 +16,13 @@ inline uint64_t hash_combine_64(uint64_t hash0, uint64_t hash1)
     return b * kMul;
 }
 
+//shaders are unique per GfxShaderDesc in ShaderCache, so they are identified by address,
+//their bytecode hash is not known before the asynchronous compilation is done
+inline uint64_t shader_hash(const IGfxShader* shader)
+{
+    return shader ? XXH3_64bits(&shader, sizeof(shader)) : 0;
+}
+
 namespace eastl
 {
     template <>
@@ -23,8 +30,8 @@ namespace eastl
     {
         size_t operator()(const GfxGraphicsPipelineDesc& desc) const
         {
-            uint64_t vs_hash = desc.vs->GetHash();
-            uint64_t ps_hash = desc.ps ? desc.ps->GetHash() : 0;
+            uint64_t vs_hash = shader_hash(desc.vs);
+            uint64_t ps_hash = shader_hash(desc.ps);
 
             const size_t state_offset = offsetof(GfxGraphicsPipelineDesc, rasterizer_state);
             uint64_t state_hash = XXH3_64bits((char*)&desc + state_offset, sizeof(GfxGraphicsPipelineDesc) - state_offset);
@@ -41,9 +48,9 @@ namespace eastl
     {
         size_t operator()(const GfxMeshShadingPipelineDesc& desc) const
         {
-            uint64_t ms_hash = desc.ms->GetHash();
-            uint64_t as_hash = desc.as ? desc.as->GetHash() : 0;
-            uint64_t ps_hash = desc.ps ? desc.ps->GetHash() : 0;
+            uint64_t ms_hash = shader_hash(desc.ms);
+            uint64_t as_hash = shader_hash(desc.as);
+            uint64_t ps_hash = shader_hash(desc.ps);
 
             const size_t state_offset = offsetof(GfxMeshShadingPipelineDesc, rasterizer_state);
             uint64_t state_hash = XXH3_64bits((char*)&desc + state_offset, sizeof(GfxGraphicsPipelineDesc) - state_offset);
@@ -61,27 +68,56 @@ namespace eastl
         size_t operator()(const GfxComputePipelineDesc& desc) const
         {
             static_assert(sizeof(size_t) == sizeof(uint64_t), "only supports 64 bits platforms");
-            return desc.cs->GetHash();
+            return shader_hash(desc.cs);
         }
     };
 }
 
 class Renderer;
+namespace enki { class TaskSet; }
 
 class PipelineStateCache
 {
 public:
     PipelineStateCache(Renderer* pRenderer);
+    ~PipelineStateCache();
 
-    IGfxPipelineState* GetPipelineState(const GfxGraphicsPipelineDesc& desc, const eastl::string& name);
-    IGfxPipelineState* GetPipelineState(const GfxMeshShadingPipelineDesc& desc, const eastl::string& name);
-    IGfxPipelineState* GetPipelineState(const GfxComputePipelineDesc& desc, const eastl::string& name);
+    //in the async creation mode, PSOs requested with async=true are not waited for at the beginning of a frame,
+    //the caller should check IsReady and skip the draw (or use a fallback PSO) until they are created.
+    //returns nullptr while the shaders are not compiled, or if their compilation failed
+    //the name is copied only when a new PSO is created, the lookups don't allocate
+    IGfxPipelineState* GetPipelineState(const GfxGraphicsPipelineDesc& desc, const char* name, bool async = false);
+    IGfxPipelineState* GetPipelineState(const GfxMeshShadingPipelineDesc& desc, const char* name, bool async = false);
+    IGfxPipelineState* GetPipelineState(const GfxComputePipelineDesc& desc, const char* name, bool async = false);
+
+    bool IsAsyncCreation() const { return m_bAsyncCreation; }
+    void SetAsyncCreation(bool value) { m_bAsyncCreation = value; }
+    bool IsReady(IGfxPipelineState* pso) const;
 
     void RecreatePSO(IGfxShader* shader);
+    void WaitForCreation();
+    //waits for the required PSOs and releases the completed async ones, used instead of WaitForCreation in the async creation mode
+    void Update();
+
+    //driver PSO blobs, loaded before any PSO is created
+    bool LoadPipelineCache(const eastl::string& file);
+    void SavePipelineCache(const eastl::string& file);
+
+    //the manifest records every shader permutation and PSO used in a session, so they can be created before the first frame next time
+    void SaveManifest(const eastl::string& file);
+    void LoadManifest(const eastl::string& file);
+
+private:
+    void CreatePSO(IGfxPipelineState* pPSO, const eastl::vector<IGfxShader*>& shaders, bool async);
 
 private:
     Renderer* m_pRenderer;
     eastl::hash_map<GfxGraphicsPipelineDesc, eastl::unique_ptr<IGfxPipelineState>> m_cachedGraphicsPSO;
     eastl::hash_map<GfxMeshShadingPipelineDesc, eastl::unique_ptr<IGfxPipelineState>> m_cachedMeshShadingPSO;
     eastl::hash_map<GfxComputePipelineDesc, eastl::unique_ptr<IGfxPipelineState>> m_cachedComputePSO;
+
+    eastl::vector<eastl::unique_ptr<enki::TaskSet>> m_createTasks;
+    eastl::hash_map<IGfxPipelineState*, eastl::unique_ptr<enki::TaskSet>> m_asyncCreateTasks;
+    bool m_bAsyncCreation = false;
+    bool m_bDeferCreation = false; //set while loading the manifest, nothing is bound before BeginFrame waits for the tasks
 };
\ No newline at end of file
@@ -57,6 +57,8 @@ RGHandle AutomaticExposure::Render(RenderGraph* pRenderGraph, RGHandle sceneColo
         auto init_luminance_pass = pRenderGraph->AddPass<InitLuminanceData>("Init Luminance", RenderPassType::Compute,
             [&](InitLuminanceData& data, RGBuilder& builder)
             {
+                builder.AllowAsyncCompute();
+
                 data.input = builder.Read(sceneColorRT);
 
                 RGTexture::Desc desc;
@@ -83,6 +85,7 @@ RGHandle AutomaticExposure::Render(RenderGraph* pRenderGraph, RGHandle sceneColo
         auto luminance_reduction_pass = pRenderGraph->AddPass<LuminanceReductionData>("Luminance Reduction", RenderPassType::Compute,
             [&](LuminanceReductionData& data, RGBuilder& builder)
             {
+                //not async compute, the SPD counter buffer is shared with other passes outside of the graph
                 data.luminanceRT = builder.Read(init_luminance_pass->output);
 
                 for (uint32_t i = 1; i < m_luminanceMips; ++i)
@@ -108,6 +111,8 @@ RGHandle AutomaticExposure::Render(RenderGraph* pRenderGraph, RGHandle sceneColo
         auto build_histogram_pass = pRenderGraph->AddPass<BuildHistogramData>("Build Histogram", RenderPassType::Compute,
             [&](BuildHistogramData& data, RGBuilder& builder)
             {
+                builder.AllowAsyncCompute();
+
                 data.inputTexture = builder.Read(sceneColorRT);
 
                 RGBuffer::Desc desc;
@@ -135,6 +140,8 @@ RGHandle AutomaticExposure::Render(RenderGraph* pRenderGraph, RGHandle sceneColo
         auto histogram_reduction_pass = pRenderGraph->AddPass<HistogramReductionData>("Histogram Reduction", RenderPassType::Compute,
             [&](HistogramReductionData& data, RGBuilder& builder)
             {
+                builder.AllowAsyncCompute();
+
                 data.histogramBuffer = builder.Read(build_histogram_pass->histogramBuffer);
 
                 RGTexture::Desc desc;
@@ -162,6 +169,7 @@ RGHandle AutomaticExposure::Render(RenderGraph* pRenderGraph, RGHandle sceneColo
     auto exposure_pass = pRenderGraph->AddPass<ExposureData>("Exposure", RenderPassType::Compute,
         [&](ExposureData& data, RGBuilder& builder)
         {
+            //not async compute, m_pPreviousEV100 is outside of the graph
             if (avgLuminanceRT.IsValid())
             {
                 uint32_t mip = m_exposuremode == ExposureMode::Automatic ? m_luminanceMips - 1 : 0;
@@ -198,18 +206,18 @@ void AutomaticExposure::ComputeLuminanceSize(uint32_t width, uint32_t height)
 
 void AutomaticExposure::InitLuminance(IGfxCommandList* pCommandList, RGTexture* input, RGTexture* output)
 {
-    eastl::vector<eastl::string> defines;
+    ShaderPermutation permutation("automatic_exposure.hlsl", "init_luminance", "cs_6_6");
 
     switch (m_meteringMode)
     {
     case MeteringMode::Average:
-        defines.push_back("METERING_MODE_AVERAGE=1");
+        permutation.AddDefine("METERING_MODE_AVERAGE=1");
         break;
     case MeteringMode::Spot:
-        defines.push_back("METERING_MODE_SPOT=1");
+        permutation.AddDefine("METERING_MODE_SPOT=1");
         break;
     case MeteringMode::CenterWeighted:
-        defines.push_back("METERING_MODE_CENTER_WEIGHTED=1");
+        permutation.AddDefine("METERING_MODE_CENTER_WEIGHTED=1");
         break;
     default:
         RE_ASSERT(false);
@@ -217,7 +225,7 @@ void AutomaticExposure::InitLuminance(IGfxCommandList* pCommandList, RGTexture*
     }
 
     GfxComputePipelineDesc desc;
-    desc.cs = m_pRenderer->GetShader("automatic_exposure.hlsl", "init_luminance", "cs_6_6", defines);
+    desc.cs = m_pRenderer->GetShader(permutation);
     IGfxPipelineState* pso = m_pRenderer->GetPipelineState(desc, "Init Luminance PSO");
 
     pCommandList->SetPipelineState(pso);
@@ -304,18 +312,18 @@ void AutomaticExposure::BuildHistogram(IGfxCommandList* pCommandList, RGTexture*
     pCommandList->ClearUAV(histogramBuffer->GetBuffer(), histogramBuffer->GetUAV(), clear_value);
     pCommandList->UavBarrier(histogramBuffer->GetBuffer());
 
-    eastl::vector<eastl::string> defines;
+    ShaderPermutation permutation("automatic_exposure_histogram.hlsl", "build_histogram", "cs_6_6");
 
     switch (m_meteringMode)
     {
     case MeteringMode::Average:
-        defines.push_back("METERING_MODE_AVERAGE=1");
+        permutation.AddDefine("METERING_MODE_AVERAGE=1");
         break;
     case MeteringMode::Spot:
-        defines.push_back("METERING_MODE_SPOT=1");
+        permutation.AddDefine("METERING_MODE_SPOT=1");
         break;
     case MeteringMode::CenterWeighted:
-        defines.push_back("METERING_MODE_CENTER_WEIGHTED=1");
+        permutation.AddDefine("METERING_MODE_CENTER_WEIGHTED=1");
         break;
     default:
         RE_ASSERT(false);
@@ -323,7 +331,7 @@ void AutomaticExposure::BuildHistogram(IGfxCommandList* pCommandList, RGTexture*
     }
 
     GfxComputePipelineDesc desc;
-    desc.cs = m_pRenderer->GetShader("automatic_exposure_histogram.hlsl", "build_histogram", "cs_6_6", defines);
+    desc.cs = m_pRenderer->GetShader(permutation);
     IGfxPipelineState* pso = m_pRenderer->GetPipelineState(desc, "Build Histogram PSO");
 
     pCommandList->SetPipelineState(pso);
@@ -387,18 +395,18 @@ void AutomaticExposure::Exposure(IGfxCommandList* pCommandList, RGTexture* avgLu
         pCommandList->UavBarrier(m_pPreviousEV100->GetTexture());
     }
 
-    eastl::vector<eastl::string> defines;
+    ShaderPermutation permutation("automatic_exposure.hlsl", "exposure", "cs_6_6");
 
     switch (m_exposuremode)
     {
     case ExposureMode::Automatic:
-        defines.push_back("EXPOSURE_MODE_AUTO=1");
+        permutation.AddDefine("EXPOSURE_MODE_AUTO=1");
         break;
     case ExposureMode::AutomaticHistogram:
-        defines.push_back("EXPOSURE_MODE_AUTO_HISTOGRAM=1");
+        permutation.AddDefine("EXPOSURE_MODE_AUTO_HISTOGRAM=1");
         break;
     case ExposureMode::Manual:
-        defines.push_back("EXPOSURE_MODE_MANUAL=1");
+        permutation.AddDefine("EXPOSURE_MODE_MANUAL=1");
         break;
     default:
         RE_ASSERT(false);
@@ -407,11 +415,11 @@ void AutomaticExposure::Exposure(IGfxCommandList* pCommandList, RGTexture* avgLu
 
     if (m_bDebugEV100)
     {
-        defines.push_back("DEBUG_SHOW_EV100=1");
+        permutation.AddDefine("DEBUG_SHOW_EV100=1");
     }
 
     GfxComputePipelineDesc desc;
-    desc.cs = m_pRenderer->GetShader("automatic_exposure.hlsl", "exposure", "cs_6_6", defines);
+    desc.cs = m_pRenderer->GetShader(permutation);
     IGfxPipelineState* pso = m_pRenderer->GetPipelineState(desc, "Exposure PSO");
 
     pCommandList->SetPipelineState(pso);
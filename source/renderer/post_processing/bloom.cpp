@@ -39,28 +39,23 @@ RGHandle Bloom::Render(RenderGraph* pRenderGraph, RGHandle sceneColorRT, uint32_
     {
         m_mipSize[i] = uint2(width, height);
 
-        width = eastl::max(1u, (width + 1) >> 1);
-        height = eastl::max(1u, (height + 1) >> 1);
+        //the mips after the first one are in one texture, so they follow its mip sizes
+        width = eastl::max(1u, i == 0 ? (width + 1) >> 1 : width >> 1);
+        height = eastl::max(1u, i == 0 ? (height + 1) >> 1 : height >> 1);
     }
 
-    RGHandle downsampleMip1 = DownsamplePass(pRenderGraph, sceneColorRT, 1);
-    RGHandle downsampleMip2 = DownsamplePass(pRenderGraph, downsampleMip1, 2);
-    RGHandle downsampleMip3 = DownsamplePass(pRenderGraph, downsampleMip2, 3);
-    RGHandle downsampleMip4 = DownsamplePass(pRenderGraph, downsampleMip3, 4);
-    RGHandle downsampleMip5 = DownsamplePass(pRenderGraph, downsampleMip4, 5);
-    RGHandle downsampleMip6 = DownsamplePass(pRenderGraph, downsampleMip5, 6);
+    RGHandle downsampleMips = DownsamplePass(pRenderGraph, sceneColorRT);
 
-    RGHandle upsampleMip6 = downsampleMip6;
-    RGHandle upsampleMip5 = UpsamplePass(pRenderGraph, downsampleMip5, upsampleMip6, 5);
-    RGHandle upsampleMip4 = UpsamplePass(pRenderGraph, downsampleMip4, upsampleMip5, 4);
-    RGHandle upsampleMip3 = UpsamplePass(pRenderGraph, downsampleMip3, upsampleMip4, 3);
-    RGHandle upsampleMip2 = UpsamplePass(pRenderGraph, downsampleMip2, upsampleMip3, 2);
-    RGHandle upsampleMip1 = UpsamplePass(pRenderGraph, downsampleMip1, upsampleMip2, 1);
+    RGHandle upsampleMip5 = UpsamplePass(pRenderGraph, downsampleMips, downsampleMips, 5);
+    RGHandle upsampleMip4 = UpsamplePass(pRenderGraph, downsampleMips, upsampleMip5, 4);
+    RGHandle upsampleMip3 = UpsamplePass(pRenderGraph, downsampleMips, upsampleMip4, 3);
+    RGHandle upsampleMip2 = UpsamplePass(pRenderGraph, downsampleMips, upsampleMip3, 2);
+    RGHandle upsampleMip1 = UpsamplePass(pRenderGraph, downsampleMips, upsampleMip2, 1);
 
     return upsampleMip1;
 }
 
-RGHandle Bloom::DownsamplePass(RenderGraph* pRenderGraph, RGHandle input, uint32_t mip)
+RGHandle Bloom::DownsamplePass(RenderGraph* pRenderGraph, RGHandle input)
 {
     struct DownsamplePassData
     {
@@ -68,32 +63,34 @@ RGHandle Bloom::DownsamplePass(RenderGraph* pRenderGraph, RGHandle input, uint32
         RGHandle output;
     };
 
-    eastl::string name = fmt::format("Bloom DownsampleMip{}({}x{})", mip, m_mipSize[mip].x, m_mipSize[mip].y).c_str();
-
-    auto downsample_pass = pRenderGraph->AddPass<DownsamplePassData>(name, RenderPassType::Compute,
+    //one view for each mip, the view i writes the mip i and reads the mip (i - 1) written by the previous view
+    auto downsample_pass = pRenderGraph->AddMultiViewPass<DownsamplePassData>("Bloom Downsample", RenderPassType::Compute, 6,
         [&](DownsamplePassData& data, RGBuilder& builder)
         {
             data.input = builder.Read(input);
 
             RGTexture::Desc desc;
-            desc.width = m_mipSize[mip].x;
-            desc.height = m_mipSize[mip].y;
+            desc.width = m_mipSize[1].x;
+            desc.height = m_mipSize[1].y;
+            desc.mip_levels = 6;
             desc.format = GfxFormat::R11G11B10F;
-            data.output = builder.Create<RGTexture>(desc, name);
-            data.output = builder.Write(data.output);
+            RGHandle output = builder.Create<RGTexture>(desc, "Bloom Downsample");
+
+            builder.ReadViews(output, 0, 5, 1);
+            data.output = builder.WriteViews(output, 0, 6);
         },
-        [=](const DownsamplePassData& data, IGfxCommandList* pCommandList)
+        [=](const DownsamplePassData& data, uint32_t view, IGfxCommandList* pCommandList)
         {
-            Downsample(pCommandList, 
-                pRenderGraph->GetTexture(data.input), 
-                pRenderGraph->GetTexture(data.output), 
-                mip);
+            RGTexture* output = pRenderGraph->GetTexture(data.output);
+            IGfxDescriptor* input = view == 0 ? pRenderGraph->GetTexture(data.input)->GetSRV() : output->GetSRV(view - 1, 0);
+
+            Downsample(pCommandList, input, output, view + 1);
         });
 
     return downsample_pass->output;
 }
 
-RGHandle Bloom::UpsamplePass(RenderGraph* pRenderGraph, RGHandle highInput, RGHandle lowInput, uint32_t mip)
+RGHandle Bloom::UpsamplePass(RenderGraph* pRenderGraph, RGHandle downsampleMips, RGHandle lowInput, uint32_t mip)
 {
     struct UpsamplePassData
     {
@@ -102,13 +99,17 @@ RGHandle Bloom::UpsamplePass(RenderGraph* pRenderGraph, RGHandle highInput, RGHa
         RGHandle output;
     };
 
-    eastl::string name = fmt::format("Bloom UpsampleMip{}({}x{})", mip, m_mipSize[mip].x, m_mipSize[mip].y).c_str();
+    //the name doesn't have the mip size, the interned names are never released and the size changes with the resolution
+    RGName name = RGName::Format("Bloom UpsampleMip{}", mip);
+
+    //the first upsampling pass reads the last mip of the downsampling texture
+    bool first_pass = mip == 5;
 
     auto upsample_pass = pRenderGraph->AddPass<UpsamplePassData>(name, RenderPassType::Compute,
         [&](UpsamplePassData& data, RGBuilder& builder)
         {
-            data.lowInput = builder.Read(lowInput);
-            data.highInput = builder.Read(highInput);
+            data.lowInput = first_pass ? builder.Read(lowInput, mip) : builder.Read(lowInput);
+            data.highInput = builder.Read(downsampleMips, mip - 1);
 
             RGTexture::Desc desc;
             desc.width = m_mipSize[mip].x;
@@ -119,9 +120,11 @@ RGHandle Bloom::UpsamplePass(RenderGraph* pRenderGraph, RGHandle highInput, RGHa
         },
         [=](const UpsamplePassData& data, IGfxCommandList* pCommandList)
         {
+            RGTexture* lowInput = pRenderGraph->GetTexture(data.lowInput);
+
             Upsample(pCommandList, 
-                pRenderGraph->GetTexture(data.highInput), 
-                pRenderGraph->GetTexture(data.lowInput), 
+                pRenderGraph->GetTexture(data.highInput)->GetSRV(mip - 1, 0), 
+                first_pass ? lowInput->GetSRV(mip, 0) : lowInput->GetSRV(),
                 pRenderGraph->GetTexture(data.output), 
                 mip);
         });
@@ -129,7 +132,7 @@ RGHandle Bloom::UpsamplePass(RenderGraph* pRenderGraph, RGHandle highInput, RGHa
     return upsample_pass->output;
 }
 
-void Bloom::Downsample(IGfxCommandList* pCommandList, RGTexture* input, RGTexture* output, uint32_t mip)
+void Bloom::Downsample(IGfxCommandList* pCommandList, IGfxDescriptor* input, RGTexture* output, uint32_t mip)
 {
     pCommandList->SetPipelineState(mip == 1 ? m_pFirstDownsamplePSO : m_pDownsamplePSO);
 
@@ -148,8 +151,8 @@ void Bloom::Downsample(IGfxCommandList* pCommandList, RGTexture* input, RGTextur
     uint32_t output_height = m_mipSize[mip].y;
 
     DownsampleConstants constants;
-    constants.inputTexture = input->GetSRV()->GetHeapIndex();
-    constants.outputTexture = output->GetUAV()->GetHeapIndex();
+    constants.inputTexture = input->GetHeapIndex();
+    constants.outputTexture = output->GetUAV(mip - 1, 0)->GetHeapIndex();
     constants.inputPixelSize = float2(1.0f / input_width, 1.0f / input_height);
     constants.outputPixelSize = float2(1.0f / output_width, 1.0f / output_height);
     constants.threshold = m_threshold;
@@ -158,7 +161,7 @@ void Bloom::Downsample(IGfxCommandList* pCommandList, RGTexture* input, RGTextur
     pCommandList->Dispatch((output_width + 7) / 8, (output_height + 7) / 8, 1);
 }
 
-void Bloom::Upsample(IGfxCommandList* pCommandList, RGTexture* highInput, RGTexture* lowInput, RGTexture* output, uint32_t mip)
+void Bloom::Upsample(IGfxCommandList* pCommandList, IGfxDescriptor* highInput, IGfxDescriptor* lowInput, RGTexture* output, uint32_t mip)
 {
     pCommandList->SetPipelineState(m_pUpsamplePSO);
 
@@ -177,8 +180,8 @@ void Bloom::Upsample(IGfxCommandList* pCommandList, RGTexture* highInput, RGText
     uint32_t output_height = m_mipSize[mip].y;
 
     UpsampleConstants constants;
-    constants.inputLowTexture = lowInput->GetSRV()->GetHeapIndex();
-    constants.inputHighTexture = highInput->GetSRV()->GetHeapIndex();
+    constants.inputLowTexture = lowInput->GetHeapIndex();
+    constants.inputHighTexture = highInput->GetHeapIndex();
     constants.outputTexture = output->GetUAV()->GetHeapIndex();
     constants.inputPixelSize = float2(1.0f / input_width, 1.0f / input_height);
     constants.outputPixelSize = float2(1.0f / output_width, 1.0f / output_height);
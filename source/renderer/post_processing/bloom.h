@@ -12,11 +12,12 @@ public:
     float GetIntensity() const { return m_intensity; }
 
 private:
-    RGHandle DownsamplePass(RenderGraph* pRenderGraph, RGHandle input, uint32_t mip);
-    RGHandle UpsamplePass(RenderGraph* pRenderGraph, RGHandle highInput, RGHandle lowInput, uint32_t mip);
+    RGHandle DownsamplePass(RenderGraph* pRenderGraph, RGHandle input);
+    RGHandle UpsamplePass(RenderGraph* pRenderGraph, RGHandle downsampleMips, RGHandle lowInput, uint32_t mip);
 
-    void Downsample(IGfxCommandList* pCommandList, RGTexture* input, RGTexture* output, uint32_t mip);
-    void Upsample(IGfxCommandList* pCommandList, RGTexture* highInput, RGTexture* lowInput, RGTexture* output, uint32_t mip);
+    //the mips 1~6 are in the mip 0~5 of the downsampling texture
+    void Downsample(IGfxCommandList* pCommandList, IGfxDescriptor* input, RGTexture* output, uint32_t mip);
+    void Upsample(IGfxCommandList* pCommandList, IGfxDescriptor* highInput, IGfxDescriptor* lowInput, RGTexture* output, uint32_t mip);
 
 private:
     Renderer* m_pRenderer;
@@ -58,15 +58,15 @@ RGHandle Tonemapper::Render(RenderGraph* pRenderGraph, RGHandle inputHandle, RGH
 
 void Tonemapper::Draw(IGfxCommandList* pCommandList, RGTexture* pHdrSRV, RGTexture* exposure, RGTexture* pLdrUAV, RGTexture* bloom, float bloom_intensity, uint32_t width, uint32_t height)
 {
-    eastl::vector<eastl::string> defines;
+    ShaderPermutation permutation("tone_mapping.hlsl", "cs_main", "cs_6_6");
 
     switch (m_mode)
     {
     case Tonemapper::TonemappingMode::Neutral:
-        defines.push_back("NEUTRAL=1");
+        permutation.AddDefine("NEUTRAL=1");
         break;
     case Tonemapper::TonemappingMode::ACES:
-        defines.push_back("ACES=1");
+        permutation.AddDefine("ACES=1");
         break;
     default:
         break;
@@ -74,16 +74,16 @@ void Tonemapper::Draw(IGfxCommandList* pCommandList, RGTexture* pHdrSRV, RGTextu
 
     if (bloom)
     {
-        defines.push_back("BLOOM=1");
+        permutation.AddDefine("BLOOM=1");
     }
 
     if (m_bEnableDither)
     {
-        defines.push_back("DITHER=1");
+        permutation.AddDefine("DITHER=1");
     }
 
     GfxComputePipelineDesc psoDesc;
-    psoDesc.cs = m_pRenderer->GetShader("tone_mapping.hlsl", "cs_main", "cs_6_6", defines);
+    psoDesc.cs = m_pRenderer->GetShader(permutation);
     IGfxPipelineState* pso = m_pRenderer->GetPipelineState(psoDesc, "ToneMapping PSO");
 
     pCommandList->SetPipelineState(pso);
@@ -1,22 +1,37 @@
 #include "render_graph.h"
-#include "core/engine.h"
 #include "utils/profiler.h"
+#include "EASTL/hash_map.h"
+#include "enkiTS/TaskScheduler.h"
+#include <fstream>
 
-RenderGraph::RenderGraph(Renderer* pRenderer) :
-    m_resourceAllocator(pRenderer->GetDevice())
+RenderGraph::RenderGraph(IGfxDevice* pDevice) :
+    m_resourceAllocator(pDevice)
 {
-    IGfxDevice* device = pRenderer->GetDevice();
-    m_pComputeQueueFence.reset(device->CreateFence("RenderGraph::m_pComputeQueueFence"));
-    m_pGraphicsQueueFence.reset(device->CreateFence("RenderGraph::m_pGraphicsQueueFence"));
+    m_pComputeQueueFence.reset(pDevice->CreateFence("RenderGraph::m_pComputeQueueFence"));
+    m_pGraphicsQueueFence.reset(pDevice->CreateFence("RenderGraph::m_pGraphicsQueueFence"));
 }
 
-void RenderGraph::BeginEvent(const eastl::string& name)
+void RenderGraph::BeginEvent(const RGName& name)
 {
+    RGSetupRecorder* recorder = RGSetupRecorder::GetCurrent(this);
+    if (recorder)
+    {
+        recorder->BeginEvent(name);
+        return;
+    }
+
     m_eventNames.push_back(name);
 }
 
 void RenderGraph::EndEvent()
 {
+    RGSetupRecorder* recorder = RGSetupRecorder::GetCurrent(this);
+    if (recorder)
+    {
+        recorder->EndEvent();
+        return;
+    }
+
     if (!m_eventNames.empty())
     {
         m_eventNames.pop_back();
@@ -27,6 +42,91 @@ void RenderGraph::EndEvent()
     }
 }
 
+void RenderGraph::RunSetupTasks(std::initializer_list<eastl::function<void()>> tasks)
+{
+    //tasks of a recorder are recorded serially into it
+    if (m_pTaskScheduler == nullptr || tasks.size() <= 1 || RGSetupRecorder::GetCurrent(this) != nullptr)
+    {
+        for (const eastl::function<void()>& task : tasks)
+        {
+            task();
+        }
+        return;
+    }
+
+    CPU_EVENT("Render", "RenderGraph::RunSetupTasks");
+
+    uint32_t first_recorder = m_nSetupRecorderCount;
+    uint32_t task_count = (uint32_t)tasks.size();
+
+    for (uint32_t i = 0; i < task_count; ++i)
+    {
+        uint32_t recorder = first_recorder + i;
+        if (recorder == m_setupRecorders.size())
+        {
+            m_setupRecorders.emplace_back(eastl::make_unique<RGSetupRecorder>(this, (uint16_t)(recorder + 1)));
+        }
+    }
+    m_nSetupRecorderCount += task_count;
+
+    const eastl::function<void()>* task_list = tasks.begin();
+
+    enki::TaskSet task_set(task_count, [&](enki::TaskSetPartition range, uint32_t threadnum)
+        {
+            for (uint32_t i = range.start; i < range.end; ++i)
+            {
+                m_setupRecorders[first_recorder + i]->Record(task_list[i]);
+            }
+        });
+
+    m_pTaskScheduler->AddTaskSetToPipe(&task_set);
+    m_pTaskScheduler->WaitforTask(&task_set);
+
+    for (uint32_t i = 0; i < task_count; ++i)
+    {
+        m_setupRecorders[first_recorder + i]->Merge();
+    }
+}
+
+RGHandle RenderGraph::Resolve(const RGHandle& handle) const
+{
+    if (handle.recorder == 0)
+    {
+        return handle;
+    }
+
+    RE_ASSERT(handle.recorder <= m_nSetupRecorderCount);
+    return m_setupRecorders[handle.recorder - 1]->Resolve(handle);
+}
+
+void RenderGraph::BeginPass(RenderGraphPassBase* pass)
+{
+    RGSetupRecorder* recorder = RGSetupRecorder::GetCurrent(this);
+    if (recorder)
+    {
+        recorder->BeginPass(pass);
+        return;
+    }
+
+    for (size_t i = 0; i < m_eventNames.size(); ++i)
+    {
+        pass->BeginEvent(m_eventNames[i]);
+    }
+    m_eventNames.clear();
+}
+
+void RenderGraph::EndPass(RenderGraphPassBase* pass)
+{
+    RGSetupRecorder* recorder = RGSetupRecorder::GetCurrent(this);
+    if (recorder)
+    {
+        recorder->EndPass(pass);
+        return;
+    }
+
+    m_passes.push_back(pass);
+}
+
 void RenderGraph::Clear()
 {
     for (size_t i = 0; i < m_objFinalizer.size(); ++i)
@@ -35,6 +135,12 @@ void RenderGraph::Clear()
     }
     m_objFinalizer.clear();
 
+    for (uint32_t i = 0; i < m_nSetupRecorderCount; ++i)
+    {
+        m_setupRecorders[i]->Clear();
+    }
+    m_nSetupRecorderCount = 0;
+
     m_graph.Clear();
 
     m_passes.clear();
@@ -51,8 +157,46 @@ void RenderGraph::Compile()
 {
     CPU_EVENT("Render", "RenderGraph::Compile");
 
+    if (!m_captureFile.empty())
+    {
+        SaveTopology(m_captureFile);
+        m_captureFile.clear();
+    }
+
     m_graph.Cull();
 
+    for (size_t i = 0; i < m_passes.size(); ++i)
+    {
+        RenderGraphPassBase* pass = m_passes[i];
+        pass->SetExecuteIndex((uint32_t)i);
+
+        //e.g. an imported resource in a pixel shader state, the compute queue can't transition it
+        if (pass->GetType() == RenderPassType::AsyncCompute && !pass->IsCulled() && !pass->IsAsyncComputeCompatible(m_graph))
+        {
+            pass->MoveToGraphicsQueue();
+        }
+    }
+
+    if (m_bPassReordering)
+    {
+        ReorderPasses();
+    }
+    else
+    {
+        m_reorderResult = RGReorderResult();
+    }
+
+    if (m_bAsyncComputeScheduling)
+    {
+        ScheduleAsyncCompute();
+    }
+    else
+    {
+        m_asyncComputeSchedule = RGAsyncComputeSchedule();
+    }
+
+    MergeReadStates();
+
     RenderGraphAsyncResolveContext context;
 
     for (size_t i = 0; i < m_passes.size(); ++i)
@@ -118,6 +262,251 @@ void RenderGraph::Compile()
             pass->ResolveBarriers(m_graph);
         }
     }
+
+    m_barrierStats = RenderGraphBarrierStats();
+
+    for (size_t i = 0; i < m_passes.size(); ++i)
+    {
+        RenderGraphPassBase* pass = m_passes[i];
+        if (!pass->IsCulled())
+        {
+            pass->ResolveSplitBarriers(m_graph, m_passes);
+        }
+    }
+
+    for (size_t i = 0; i < m_passes.size(); ++i)
+    {
+        RenderGraphPassBase* pass = m_passes[i];
+        if (!pass->IsCulled())
+        {
+            pass->GetBarrierStats(m_barrierStats);
+        }
+    }
+}
+
+void RenderGraph::ReorderPasses()
+{
+    CPU_EVENT("Render", "RenderGraph::ReorderPasses");
+
+    eastl::hash_map<const RenderGraphResource*, uint32_t> resource_indices;
+    eastl::vector<uint64_t> resource_sizes;
+
+    eastl::vector<RGReorderPass> reorder_passes(m_passes.size());
+    eastl::vector<DAGNodeID> pre_passes;
+    eastl::vector<DAGNodeID> post_passes;
+    eastl::vector<DAGEdge*> edges;
+
+    auto add_resource = [&](RGReorderPass& reorder_pass, DAGNodeID node_id)
+    {
+        const RenderGraphResource* resource = ((RenderGraphResourceNode*)m_graph.GetNode(node_id))->GetResource();
+        if (!resource->IsOverlapping())
+        {
+            return;
+        }
+
+        auto iter = resource_indices.find(resource);
+        if (iter == resource_indices.end())
+        {
+            iter = resource_indices.insert(eastl::make_pair(resource, (uint32_t)resource_sizes.size())).first;
+            resource_sizes.push_back(resource->GetSize());
+        }
+
+        if (eastl::find(reorder_pass.resources.begin(), reorder_pass.resources.end(), iter->second) == reorder_pass.resources.end())
+        {
+            reorder_pass.resources.push_back(iter->second);
+        }
+    };
+
+    for (size_t i = 0; i < m_passes.size(); ++i)
+    {
+        RenderGraphPassBase* pass = m_passes[i];
+        RGReorderPass& reorder_pass = reorder_passes[i];
+
+        //culled passes are kept for their events
+        reorder_pass.beginEvents = (uint32_t)pass->GetEventNames().size();
+        reorder_pass.endEvents = pass->GetEndEventNum();
+        reorder_pass.asyncCompute = pass->GetType() == RenderPassType::AsyncCompute;
+
+        if (pass->IsCulled())
+        {
+            continue;
+        }
+
+        //same dependencies as the async compute fences, write after read is included
+        pass->GetQueueDependencies(m_graph, pre_passes, post_passes);
+        for (size_t j = 0; j < pre_passes.size(); ++j)
+        {
+            reorder_pass.dependencies.push_back(((RenderGraphPassBase*)m_graph.GetNode(pre_passes[j]))->GetExecuteIndex());
+        }
+
+        m_graph.GetIncomingEdges(pass, edges);
+        for (size_t j = 0; j < edges.size(); ++j)
+        {
+            add_resource(reorder_pass, edges[j]->GetFromNode());
+        }
+
+        m_graph.GetOutgoingEdges(pass, edges);
+        for (size_t j = 0; j < edges.size(); ++j)
+        {
+            add_resource(reorder_pass, edges[j]->GetToNode());
+        }
+    }
+
+    m_passReorderer.Reorder(reorder_passes, resource_sizes, m_reorderResult);
+
+    //the declaration order is kept if it is not improved
+    if (m_reorderResult.peakBytesAfter == m_reorderResult.peakBytesBefore)
+    {
+        return;
+    }
+
+    eastl::vector<RGName> event_names;
+    for (size_t i = 0; i < m_reorderResult.events.size(); ++i)
+    {
+        const RGReorderEvent& event = m_reorderResult.events[i];
+        event_names.push_back(m_passes[event.pass]->GetEventNames()[event.index]);
+    }
+
+    for (size_t i = 0; i < m_passes.size(); ++i)
+    {
+        m_passes[i]->ClearEvents();
+    }
+
+    for (size_t i = 0; i < m_reorderResult.events.size(); ++i)
+    {
+        const RGReorderEvent& event = m_reorderResult.events[i];
+        m_passes[event.firstPass]->BeginEvent(event_names[i]);
+        m_passes[event.lastPass]->EndEvent();
+    }
+
+    eastl::vector<RenderGraphPassBase*> passes(m_passes.size());
+    for (size_t i = 0; i < m_passes.size(); ++i)
+    {
+        passes[i] = m_passes[m_reorderResult.order[i]];
+        passes[i]->SetExecuteIndex((uint32_t)i);
+    }
+    m_passes.swap(passes);
+}
+
+void RenderGraph::ScheduleAsyncCompute()
+{
+    CPU_EVENT("Render", "RenderGraph::ScheduleAsyncCompute");
+
+    eastl::vector<RenderGraphPassBase*> passes;
+    for (size_t i = 0; i < m_passes.size(); ++i)
+    {
+        if (!m_passes[i]->IsCulled())
+        {
+            passes.push_back(m_passes[i]);
+        }
+    }
+
+    //passes are sorted by the execute index
+    auto pass_index = [&](DAGNodeID id)
+    {
+        uint32_t index = ((RenderGraphPassBase*)m_graph.GetNode(id))->GetExecuteIndex();
+        auto iter = eastl::lower_bound(passes.begin(), passes.end(), index, [](const RenderGraphPassBase* pass, uint32_t index) { return pass->GetExecuteIndex() < index; });
+        RE_ASSERT(iter != passes.end() && (*iter)->GetExecuteIndex() == index);
+        return (uint32_t)(iter - passes.begin());
+    };
+
+    eastl::vector<RGAsyncComputePass> schedule_passes(passes.size());
+    eastl::vector<DAGNodeID> pre_passes;
+    eastl::vector<DAGNodeID> post_passes;
+
+    for (size_t i = 0; i < passes.size(); ++i)
+    {
+        RenderGraphPassBase* pass = passes[i];
+        RGAsyncComputePass& schedule_pass = schedule_passes[i];
+
+        schedule_pass.asyncCompute = pass->GetType() == RenderPassType::AsyncCompute;
+        schedule_pass.candidate = pass->GetType() == RenderPassType::Compute && pass->IsAsyncComputeAllowed() && pass->IsAsyncComputeCompatible(m_graph);
+        schedule_pass.cost = pass->EstimateCost(m_graph);
+
+        pass->GetQueueDependencies(m_graph, pre_passes, post_passes);
+
+        for (size_t j = 0; j < pre_passes.size(); ++j)
+        {
+            schedule_pass.dependencies.push_back(pass_index(pre_passes[j]));
+        }
+
+        for (size_t j = 0; j < post_passes.size(); ++j)
+        {
+            schedule_pass.dependents.push_back(pass_index(post_passes[j]));
+        }
+    }
+
+    m_asyncComputeScheduler.Schedule(schedule_passes, m_asyncComputeSchedule);
+
+    for (size_t i = 0; i < m_asyncComputeSchedule.movedPasses.size(); ++i)
+    {
+        passes[m_asyncComputeSchedule.movedPasses[i]]->MoveToAsyncCompute();
+    }
+}
+
+void RenderGraph::MergeReadStates()
+{
+    //if a version of a resource is read as both ps and non-ps shader resource, transition it once to shader resource all,
+    //instead of ping-ponging between the two states
+    eastl::vector<DAGEdge*> edges;
+
+    for (size_t i = 0; i < m_resourceNodes.size(); ++i)
+    {
+        RenderGraphResourceNode* node = m_resourceNodes[i];
+        if (node->IsCulled())
+        {
+            continue;
+        }
+
+        m_graph.GetOutgoingEdges(node, edges);
+
+        for (size_t j = 0; j < edges.size(); ++j)
+        {
+            RenderGraphEdge* edge = (RenderGraphEdge*)edges[j];
+
+            bool ps = false;
+            bool non_ps = false;
+            bool async_compute = false;
+
+            for (size_t k = 0; k < edges.size(); ++k)
+            {
+                RenderGraphEdge* other = (RenderGraphEdge*)edges[k];
+                RenderGraphPassBase* pass = (RenderGraphPassBase*)m_graph.GetNode(other->GetToNode());
+                if (!other->Overlaps(edge) || pass->IsCulled())
+                {
+                    continue;
+                }
+
+                switch (other->GetUsage())
+                {
+                case GfxResourceState::ShaderResourcePS:
+                    ps = true;
+                    break;
+                case GfxResourceState::ShaderResourceNonPS:
+                    non_ps = true;
+                    break;
+                case GfxResourceState::ShaderResourceAll:
+                    ps = non_ps = true;
+                    break;
+                default:
+                    break;
+                }
+
+                //compute queue can't use pixel shader resource state
+                if (pass->GetType() == RenderPassType::AsyncCompute)
+                {
+                    async_compute = true;
+                }
+            }
+
+            GfxResourceState usage = edge->GetUsage();
+            if (ps && non_ps && !async_compute &&
+                (usage == GfxResourceState::ShaderResourcePS || usage == GfxResourceState::ShaderResourceNonPS))
+            {
+                edge->SetUsage(GfxResourceState::ShaderResourceAll);
+            }
+        }
+    }
 }
 
 void RenderGraph::Execute(Renderer* pRenderer, IGfxCommandList* pCommandList, IGfxCommandList* pComputeCommandList)
@@ -160,10 +549,19 @@ void RenderGraph::Present(const RGHandle& handle, GfxResourceState filnal_state)
 {
     RE_ASSERT(handle.IsValid());
 
-    RenderGraphResource* resource = GetTexture(handle);
+    RGSetupRecorder* recorder = RGSetupRecorder::GetCurrent(this);
+    if (recorder)
+    {
+        recorder->Present(handle, filnal_state);
+        return;
+    }
+
+    RGHandle output = Resolve(handle);
+
+    RenderGraphResource* resource = GetTexture(output);
     resource->SetOutput(true);
 
-    RenderGraphResourceNode* node = m_resourceNodes[handle.node];
+    RenderGraphResourceNode* node = m_resourceNodes[output.node];
     node->MakeTarget();
 
     PresentTarget target;
@@ -179,7 +577,7 @@ RGTexture* RenderGraph::GetTexture(const RGHandle& handle)
         return nullptr;
     }
 
-    RenderGraphResource* resource = m_resources[handle.index];
+    RenderGraphResource* resource = m_resources[Resolve(handle).index];
     RE_ASSERT(dynamic_cast<RGTexture*>(resource) != nullptr);
     return (RGTexture*)resource;
 }
@@ -191,7 +589,7 @@ RGBuffer* RenderGraph::GetBuffer(const RGHandle& handle)
         return nullptr;
     }
 
-    RenderGraphResource* resource = m_resources[handle.index];
+    RenderGraphResource* resource = m_resources[Resolve(handle).index];
     RE_ASSERT(dynamic_cast<RGBuffer*>(resource) != nullptr);
     return (RGBuffer*)resource;
 }
@@ -201,8 +599,219 @@ bool RenderGraph::Export(const eastl::string& file)
     return m_graph.ExportGraphviz(file.c_str());
 }
 
+static eastl::string JsonString(const char* s)
+{
+    eastl::string json = "\"";
+    for (; *s != 0; ++s)
+    {
+        if (*s == '"' || *s == '\\')
+        {
+            json += '\\';
+            json += *s;
+        }
+        else if ((unsigned char)*s < 0x20)
+        {
+            //control characters are not allowed in json strings
+            json.append_sprintf("\\u%04x", (unsigned char)*s);
+        }
+        else
+        {
+            json += *s;
+        }
+    }
+    json += "\"";
+    return json;
+}
+
+bool RenderGraph::ExportMemoryTimeline(const eastl::string& file)
+{
+    std::ofstream out;
+    out.open(file.c_str());
+    if (out.fail())
+    {
+        return false;
+    }
+
+    struct ResourceAllocation
+    {
+        RenderGraphResource* resource;
+        uint32_t firstPass;
+        uint32_t lastPass;
+        RenderGraphHeapAllocation allocation;
+    };
+    eastl::vector<ResourceAllocation> allocations;
+
+    eastl::vector<uint64_t> live_bytes(m_passes.size(), 0);
+    eastl::vector<uint32_t> heaps;
+    uint64_t total_bytes = 0;
+    uint64_t heap_bytes = 0;
+
+    for (size_t i = 0; i < m_resources.size(); ++i)
+    {
+        RenderGraphResource* resource = m_resources[i];
+        if (!resource->IsOverlapping() || !resource->IsUsed())
+        {
+            continue;
+        }
+
+        ResourceAllocation resource_allocation = { resource, resource->GetFirstPassIndex(), resource->GetLastPassIndex() };
+        if (!m_resourceAllocator.GetHeapAllocation(resource->GetResource(), resource_allocation.allocation))
+        {
+            continue;
+        }
+
+        const RenderGraphHeapAllocation& allocation = resource_allocation.allocation;
+
+        for (uint32_t pass = resource_allocation.firstPass; pass <= resource_allocation.lastPass && pass < (uint32_t)live_bytes.size(); ++pass)
+        {
+            live_bytes[pass] += allocation.size;
+        }
+
+        total_bytes += allocation.size;
+
+        if (eastl::find(heaps.begin(), heaps.end(), allocation.heap) == heaps.end())
+        {
+            heaps.push_back(allocation.heap);
+            heap_bytes += allocation.heapSize;
+        }
+
+        allocations.push_back(resource_allocation);
+    }
+
+    out << "{\n";
+    out << "  \"resources\": [";
+
+    for (size_t i = 0; i < allocations.size(); ++i)
+    {
+        const ResourceAllocation& resource_allocation = allocations[i];
+        const RenderGraphHeapAllocation& allocation = resource_allocation.allocation;
+
+        //the offsets are always 0, so the resources of a heap share its memory. it is aliased if another one uses it in a disjoint pass range
+        bool aliased = false;
+        for (size_t j = 0; j < allocations.size(); ++j)
+        {
+            if (j != i && allocations[j].allocation.heap == allocation.heap &&
+                (allocations[j].lastPass < resource_allocation.firstPass || allocations[j].firstPass > resource_allocation.lastPass))
+            {
+                aliased = true;
+                break;
+            }
+        }
+
+        RenderGraphResource* resource = resource_allocation.resource;
+        uint32_t first_pass = resource_allocation.firstPass;
+        uint32_t last_pass = resource_allocation.lastPass;
+
+        out << (i == 0 ? "\n" : ",\n");
+        out << "    { \"name\": " << JsonString(resource->GetName()).c_str()
+            << ", \"type\": \"" << (dynamic_cast<RGTexture*>(resource) != nullptr ? "texture" : "buffer") << "\""
+            << ", \"firstPass\": " << first_pass
+            << ", \"firstPassName\": " << JsonString(m_passes[first_pass]->GetName()).c_str()
+            << ", \"lastPass\": " << last_pass
+            << ", \"lastPassName\": " << JsonString(m_passes[last_pass]->GetName()).c_str()
+            << ", \"size\": " << allocation.size
+            << ", \"heap\": " << allocation.heap
+            << ", \"heapSize\": " << allocation.heapSize
+            << ", \"offset\": " << allocation.offset
+            << ", \"aliased\": " << (aliased ? "true" : "false") << " }";
+    }
+
+    out << "\n  ],\n";
+    out << "  \"passes\": [";
+
+    uint64_t peak_bytes = 0;
+    uint32_t peak_pass = 0;
+
+    for (size_t i = 0; i < m_passes.size(); ++i)
+    {
+        RenderGraphPassBase* pass = m_passes[i];
+
+        if (live_bytes[i] > peak_bytes)
+        {
+            peak_bytes = live_bytes[i];
+            peak_pass = (uint32_t)i;
+        }
+
+        out << (i == 0 ? "\n" : ",\n");
+        out << "    { \"index\": " << i
+            << ", \"name\": " << JsonString(pass->GetName()).c_str()
+            << ", \"culled\": " << (pass->IsCulled() ? "true" : "false")
+            << ", \"liveBytes\": " << live_bytes[i] << " }";
+    }
+
+    out << "\n  ],\n";
+    out << "  \"totalBytes\": " << total_bytes << ",\n";
+    out << "  \"peakBytes\": " << peak_bytes << ",\n";
+    out << "  \"peakPass\": " << peak_pass << ",\n";
+    out << "  \"heapBytes\": " << heap_bytes << "\n";
+    out << "}\n";
+
+    out.close();
+    return true;
+}
+
+uint64_t RenderGraph::GetTopologyHash() const
+{
+    uint64_t hash = 0;
+
+    for (size_t i = 0; i < m_passes.size(); ++i)
+    {
+        const RenderGraphPassBase* pass = m_passes[i];
+
+        uint64_t pass_hash[5] = { pass->GetId(), XXH3_64bits(pass->GetName(), strlen(pass->GetName())), (uint64_t)pass->GetType(), pass->GetEndEventNum(), pass->GetViewCount() };
+        hash = XXH3_64bits_withSeed(pass_hash, sizeof(pass_hash), hash);
+
+        const eastl::fixed_vector<RGName, 4>& events = pass->GetEventNames();
+        for (size_t j = 0; j < events.size(); ++j)
+        {
+            uint64_t event_hash = events[j].GetHash();
+            hash = XXH3_64bits_withSeed(&event_hash, sizeof(event_hash), hash);
+        }
+    }
+
+    eastl::hash_map<const RenderGraphResource*, uint32_t> resource_indices;
+    for (size_t i = 0; i < m_resources.size(); ++i)
+    {
+        resource_indices[m_resources[i]] = (uint32_t)i;
+    }
+
+    eastl::vector<DAGEdge*> edges;
+    for (size_t i = 0; i < m_resourceNodes.size(); ++i)
+    {
+        const RenderGraphResourceNode* node = m_resourceNodes[i];
+
+        uint32_t node_hash[3] = { node->GetId(), resource_indices[node->GetResource()], node->GetVersion() };
+        hash = XXH3_64bits_withSeed(node_hash, sizeof(node_hash), hash);
+
+        //every edge has a resource node on one side
+        m_graph.GetIncomingEdges(node, edges);
+        for (size_t j = 0; j < edges.size(); ++j)
+        {
+            const RenderGraphEdge* edge = (const RenderGraphEdge*)edges[j];
+            uint32_t edge_hash[6] = { edge->GetFromNode(), edge->GetToNode(), (uint32_t)edge->GetUsage(), edge->GetSubresource(), edge->GetSubresourceCount(), edge->GetFirstView() };
+            hash = XXH3_64bits_withSeed(edge_hash, sizeof(edge_hash), hash);
+        }
+
+        m_graph.GetOutgoingEdges(node, edges);
+        for (size_t j = 0; j < edges.size(); ++j)
+        {
+            const RenderGraphEdge* edge = (const RenderGraphEdge*)edges[j];
+            uint32_t edge_hash[6] = { edge->GetFromNode(), edge->GetToNode(), (uint32_t)edge->GetUsage(), edge->GetSubresource(), edge->GetSubresourceCount(), edge->GetFirstView() };
+            hash = XXH3_64bits_withSeed(edge_hash, sizeof(edge_hash), hash);
+        }
+    }
+
+    return hash;
+}
+
 RGHandle RenderGraph::Import(IGfxTexture* texture, GfxResourceState state)
 {
+    RGSetupRecorder* recorder = RGSetupRecorder::GetCurrent(this);
+    if (recorder)
+    {
+        return recorder->Import(texture, state);
+    }
+
     auto resource = Allocate<RGTexture>(m_resourceAllocator, texture, state);
     auto node = AllocatePOD<RenderGraphResourceNode>(m_graph, resource, 0);
 
@@ -218,6 +827,12 @@ RGHandle RenderGraph::Import(IGfxTexture* texture, GfxResourceState state)
 
 RGHandle RenderGraph::Import(IGfxBuffer* buffer, GfxResourceState state)
 {
+    RGSetupRecorder* recorder = RGSetupRecorder::GetCurrent(this);
+    if (recorder)
+    {
+        return recorder->Import(buffer, state);
+    }
+
     auto resource = Allocate<RGBuffer>(m_resourceAllocator, buffer, state);
     auto node = AllocatePOD<RenderGraphResourceNode>(m_graph, resource, 0);
 
@@ -231,29 +846,86 @@ RGHandle RenderGraph::Import(IGfxBuffer* buffer, GfxResourceState state)
     return handle;
 }
 
-RGHandle RenderGraph::Read(RenderGraphPassBase* pass, const RGHandle& input, GfxResourceState usage, uint32_t subresource)
+RGHandle RenderGraph::ImportPrevHistory(const RGTexture::Desc& desc, const RGName& name)
+{
+    RGSetupRecorder* recorder = RGSetupRecorder::GetCurrent(this);
+    if (recorder)
+    {
+        return recorder->ImportPrevHistory(desc, name);
+    }
+
+    auto resource = Allocate<RGTexture>(m_resourceAllocator, name, desc, true);
+    auto node = AllocatePOD<RenderGraphResourceNode>(m_graph, resource, 0);
+
+    RGHandle handle;
+    handle.index = (uint16_t)m_resources.size();
+    handle.node = (uint16_t)m_resourceNodes.size();
+
+    m_resources.push_back(resource);
+    m_resourceNodes.push_back(node);
+
+    return handle;
+}
+
+RGHandle RenderGraph::CreateHistory(const RGTexture::Desc& desc, const RGName& name)
+{
+    RGSetupRecorder* recorder = RGSetupRecorder::GetCurrent(this);
+    if (recorder)
+    {
+        return recorder->CreateHistory(desc, name);
+    }
+
+    auto resource = Allocate<RGTexture>(m_resourceAllocator, name, desc, false);
+    auto node = AllocatePOD<RenderGraphResourceNode>(m_graph, resource, 0);
+
+    RGHandle handle;
+    handle.index = (uint16_t)m_resources.size();
+    handle.node = (uint16_t)m_resourceNodes.size();
+
+    m_resources.push_back(resource);
+    m_resourceNodes.push_back(node);
+
+    return handle;
+}
+
+RGHandle RenderGraph::Read(RenderGraphPassBase* pass, const RGHandle& input, GfxResourceState usage, uint32_t subresource, uint32_t subresource_count, uint32_t first_view)
 {
     RE_ASSERT(input.IsValid());
-    RenderGraphResourceNode* input_node = m_resourceNodes[input.node];
 
-    AllocatePOD<RenderGraphEdge>(m_graph, input_node, pass, usage, subresource);
+    RGSetupRecorder* recorder = RGSetupRecorder::GetCurrent(this);
+    if (recorder)
+    {
+        return recorder->Read(pass, input, usage, subresource, subresource_count, first_view);
+    }
+
+    RenderGraphResourceNode* input_node = m_resourceNodes[Resolve(input).node];
+
+    AllocatePOD<RenderGraphEdge>(m_graph, input_node, pass, usage, subresource, subresource_count, first_view);
 
     return input;
 }
 
-RGHandle RenderGraph::Write(RenderGraphPassBase* pass, const RGHandle& input, GfxResourceState usage, uint32_t subresource)
+RGHandle RenderGraph::Write(RenderGraphPassBase* pass, const RGHandle& input, GfxResourceState usage, uint32_t subresource, uint32_t subresource_count, uint32_t first_view)
 {
     RE_ASSERT(input.IsValid());
-    RenderGraphResource* resource = m_resources[input.index];
 
-    RenderGraphResourceNode* input_node = m_resourceNodes[input.node];
-    AllocatePOD<RenderGraphEdge>(m_graph, input_node, pass, usage, subresource);
+    RGSetupRecorder* recorder = RGSetupRecorder::GetCurrent(this);
+    if (recorder)
+    {
+        return recorder->Write(pass, input, usage, subresource, subresource_count, first_view);
+    }
+
+    RGHandle handle = Resolve(input);
+    RenderGraphResource* resource = m_resources[handle.index];
+
+    RenderGraphResourceNode* input_node = m_resourceNodes[handle.node];
+    AllocatePOD<RenderGraphEdge>(m_graph, input_node, pass, usage, subresource, subresource_count, first_view);
 
     RenderGraphResourceNode* output_node = AllocatePOD<RenderGraphResourceNode>(m_graph, resource, input_node->GetVersion() + 1);
-    AllocatePOD<RenderGraphEdge>(m_graph, pass, output_node, usage, subresource);
+    AllocatePOD<RenderGraphEdge>(m_graph, pass, output_node, usage, subresource, subresource_count, first_view);
 
     RGHandle output;        
-    output.index = input.index;
+    output.index = handle.index;
     output.node = (uint16_t)m_resourceNodes.size();
 
     m_resourceNodes.push_back(output_node);
@@ -264,18 +936,26 @@ RGHandle RenderGraph::Write(RenderGraphPassBase* pass, const RGHandle& input, Gf
 RGHandle RenderGraph::WriteColor(RenderGraphPassBase* pass, uint32_t color_index, const RGHandle& input, uint32_t subresource, GfxRenderPassLoadOp load_op, const float4& clear_color)
 {
     RE_ASSERT(input.IsValid());
-    RenderGraphResource* resource = m_resources[input.index];
+
+    RGSetupRecorder* recorder = RGSetupRecorder::GetCurrent(this);
+    if (recorder)
+    {
+        return recorder->WriteColor(pass, color_index, input, subresource, load_op, clear_color);
+    }
+
+    RGHandle handle = Resolve(input);
+    RenderGraphResource* resource = m_resources[handle.index];
 
     GfxResourceState usage = GfxResourceState::RenderTarget;
 
-    RenderGraphResourceNode* input_node = m_resourceNodes[input.node];
+    RenderGraphResourceNode* input_node = m_resourceNodes[handle.node];
     AllocatePOD<RenderGraphEdgeColorAttchment>(m_graph, input_node, pass, usage, subresource, color_index, load_op, clear_color);
 
     RenderGraphResourceNode* output_node = AllocatePOD<RenderGraphResourceNode>(m_graph, resource, input_node->GetVersion() + 1);
     AllocatePOD<RenderGraphEdgeColorAttchment>(m_graph, pass, output_node, usage, subresource, color_index, load_op, clear_color);
 
     RGHandle output;
-    output.index = input.index;
+    output.index = handle.index;
     output.node = (uint16_t)m_resourceNodes.size();
 
     m_resourceNodes.push_back(output_node);
@@ -286,18 +966,26 @@ RGHandle RenderGraph::WriteColor(RenderGraphPassBase* pass, uint32_t color_index
 RGHandle RenderGraph::WriteDepth(RenderGraphPassBase* pass, const RGHandle& input, uint32_t subresource, GfxRenderPassLoadOp depth_load_op, GfxRenderPassLoadOp stencil_load_op, float clear_depth, uint32_t clear_stencil)
 {
     RE_ASSERT(input.IsValid());
-    RenderGraphResource* resource = m_resources[input.index];
+
+    RGSetupRecorder* recorder = RGSetupRecorder::GetCurrent(this);
+    if (recorder)
+    {
+        return recorder->WriteDepth(pass, input, subresource, depth_load_op, stencil_load_op, clear_depth, clear_stencil);
+    }
+
+    RGHandle handle = Resolve(input);
+    RenderGraphResource* resource = m_resources[handle.index];
 
     GfxResourceState usage = GfxResourceState::DepthStencil;
 
-    RenderGraphResourceNode* input_node = m_resourceNodes[input.node];
+    RenderGraphResourceNode* input_node = m_resourceNodes[handle.node];
     AllocatePOD<RenderGraphEdgeDepthAttchment>(m_graph, input_node, pass, usage, subresource, depth_load_op, stencil_load_op, clear_depth, clear_stencil);
 
     RenderGraphResourceNode* output_node = AllocatePOD<RenderGraphResourceNode>(m_graph, resource, input_node->GetVersion() + 1);
     AllocatePOD<RenderGraphEdgeDepthAttchment>(m_graph, pass, output_node, usage, subresource, depth_load_op, stencil_load_op, clear_depth, clear_stencil);
 
     RGHandle output;
-    output.index = input.index;
+    output.index = handle.index;
     output.node = (uint16_t)m_resourceNodes.size();
 
     m_resourceNodes.push_back(output_node);
@@ -308,18 +996,26 @@ RGHandle RenderGraph::WriteDepth(RenderGraphPassBase* pass, const RGHandle& inpu
 RGHandle RenderGraph::ReadDepth(RenderGraphPassBase* pass, const RGHandle& input, uint32_t subresource)
 {
     RE_ASSERT(input.IsValid());
-    RenderGraphResource* resource = m_resources[input.index];
+
+    RGSetupRecorder* recorder = RGSetupRecorder::GetCurrent(this);
+    if (recorder)
+    {
+        return recorder->ReadDepth(pass, input, subresource);
+    }
+
+    RGHandle handle = Resolve(input);
+    RenderGraphResource* resource = m_resources[handle.index];
 
     GfxResourceState usage = GfxResourceState::DepthStencilReadOnly;
 
-    RenderGraphResourceNode* input_node = m_resourceNodes[input.node];
+    RenderGraphResourceNode* input_node = m_resourceNodes[handle.node];
     AllocatePOD<RenderGraphEdgeDepthAttchment>(m_graph, input_node, pass, usage, subresource, GfxRenderPassLoadOp::Load, GfxRenderPassLoadOp::Load, 0.0f, 0);
 
     RenderGraphResourceNode* output_node = AllocatePOD<RenderGraphResourceNode>(m_graph, resource, input_node->GetVersion() + 1);
     AllocatePOD<RenderGraphEdgeDepthAttchment>(m_graph, pass, output_node, usage, subresource, GfxRenderPassLoadOp::Load, GfxRenderPassLoadOp::Load, 0.0f, 0);
 
     RGHandle output;
-    output.index = input.index;
+    output.index = handle.index;
     output.node = (uint16_t)m_resourceNodes.size();
 
     m_resourceNodes.push_back(output_node);
@@ -4,25 +4,40 @@
 #include "render_graph_handle.h"
 #include "render_graph_resource.h"
 #include "render_graph_resource_allocator.h"
+#include "render_graph_async_compute.h"
+#include "render_graph_reorder.h"
+#include "render_graph_setup.h"
 #include "utils/linear_allocator.h"
 #include "utils/math.h"
 #include "EASTL/unique_ptr.h"
+#include <initializer_list>
 
 class RenderGraphResourceNode;
 class Renderer;
+namespace enki { class TaskScheduler; }
 
 class RenderGraph
 {
     friend class RGBuilder;
+    friend class RGSetupRecorder;
 public:
-    RenderGraph(Renderer* pRenderer);
+    RenderGraph(IGfxDevice* pDevice);
 
     template<typename Data, typename Setup, typename Exec>
-    RenderGraphPass<Data>& AddPass(const eastl::string& name, RenderPassType type, const Setup& setup, const Exec& execute);
+    RenderGraphPass<Data>& AddPass(const RGName& name, RenderPassType type, const Setup& setup, const Exec& execute);
 
-    void BeginEvent(const eastl::string& name);
+    //the execute callback is called for each view, with the view index
+    template<typename Data, typename Setup, typename Exec>
+    RenderGraphMultiViewPass<Data>& AddMultiViewPass(const RGName& name, RenderPassType type, uint32_t view_count, const Setup& setup, const Exec& execute);
+
+    void BeginEvent(const RGName& name);
     void EndEvent();
 
+    //the tasks can run on worker threads if parallel setup is enabled, so they shouldn't use the handles created by each other.
+    //they are merged in the order of the list, the graph is the same as calling them one by one
+    void RunSetupTasks(std::initializer_list<eastl::function<void()>> tasks);
+    void SetParallelSetup(enki::TaskScheduler* ts) { m_pTaskScheduler = ts; } //nullptr runs the setup tasks serially
+
     void Clear();
     void Compile();
     void Execute(Renderer* pRenderer, IGfxCommandList* pCommandList, IGfxCommandList* pComputeCommandList);
@@ -32,13 +47,51 @@ public:
     RGHandle Import(IGfxTexture* texture, GfxResourceState state);
     RGHandle Import(IGfxBuffer* buffer, GfxResourceState state);
 
+    //the history texture written in the last frame, see RGBuilder::CreateHistory
+    RGHandle ImportPrevHistory(const RGTexture::Desc& desc, const RGName& name);
+    bool IsHistoryValid(const RGName& name) const { return m_resourceAllocator.IsHistoryValid(name); }
+
     RGTexture* GetTexture(const RGHandle& handle);
     RGBuffer* GetBuffer(const RGHandle& handle);
 
     const DirectedAcyclicGraph& GetDAG() const { return m_graph; }
+    const RenderGraphBarrierStats& GetBarrierStats() const { return m_barrierStats; }
+    const RenderGraphDescriptorCacheStats& GetDescriptorCacheStats() const { return m_resourceAllocator.GetDescriptorCacheStats(); }
+    void SetHeapPoolBudget(uint64_t size) { m_resourceAllocator.SetHeapPoolBudget(size); }
+
+    //moves compute passes to the async compute queue in Compile, the pass indices of the schedule don't count the culled passes
+    void SetAsyncComputeScheduling(bool value) { m_bAsyncComputeScheduling = value; }
+    RGAsyncComputeScheduler& GetAsyncComputeScheduler() { return m_asyncComputeScheduler; }
+    const RGAsyncComputeSchedule& GetAsyncComputeSchedule() const { return m_asyncComputeSchedule; }
+
+    //reorders the passes in Compile to lower the peak transient memory, the result has the peak bytes before and after
+    void SetPassReordering(bool value) { m_bPassReordering = value; }
+    const RGReorderResult& GetReorderResult() const { return m_reorderResult; }
+
     bool Export(const eastl::string& file);
 
+    //json of the transient resources after Compile : lifetimes in execute indices, heap placement, live bytes of each pass and the peak
+    bool ExportMemoryTimeline(const eastl::string& file);
+
+    //hash of the passes, resource versions and edges, it should be the same with or without parallel setup
+    uint64_t GetTopologyHash() const;
+
+    //passes, resources and edges of the graph without the pass callbacks, for compiling it offline (see render_graph_benchmark.h).
+    //the capture is saved in the next Compile, before the graph is changed by it
+    void CaptureTopology(const eastl::string& file) { m_captureFile = file; }
+    bool SaveTopology(const eastl::string& file) const;
+    //the graph should be cleared before loading, imported resources are created with the device and owned by the caller
+    bool LoadTopology(const eastl::string& file, IGfxDevice* pDevice, eastl::vector<eastl::unique_ptr<IGfxResource>>& imported_resources);
+
 private:
+    void ReorderPasses();
+    void ScheduleAsyncCompute();
+    void MergeReadStates();
+
+    RGHandle Resolve(const RGHandle& handle) const;
+    void BeginPass(RenderGraphPassBase* pass);
+    void EndPass(RenderGraphPassBase* pass);
+
     template<typename T, typename... ArgsT>
     T* Allocate(ArgsT&&... arguments);
 
@@ -46,10 +99,11 @@ private:
     T* AllocatePOD(ArgsT&&... arguments);
 
     template<typename Resource>
-    RGHandle Create(const typename Resource::Desc& desc, const eastl::string& name);
+    RGHandle Create(const typename Resource::Desc& desc, const RGName& name);
+    RGHandle CreateHistory(const RGTexture::Desc& desc, const RGName& name);
 
-    RGHandle Read(RenderGraphPassBase* pass, const RGHandle& input, GfxResourceState usage, uint32_t subresource);
-    RGHandle Write(RenderGraphPassBase* pass, const RGHandle& input, GfxResourceState usage, uint32_t subresource);
+    RGHandle Read(RenderGraphPassBase* pass, const RGHandle& input, GfxResourceState usage, uint32_t subresource, uint32_t subresource_count = 1, uint32_t first_view = 0);
+    RGHandle Write(RenderGraphPassBase* pass, const RGHandle& input, GfxResourceState usage, uint32_t subresource, uint32_t subresource_count = 1, uint32_t first_view = 0);
 
     RGHandle WriteColor(RenderGraphPassBase* pass, uint32_t color_index, const RGHandle& input, uint32_t subresource, GfxRenderPassLoadOp load_op, const float4& clear_color);
     RGHandle WriteDepth(RenderGraphPassBase* pass, const RGHandle& input, uint32_t subresource, GfxRenderPassLoadOp depth_load_op, GfxRenderPassLoadOp stencil_load_op, float clear_depth, uint32_t clear_stencil);
@@ -60,7 +114,7 @@ private:
     RenderGraphResourceAllocator m_resourceAllocator;
     DirectedAcyclicGraph m_graph;
 
-    eastl::vector<eastl::string> m_eventNames;
+    eastl::vector<RGName> m_eventNames;
 
     eastl::unique_ptr<IGfxFence> m_pComputeQueueFence;
     uint64_t m_nComputeQueueFenceValue = 0;
@@ -85,6 +139,22 @@ private:
         GfxResourceState state;
     };
     eastl::vector<PresentTarget> m_outputResources;
+
+    RenderGraphBarrierStats m_barrierStats;
+
+    bool m_bAsyncComputeScheduling = false;
+    RGAsyncComputeScheduler m_asyncComputeScheduler;
+    RGAsyncComputeSchedule m_asyncComputeSchedule;
+
+    bool m_bPassReordering = false;
+    RGPassReorderer m_passReorderer;
+    RGReorderResult m_reorderResult;
+
+    enki::TaskScheduler* m_pTaskScheduler = nullptr;
+    eastl::vector<eastl::unique_ptr<RGSetupRecorder>> m_setupRecorders;
+    uint32_t m_nSetupRecorderCount = 0; //recorders used in this frame
+
+    eastl::string m_captureFile;
 };
 
 class RenderGraphEvent
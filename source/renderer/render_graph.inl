@@ -6,19 +6,39 @@
 class RenderGraphEdge : public DAGEdge
 {
 public:
-    RenderGraphEdge(DirectedAcyclicGraph& graph, DAGNode* from, DAGNode* to, GfxResourceState usage, uint32_t subresource) :
+    RenderGraphEdge(DirectedAcyclicGraph& graph, DAGNode* from, DAGNode* to, GfxResourceState usage, uint32_t subresource, 
+        uint32_t subresource_count = 1, uint32_t first_view = 0) :
         DAGEdge(graph, from, to)
     {
         m_usage = usage;
         m_subresource = subresource;
+        m_subresourceCount = subresource_count;
+        m_firstView = first_view;
     }
 
     GfxResourceState GetUsage() const { return m_usage; }
+    void SetUsage(GfxResourceState usage) { m_usage = usage; }
     uint32_t GetSubresource() const { return m_subresource; }
+    uint32_t GetSubresourceCount() const { return m_subresourceCount; }
+    uint32_t GetFirstView() const { return m_firstView; }
+
+    bool HasSubresource(uint32_t subresource) const { return subresource - m_subresource < m_subresourceCount; }
+    bool Overlaps(const RenderGraphEdge* other) const
+    {
+        return m_subresource < other->m_subresource + other->m_subresourceCount && other->m_subresource < m_subresource + m_subresourceCount;
+    }
+
+    //view of a multi-view pass which uses the subresource, (first subresource + i) is used by (first view + i)
+    uint32_t GetView(uint32_t subresource, uint32_t view_count) const
+    {
+        return eastl::min(m_firstView + (subresource - m_subresource), view_count - 1);
+    }
 
 private:
     GfxResourceState m_usage;
     uint32_t m_subresource;
+    uint32_t m_subresourceCount;
+    uint32_t m_firstView;
 };
 
 class RenderGraphResourceNode : public DAGNode
@@ -142,27 +162,66 @@ inline T* RenderGraph::AllocatePOD(ArgsT&&... arguments)
 }
 
 template<typename Data, typename Setup, typename Exec>
-inline RenderGraphPass<Data>& RenderGraph::AddPass(const eastl::string& name, RenderPassType type, const Setup& setup, const Exec& execute)
+inline RenderGraphPass<Data>& RenderGraph::AddPass(const RGName& name, RenderPassType type, const Setup& setup, const Exec& execute)
 {
-    auto pass = Allocate<RenderGraphPass<Data>>(name, type, m_graph, execute);
+    RGSetupRecorder* recorder = RGSetupRecorder::GetCurrent(this);
 
-    for (size_t i = 0; i < m_eventNames.size(); ++i)
+    RenderGraphPass<Data>* pass;
+    if (recorder)
+    {
+        pass = recorder->Allocate<RenderGraphPass<Data>>(name, type, execute);
+    }
+    else
     {
-        pass->BeginEvent(m_eventNames[i]);
+        pass = Allocate<RenderGraphPass<Data>>(name, type, m_graph, execute);
     }
-    m_eventNames.clear();
+
+    BeginPass(pass);
 
     RGBuilder builder(this, pass);
     setup(pass->GetData(), builder);
 
-    m_passes.push_back(pass);
+    EndPass(pass);
+
+    return *pass;
+}
+
+template<typename Data, typename Setup, typename Exec>
+inline RenderGraphMultiViewPass<Data>& RenderGraph::AddMultiViewPass(const RGName& name, RenderPassType type, uint32_t view_count, const Setup& setup, const Exec& execute)
+{
+    RE_ASSERT(type != RenderPassType::Graphics); //see RenderGraphMultiViewPass
+
+    RGSetupRecorder* recorder = RGSetupRecorder::GetCurrent(this);
+
+    RenderGraphMultiViewPass<Data>* pass;
+    if (recorder)
+    {
+        pass = recorder->Allocate<RenderGraphMultiViewPass<Data>>(name, type, view_count, execute);
+    }
+    else
+    {
+        pass = Allocate<RenderGraphMultiViewPass<Data>>(name, type, view_count, m_graph, execute);
+    }
+
+    BeginPass(pass);
+
+    RGBuilder builder(this, pass);
+    setup(pass->GetData(), builder);
+
+    EndPass(pass);
 
     return *pass;
 }
 
 template<typename Resource>
-inline RGHandle RenderGraph::Create(const typename Resource::Desc& desc, const eastl::string& name)
+inline RGHandle RenderGraph::Create(const typename Resource::Desc& desc, const RGName& name)
 {
+    RGSetupRecorder* recorder = RGSetupRecorder::GetCurrent(this);
+    if (recorder)
+    {
+        return recorder->Create(desc, name);
+    }
+
     auto resource = Allocate<Resource>(m_resourceAllocator, name, desc);
     auto node = AllocatePOD<RenderGraphResourceNode>(m_graph, resource, 0);
 
@@ -0,0 +1,126 @@
+#include "render_graph_async_compute.h"
+#include "EASTL/algorithm.h"
+
+void RGAsyncComputeScheduler::Schedule(const eastl::vector<RGAsyncComputePass>& passes, RGAsyncComputeSchedule& schedule) const
+{
+    schedule.batches.clear();
+    schedule.movedPasses.clear();
+
+    eastl::vector<bool> async(passes.size());
+    for (size_t i = 0; i < passes.size(); ++i)
+    {
+        async[i] = passes[i].asyncCompute;
+    }
+
+    uint32_t pass_count = (uint32_t)passes.size();
+    uint32_t i = 0;
+
+    while (i < pass_count)
+    {
+        if (!passes[i].asyncCompute && !passes[i].candidate)
+        {
+            ++i;
+            continue;
+        }
+
+        //consecutive passes share one fence pair, like in RenderGraphPassBase::ResolveAsyncCompute
+        uint32_t begin = i;
+        bool has_async_pass = false;
+        bool has_candidate = false;
+
+        while (i < pass_count && (passes[i].asyncCompute || passes[i].candidate))
+        {
+            has_async_pass |= passes[i].asyncCompute;
+            has_candidate |= passes[i].candidate;
+            ++i;
+        }
+
+        RGAsyncComputeBatch batch;
+        BuildBatch(passes, async, begin, i, batch);
+
+        //if there are already async passes, the fence pair is paid anyway
+        bool move_candidates = has_candidate && (has_async_pass ||
+            (batch.waitPass != UINT32_MAX && batch.signalPass != UINT32_MAX && eastl::min(batch.cost, batch.overlap) > m_fenceCost));
+
+        if (move_candidates)
+        {
+            for (uint32_t pass = begin; pass < i; ++pass)
+            {
+                if (passes[pass].candidate)
+                {
+                    async[pass] = true;
+                    schedule.movedPasses.push_back(pass);
+                }
+            }
+
+            schedule.batches.push_back(batch);
+        }
+        else if (has_async_pass)
+        {
+            //the rejected candidates split the async passes into several batches
+            uint32_t pass = begin;
+
+            while (pass < i)
+            {
+                if (!passes[pass].asyncCompute)
+                {
+                    ++pass;
+                    continue;
+                }
+
+                uint32_t batch_begin = pass;
+                while (pass < i && passes[pass].asyncCompute)
+                {
+                    ++pass;
+                }
+
+                RGAsyncComputeBatch async_batch;
+                BuildBatch(passes, async, batch_begin, pass, async_batch);
+                schedule.batches.push_back(async_batch);
+            }
+        }
+    }
+}
+
+void RGAsyncComputeScheduler::BuildBatch(const eastl::vector<RGAsyncComputePass>& passes, const eastl::vector<bool>& async, uint32_t begin, uint32_t end, RGAsyncComputeBatch& batch) const
+{
+    for (uint32_t i = begin; i < end; ++i)
+    {
+        const RGAsyncComputePass& pass = passes[i];
+
+        batch.passes.push_back(i);
+        batch.cost += pass.cost;
+
+        //dependencies on the async compute queue are ordered by the queue itself
+        for (size_t j = 0; j < pass.dependencies.size(); ++j)
+        {
+            uint32_t dependency = pass.dependencies[j];
+            if (dependency < begin && !async[dependency])
+            {
+                batch.waitPass = batch.waitPass == UINT32_MAX ? dependency : eastl::max(batch.waitPass, dependency);
+            }
+        }
+
+        //the later candidates are not scheduled yet, they are treated as graphics queue passes
+        for (size_t j = 0; j < pass.dependents.size(); ++j)
+        {
+            uint32_t dependent = pass.dependents[j];
+            if (dependent >= end && !async[dependent])
+            {
+                batch.signalPass = eastl::min(batch.signalPass, dependent);
+            }
+        }
+    }
+
+    //graphics queue work between the wait and the signal runs in parallel with the batch
+    uint32_t first = batch.waitPass == UINT32_MAX ? 0 : batch.waitPass + 1;
+    uint32_t last = eastl::min(batch.signalPass, (uint32_t)passes.size());
+
+    for (uint32_t i = first; i < last; ++i)
+    {
+        if ((i < begin || i >= end) && !async[i])
+        {
+            batch.overlap += passes[i].cost;
+        }
+    }
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "EASTL/vector.h"
+
+//a pass of the scheduler input, passes are in the execution order and culled passes are not included
+struct RGAsyncComputePass
+{
+    bool asyncCompute = false; //already on the async compute queue
+    bool candidate = false;    //compute pass which can be moved to the async compute queue
+    float cost = 0.0f;         //estimated cost, in bytes of the accessed resources
+
+    eastl::vector<uint32_t> dependencies; //indices of the passes it should run after
+    eastl::vector<uint32_t> dependents;   //indices of the passes which should run after it
+};
+
+//consecutive async compute passes, synchronized with the graphics queue by one pair of fences
+struct RGAsyncComputeBatch
+{
+    eastl::vector<uint32_t> passes;
+    uint32_t waitPass = UINT32_MAX;   //graphics queue pass signaling the batch
+    uint32_t signalPass = UINT32_MAX; //graphics queue pass waiting for the batch
+    float cost = 0.0f;
+    float overlap = 0.0f;             //estimated graphics queue work running in parallel with the batch
+};
+
+struct RGAsyncComputeSchedule
+{
+    eastl::vector<RGAsyncComputeBatch> batches;
+    eastl::vector<uint32_t> movedPasses; //candidates moved to the async compute queue
+};
+
+//moves candidate compute passes to the async compute queue, when they can overlap enough graphics work to pay for a fence pair
+class RGAsyncComputeScheduler
+{
+public:
+    float GetFenceCost() const { return m_fenceCost; }
+    void SetFenceCost(float cost) { m_fenceCost = cost; }
+
+    void Schedule(const eastl::vector<RGAsyncComputePass>& passes, RGAsyncComputeSchedule& schedule) const;
+
+private:
+    void BuildBatch(const eastl::vector<RGAsyncComputePass>& passes, const eastl::vector<bool>& async, uint32_t begin, uint32_t end, RGAsyncComputeBatch& batch) const;
+
+private:
+    float m_fenceCost = 8.0f * 1024 * 1024;
+};
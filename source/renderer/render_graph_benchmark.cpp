@@ -0,0 +1,78 @@
+#include "render_graph_benchmark.h"
+#include "render_graph.h"
+#include "gfx/gfx.h"
+#include "utils/log.h"
+#include "sokol/sokol_time.h"
+#include <cfloat>
+
+bool BenchmarkRenderGraphCompile(const eastl::string& file, uint32_t iterations, bool async_compute, bool reorder, RGCompileBenchmarkResult& result)
+{
+    GfxDeviceDesc desc;
+    desc.backend = GfxRenderBackend::Mock;
+    eastl::unique_ptr<IGfxDevice> device(CreateGfxDevice(desc));
+
+    //declared after the device, it is destroyed first
+    eastl::unique_ptr<RenderGraph> graph = eastl::make_unique<RenderGraph>(device.get());
+    graph->SetAsyncComputeScheduling(async_compute);
+    graph->SetPassReordering(reorder);
+
+    eastl::vector<eastl::unique_ptr<IGfxResource>> imported_resources;
+
+    result = RGCompileBenchmarkResult();
+    result.minTime = DBL_MAX;
+
+    for (uint32_t i = 0; i < iterations; ++i)
+    {
+        device->BeginFrame();
+        graph->Clear();
+        imported_resources.clear();
+
+        if (!graph->LoadTopology(file, device.get(), imported_resources))
+        {
+            RE_LOG("failed to load the render graph topology : {}", file.c_str());
+            return false;
+        }
+
+        uint64_t start = stm_now();
+        graph->Compile();
+        double time = stm_ms(stm_since(start));
+
+        result.minTime = eastl::min(result.minTime, time);
+        result.maxTime = eastl::max(result.maxTime, time);
+        result.avgTime += time;
+
+        device->EndFrame();
+    }
+
+    if (iterations == 0)
+    {
+        result.minTime = 0.0;
+        return true;
+    }
+
+    result.iterations = iterations;
+    result.avgTime /= iterations;
+
+    const DirectedAcyclicGraph& dag = graph->GetDAG();
+    for (uint32_t i = 0; i < dag.GetNodeCount(); ++i)
+    {
+        const DAGNode* node = dag.GetNode(i);
+        if (dynamic_cast<const RenderGraphPassBase*>(node))
+        {
+            result.passes++;
+            result.culledPasses += node->IsCulled() ? 1 : 0;
+        }
+        else
+        {
+            result.resourceNodes++;
+        }
+    }
+    result.edges = (uint32_t)dag.GetEdges().size();
+
+    result.barrierStats = graph->GetBarrierStats();
+    result.peakBytesBefore = graph->GetReorderResult().peakBytesBefore;
+    result.peakBytesAfter = graph->GetReorderResult().peakBytesAfter;
+
+    graph->Clear();
+    return true;
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "render_graph_pass.h"
+#include "EASTL/string.h"
+
+struct RGCompileBenchmarkResult
+{
+    uint32_t iterations = 0;
+    uint32_t passes = 0;
+    uint32_t culledPasses = 0;
+    uint32_t resourceNodes = 0;
+    uint32_t edges = 0;
+
+    double minTime = 0.0; //ms, loading the topology is not included
+    double avgTime = 0.0;
+    double maxTime = 0.0;
+
+    RenderGraphBarrierStats barrierStats;
+    uint64_t peakBytesBefore = 0;
+    uint64_t peakBytesAfter = 0;
+};
+
+//compiles a topology saved by RenderGraph::SaveTopology on a mock device, so the compile cost can be measured without a GPU.
+//each iteration is a frame, the transient heaps and history textures are reused as in the renderer
+bool BenchmarkRenderGraphCompile(const eastl::string& file, uint32_t iterations, bool async_compute, bool reorder, RGCompileBenchmarkResult& result);
@@ -21,12 +21,21 @@ public:
 
     void SkipCulling() { m_pPass->MakeTarget(); }
 
+    //the execute callback uses only the resources declared here (plus constants), so the pass can be scheduled on the async compute queue
+    void AllowAsyncCompute() { m_pPass->AllowAsyncCompute(); }
+
     template<typename Resource>
-    RGHandle Create(const typename Resource::Desc& desc, const eastl::string& name)
+    RGHandle Create(const typename Resource::Desc& desc, const RGName& name)
     {
         return m_pGraph->Create<Resource>(desc, name);
     }
 
+    //persistent and double-buffered, it can be read as RenderGraph::ImportPrevHistory in the next frame without copies
+    RGHandle CreateHistory(const RGTexture::Desc& desc, const RGName& name)
+    {
+        return m_pGraph->CreateHistory(desc, name);
+    }
+
     RGHandle Import(IGfxTexture* texture, GfxResourceState state)
     {
         return m_pGraph->Import(texture, state);
@@ -47,6 +56,73 @@ public:
     }
 
     RGHandle Read(const RGHandle& input, uint32_t subresource = 0, RGBuilderFlag flag = RGBuilderFlag::None)
+    {
+        return Read(input, GetReadState(flag), subresource);
+    }
+
+    RGHandle ReadIndirectArg(const RGHandle& input, uint32_t subresource = 0)
+    {
+        return Read(input, GfxResourceState::IndirectArg, subresource);
+    }
+
+    RGHandle Write(const RGHandle& input, GfxResourceState usage, uint32_t subresource = 0)
+    {
+        RE_ASSERT(usage == GfxResourceState::UnorderedAccess ||
+            usage == GfxResourceState::CopyDst ||
+            usage == GfxResourceState::ResolveDst);
+
+        RE_ASSERT(GFX_ALL_SUB_RESOURCE != subresource); //RG doesn't support GFX_ALL_SUB_RESOURCE currently
+
+        return m_pGraph->Write(m_pPass, input, usage, subresource);
+    }
+
+    RGHandle Write(const RGHandle& input, uint32_t subresource = 0)
+    {
+        return Write(input, GetWriteState(), subresource);
+    }
+
+    //subresource (first_subresource + i) is used by the view (first_view + i) of a multi-view pass, or by the whole pass in other passes.
+    //a pass which reads the views written by its earlier views should declare the reads first
+    RGHandle ReadViews(const RGHandle& input, uint32_t first_subresource, uint32_t count, uint32_t first_view = 0, RGBuilderFlag flag = RGBuilderFlag::None)
+    {
+        RE_ASSERT(count > 0 && first_view < m_pPass->GetViewCount());
+        return m_pGraph->Read(m_pPass, input, GetReadState(flag), first_subresource, count, first_view);
+    }
+
+    RGHandle WriteViews(const RGHandle& input, uint32_t first_subresource, uint32_t count, uint32_t first_view = 0)
+    {
+        RE_ASSERT(count > 0 && first_view < m_pPass->GetViewCount());
+        return m_pGraph->Write(m_pPass, input, GetWriteState(), first_subresource, count, first_view);
+    }
+
+    RGHandle WriteColor(uint32_t color_index, const RGHandle& input, uint32_t subresource, GfxRenderPassLoadOp load_op, float4 clear_color = float4(0.0f, 0.0f, 0.0f, 1.0f))
+    {
+        RE_ASSERT(m_pPass->GetType() == RenderPassType::Graphics);
+        return m_pGraph->WriteColor(m_pPass, color_index, input, subresource, load_op, clear_color);
+    }
+
+    RGHandle WriteDepth(const RGHandle& input, uint32_t subresource, GfxRenderPassLoadOp depth_load_op, float clear_depth = 0.0f)
+    {
+        RE_ASSERT(m_pPass->GetType() == RenderPassType::Graphics);
+        return m_pGraph->WriteDepth(m_pPass, input, subresource, depth_load_op, GfxRenderPassLoadOp::DontCare, clear_depth, 0);
+    }
+
+    RGHandle WriteDepth(const RGHandle& input, uint32_t subresource, GfxRenderPassLoadOp depth_load_op, GfxRenderPassLoadOp stencil_load_op, float clear_depth = 0.0f, uint32_t clear_stencil = 0)
+    {
+        RE_ASSERT(m_pPass->GetType() == RenderPassType::Graphics);
+        return m_pGraph->WriteDepth(m_pPass, input, subresource, depth_load_op, stencil_load_op, clear_depth, clear_stencil);
+    }
+
+    RGHandle ReadDepth(const RGHandle& input, uint32_t subresource)
+    {
+        RE_ASSERT(m_pPass->GetType() == RenderPassType::Graphics);
+        return m_pGraph->ReadDepth(m_pPass, input, subresource);
+    }
+private:
+    RGBuilder(RGBuilder const&) = delete;
+    RGBuilder& operator=(RGBuilder const&) = delete;
+
+    GfxResourceState GetReadState(RGBuilderFlag flag) const
     {
         GfxResourceState state;
 
@@ -80,26 +156,10 @@ public:
             RE_ASSERT(false);
             break;
         }
-        return Read(input, state, subresource);
-    }
-
-    RGHandle ReadIndirectArg(const RGHandle& input, uint32_t subresource = 0)
-    {
-        return Read(input, GfxResourceState::IndirectArg, subresource);
+        return state;
     }
 
-    RGHandle Write(const RGHandle& input, GfxResourceState usage, uint32_t subresource = 0)
-    {
-        RE_ASSERT(usage == GfxResourceState::UnorderedAccess ||
-            usage == GfxResourceState::CopyDst ||
-            usage == GfxResourceState::ResolveDst);
-
-        RE_ASSERT(GFX_ALL_SUB_RESOURCE != subresource); //RG doesn't support GFX_ALL_SUB_RESOURCE currently
-
-        return m_pGraph->Write(m_pPass, input, usage, subresource);
-    }
-
-    RGHandle Write(const RGHandle& input, uint32_t subresource = 0)
+    GfxResourceState GetWriteState() const
     {
         GfxResourceState state;
 
@@ -120,36 +180,9 @@ public:
             RE_ASSERT(false);
             break;
         }
-        return Write(input, state, subresource);
-    }
-
-    RGHandle WriteColor(uint32_t color_index, const RGHandle& input, uint32_t subresource, GfxRenderPassLoadOp load_op, float4 clear_color = float4(0.0f, 0.0f, 0.0f, 1.0f))
-    {
-        RE_ASSERT(m_pPass->GetType() == RenderPassType::Graphics);
-        return m_pGraph->WriteColor(m_pPass, color_index, input, subresource, load_op, clear_color);
-    }
-
-    RGHandle WriteDepth(const RGHandle& input, uint32_t subresource, GfxRenderPassLoadOp depth_load_op, float clear_depth = 0.0f)
-    {
-        RE_ASSERT(m_pPass->GetType() == RenderPassType::Graphics);
-        return m_pGraph->WriteDepth(m_pPass, input, subresource, depth_load_op, GfxRenderPassLoadOp::DontCare, clear_depth, 0);
-    }
-
-    RGHandle WriteDepth(const RGHandle& input, uint32_t subresource, GfxRenderPassLoadOp depth_load_op, GfxRenderPassLoadOp stencil_load_op, float clear_depth = 0.0f, uint32_t clear_stencil = 0)
-    {
-        RE_ASSERT(m_pPass->GetType() == RenderPassType::Graphics);
-        return m_pGraph->WriteDepth(m_pPass, input, subresource, depth_load_op, stencil_load_op, clear_depth, clear_stencil);
+        return state;
     }
 
-    RGHandle ReadDepth(const RGHandle& input, uint32_t subresource)
-    {
-        RE_ASSERT(m_pPass->GetType() == RenderPassType::Graphics);
-        return m_pGraph->ReadDepth(m_pPass, input, subresource);
-    }
-private:
-    RGBuilder(RGBuilder const&) = delete;
-    RGBuilder& operator=(RGBuilder const&) = delete;
-
 private:
     RenderGraph* m_pGraph = nullptr;
     RenderGraphPassBase* m_pPass = nullptr;
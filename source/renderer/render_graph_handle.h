@@ -6,6 +6,7 @@ struct RGHandle
 {
     uint16_t index = uint16_t(-1);
     uint16_t node = uint16_t(-1);
+    uint16_t recorder = 0; //1-based id of the setup recorder if it is recorded in RenderGraph::RunSetupTasks, see RGSetupRecorder
 
     bool IsValid() const
     {
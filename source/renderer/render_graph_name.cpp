@@ -0,0 +1,66 @@
+#include "render_graph_name.h"
+#include "EASTL/hash_map.h"
+#include "xxHash/xxhash.h"
+#include <mutex>
+#include <shared_mutex>
+
+struct RGNameTable
+{
+    //nodes of the hash map are not moved, so the string pointers stay valid.
+    //the colliding hashes are chained, the strings are compared on lookup
+    eastl::hash_multimap<uint64_t, eastl::string> names;
+    std::shared_mutex mutex;
+};
+
+static RGNameTable& GetNameTable()
+{
+    static RGNameTable table;
+    return table;
+}
+
+static const eastl::string* FindName(const RGNameTable& table, uint64_t hash, const char* name, size_t length)
+{
+    auto range = table.names.equal_range(hash);
+    for (auto iter = range.first; iter != range.second; ++iter)
+    {
+        if (iter->second.size() == length && memcmp(iter->second.data(), name, length) == 0)
+        {
+            return &iter->second;
+        }
+    }
+    return nullptr;
+}
+
+RGName::RGName(const char* name, size_t length)
+{
+    RGNameTable& table = GetNameTable();
+    m_hash = XXH3_64bits(name, length);
+
+    {
+        std::shared_lock lock(table.mutex);
+
+        const eastl::string* str = FindName(table, m_hash, name, length);
+        if (str)
+        {
+            m_str = str->c_str();
+            return;
+        }
+    }
+
+    std::unique_lock lock(table.mutex);
+
+    const eastl::string* str = FindName(table, m_hash, name, length);
+    if (str == nullptr)
+    {
+        str = &table.names.insert(eastl::make_pair(m_hash, eastl::string(name, length)))->second;
+    }
+    m_str = str->c_str();
+}
+
+uint32_t RGName::GetInternedCount()
+{
+    RGNameTable& table = GetNameTable();
+    std::shared_lock lock(table.mutex);
+
+    return (uint32_t)table.names.size();
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "EASTL/string.h"
+#include "EASTL/algorithm.h"
+#include "fmt/format.h"
+
+//name of a render graph pass, resource or event.
+//names are interned in a persistent table, so building passes every frame doesn't allocate strings.
+//the table is never shrunk, so the names shouldn't have values which keep changing, like the resolution
+class RGName
+{
+public:
+    RGName() = default;
+    RGName(const char* name) : RGName(name, strlen(name)) {}
+    RGName(const eastl::string& name) : RGName(name.data(), name.size()) {}
+    RGName(const char* name, size_t length);
+
+    //formatted in a stack buffer, only the first use of a name allocates
+    template<typename... Args>
+    static RGName Format(fmt::format_string<Args...> format, Args&&... args)
+    {
+        char buffer[256];
+        auto result = fmt::format_to_n(buffer, sizeof(buffer), format, eastl::forward<Args>(args)...);
+        return RGName(buffer, eastl::min(result.size, sizeof(buffer)));
+    }
+
+    const char* c_str() const { return m_str; }
+    uint64_t GetHash() const { return m_hash; }
+
+    //names with colliding hashes are different strings in the table
+    bool operator==(const RGName& other) const { return m_hash == other.m_hash && (m_str == other.m_str || strcmp(m_str, other.m_str) == 0); }
+    bool operator!=(const RGName& other) const { return !(*this == other); }
+
+    static uint32_t GetInternedCount();
+
+private:
+    uint64_t m_hash = 0;
+    const char* m_str = "";
+};
@@ -3,13 +3,71 @@
 #include "renderer.h"
 #include "EASTL/algorithm.h"
 
-RenderGraphPassBase::RenderGraphPassBase(const eastl::string& name, RenderPassType type, DirectedAcyclicGraph& graph) :
+static inline bool IsComputeQueueState(GfxResourceState state)
+{
+    switch (state)
+    {
+    case GfxResourceState::Common:
+    case GfxResourceState::UnorderedAccess:
+    case GfxResourceState::ShaderResourceNonPS:
+    case GfxResourceState::IndirectArg:
+    case GfxResourceState::CopyDst:
+    case GfxResourceState::CopySrc:
+        return true;
+    default:
+        return false;
+    }
+}
+
+static inline bool IsWritingResource(const DirectedAcyclicGraph& graph, const DAGNode* pass, const RenderGraphResource* resource)
+{
+    eastl::vector<DAGEdge*> edges;
+    graph.GetOutgoingEdges(pass, edges);
+
+    for (size_t i = 0; i < edges.size(); ++i)
+    {
+        RenderGraphResourceNode* node = (RenderGraphResourceNode*)graph.GetNode(edges[i]->GetToNode());
+        if (node->GetResource() == resource)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+//Load is not needed if the previous version is undefined, the first version of a transient resource has no contents
+static inline GfxRenderPassLoadOp InferLoadOp(GfxRenderPassLoadOp load_op, const RenderGraphResourceNode* output_node)
+{
+    if (load_op == GfxRenderPassLoadOp::Load && output_node->GetVersion() == 1 && !output_node->GetResource()->HasInitialContents())
+    {
+        return GfxRenderPassLoadOp::DontCare;
+    }
+    return load_op;
+}
+
+//the output is needed if it is read by a later pass, or the resource is used after this frame
+static inline GfxRenderPassStoreOp InferStoreOp(const RenderGraphResourceNode* output_node)
+{
+    if (!output_node->IsCulled() || !output_node->GetResource()->IsOverlapping())
+    {
+        return GfxRenderPassStoreOp::Store;
+    }
+    return GfxRenderPassStoreOp::DontCare;
+}
+
+RenderGraphPassBase::RenderGraphPassBase(const RGName& name, RenderPassType type, DirectedAcyclicGraph& graph) :
     DAGNode(graph)
 {
     m_name = name;
     m_type = type;
 }
 
+RenderGraphPassBase::RenderGraphPassBase(const RGName& name, RenderPassType type)
+{
+    m_name = name;
+    m_type = type;
+}
+
 //todo : https://docs.microsoft.com/en-us/windows/win32/direct3d12/executing-and-synchronizing-command-lists#accessing-resources-from-multiple-command-queues
 void RenderGraphPassBase::ResolveBarriers(const DirectedAcyclicGraph& graph)
 {
@@ -32,52 +90,109 @@ void RenderGraphPassBase::ResolveBarriers(const DirectedAcyclicGraph& graph)
         RE_ASSERT(resource_incoming.size() <= 1);
         RE_ASSERT(resource_outgoing.size() >= 1);
 
-        GfxResourceState old_state = GfxResourceState::Present;
-        GfxResourceState new_state = edge->GetUsage();
-
-        //try to find previous state from last pass which used this resource
-        if (resource_outgoing.size() > 1) //todo : should merge states if possible, eg. shader resource ps + shader resource non-ps -> shader resource all
+        //a view range needs a barrier for each subresource
+        uint32_t last_subresource = edge->GetSubresource() + edge->GetSubresourceCount();
+        for (uint32_t subresource = edge->GetSubresource(); subresource < last_subresource; ++subresource)
         {
-            //resource_outgoing should be sorted
-            for (int i = (int)resource_outgoing.size() - 1; i >= 0; --i)
+            GfxResourceState new_state = edge->GetUsage();
+
+            //used by an earlier view of this pass, it is transitioned between the views
+            if (m_nViewCount > 1)
             {
-                uint32_t subresource = ((RenderGraphEdge*)resource_outgoing[i])->GetSubresource();
-                DAGNodeID pass_id = resource_outgoing[i]->GetToNode();
-                if (subresource == edge->GetSubresource() && pass_id < this->GetId() && !graph.GetNode(pass_id)->IsCulled())
+                uint32_t view = edge->GetView(subresource, m_nViewCount);
+                GfxResourceState view_state = GetPrevViewState(graph, edges, edge, subresource, view);
+
+                if (view_state != GfxResourceState::Present)
                 {
-                    old_state = ((RenderGraphEdge*)resource_outgoing[i])->GetUsage();
-                    break;
+                    if (view_state != new_state)
+                    {
+                        ViewBarrier barrier = { resource, subresource, view_state, new_state, view };
+                        m_viewBarriers.push_back(barrier);
+                    }
+                    else if (new_state == GfxResourceState::UnorderedAccess)
+                    {
+                        //written by two views, the same states mean a uav barrier
+                        ViewBarrier barrier = { resource, subresource, new_state, new_state, view };
+                        m_viewBarriers.push_back(barrier);
+                    }
+                    continue;
                 }
             }
-        }
 
-        //if not found, get the state from the pass which output the resource
-        if (old_state == GfxResourceState::Present)
-        {
-            if (resource_incoming.empty())
+            GfxResourceState old_state = GfxResourceState::Present;
+            DAGNodeID old_state_pass = UINT32_MAX;
+
+            //try to find previous state from last pass which used this resource
+            //read states of the same version are already merged in RenderGraph::Compile, so readers after the first one don't need barriers
+            if (resource_outgoing.size() > 1)
             {
-                RE_ASSERT(resource_node->GetVersion() == 0);
-                old_state = resource->GetInitialState();
+                //passes may be reordered, so the last one is found by the execute index
+                uint32_t old_state_index = 0;
+
+                for (size_t j = 0; j < resource_outgoing.size(); ++j)
+                {
+                    RenderGraphEdge* other_edge = (RenderGraphEdge*)resource_outgoing[j];
+                    RenderGraphPassBase* pass = (RenderGraphPassBase*)graph.GetNode(other_edge->GetToNode());
+                    if (other_edge->HasSubresource(subresource) && pass->m_nExecuteIndex < m_nExecuteIndex && !pass->IsCulled() &&
+                        (old_state_pass == UINT32_MAX || pass->m_nExecuteIndex > old_state_index))
+                    {
+                        old_state = pass->GetFinalState(graph, other_edge, subresource);
+                        old_state_pass = pass->GetId();
+                        old_state_index = pass->m_nExecuteIndex;
+                    }
+                }
             }
-            else
+
+            //if not found, get the state from the pass which output the resource
+            if (old_state == GfxResourceState::Present)
             {
-                old_state = ((RenderGraphEdge*)resource_incoming[0])->GetUsage();
+                if (resource_incoming.empty())
+                {
+                    RE_ASSERT(resource_node->GetVersion() == 0);
+                    old_state = resource->GetInitialState();
+                }
+                else
+                {
+                    RenderGraphPassBase* pass = (RenderGraphPassBase*)graph.GetNode(resource_incoming[0]->GetFromNode());
+                    old_state = pass->GetFinalState(graph, (RenderGraphEdge*)resource_incoming[0], subresource);
+                    old_state_pass = pass->GetId();
+                }
             }
-        }
-
-        if (old_state != new_state)
-        {
-            //TODO : uav barrier
-            ResourceBarrier barrier;
-            barrier.resource = resource;
-            barrier.sub_resource = edge->GetSubresource();
-            barrier.old_state = old_state;
-            barrier.new_state = new_state;
 
-            m_resourceBarriers.push_back(barrier);
+            if (old_state != new_state)
+            {
+                ResourceBarrier barrier;
+                barrier.resource = resource;
+                barrier.sub_resource = subresource;
+                barrier.old_state = old_state;
+                barrier.new_state = new_state;
+                barrier.begin_pass = old_state_pass;
+                barrier.split = false;
+
+                //compute queue can't transition from graphics states, so it is done by the graphics pass it waits for.
+                //passes without one are moved back to the graphics queue in RenderGraph::Compile
+                if (m_type == RenderPassType::AsyncCompute && !IsComputeQueueState(old_state))
+                {
+                    RE_ASSERT(m_waitGraphicsPass != UINT32_MAX);
+                    RenderGraphPassBase* wait_pass = (RenderGraphPassBase*)graph.GetNode(m_waitGraphicsPass);
+                    wait_pass->m_endBarriers.push_back(barrier);
+                }
+                else
+                {
+                    m_resourceBarriers.push_back(barrier);
+                }
+            }
+            else if (new_state == GfxResourceState::UnorderedAccess && old_state_pass != UINT32_MAX)
+            {
+                //write after write in this frame, uav accesses of different passes need to be ordered
+                if (m_uavBarriers.empty() || m_uavBarriers.back() != resource)
+                {
+                    m_uavBarriers.push_back(resource);
+                }
+            }
         }
 
-        if (resource->IsOverlapping() && resource->GetFirstPassID() == this->GetId())
+        if (resource->IsOverlapping() && resource->GetFirstPassIndex() == m_nExecuteIndex && !HasAliasBarrier(resource))
         {
             IGfxResource* aliased_resource = resource->GetAliasedPrevResource();
             if (aliased_resource)
@@ -111,54 +226,249 @@ void RenderGraphPassBase::ResolveBarriers(const DirectedAcyclicGraph& graph)
             m_pDepthRT = (RenderGraphEdgeDepthAttchment*)edge;
         }
     }
+
+    if (HasGfxRenderPass())
+    {
+        ResolveRenderPass(graph);
+    }
 }
 
-void RenderGraphPassBase::ResolveAsyncCompute(const DirectedAcyclicGraph& graph, RenderGraphAsyncResolveContext& context)
+bool RenderGraphPassBase::HasAliasBarrier(RenderGraphResource* resource) const
+{
+    //a pass may use several subresources or views of the resource
+    for (size_t i = 0; i < m_aliasBarriers.size(); ++i)
+    {
+        if (m_aliasBarriers[i].after == resource->GetResource())
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+GfxResourceState RenderGraphPassBase::GetFinalState(const DirectedAcyclicGraph& graph, const RenderGraphEdge* edge, uint32_t subresource) const
 {
+    if (m_nViewCount == 1)
+    {
+        return edge->GetUsage();
+    }
+
+    //the state of the last view which used the subresource, the edge may be an output of this pass
+    DAGNodeID resource_node = edge->GetFromNode() == GetId() ? edge->GetToNode() : edge->GetFromNode();
+    const RenderGraphResource* resource = ((RenderGraphResourceNode*)graph.GetNode(resource_node))->GetResource();
+
+    eastl::vector<DAGEdge*> edges;
+    graph.GetIncomingEdges(this, edges);
+
+    GfxResourceState state = edge->GetUsage();
+    uint32_t last_view = 0;
+
+    for (size_t i = 0; i < edges.size(); ++i)
+    {
+        const RenderGraphEdge* other_edge = (const RenderGraphEdge*)edges[i];
+        const RenderGraphResourceNode* node = (const RenderGraphResourceNode*)graph.GetNode(other_edge->GetFromNode());
+
+        if (node->GetResource() == resource && other_edge->HasSubresource(subresource))
+        {
+            uint32_t view = other_edge->GetView(subresource, m_nViewCount);
+            if (view > last_view)
+            {
+                state = other_edge->GetUsage();
+                last_view = view;
+            }
+        }
+    }
+
+    return state;
+}
+
+GfxResourceState RenderGraphPassBase::GetPrevViewState(const DirectedAcyclicGraph& graph, const eastl::vector<DAGEdge*>& edges, const RenderGraphEdge* edge, uint32_t subresource, uint32_t view) const
+{
+    const RenderGraphResource* resource = ((RenderGraphResourceNode*)graph.GetNode(edge->GetFromNode()))->GetResource();
+
+    GfxResourceState state = GfxResourceState::Present;
+    uint32_t prev_view = 0;
+
+    for (size_t i = 0; i < edges.size(); ++i)
+    {
+        const RenderGraphEdge* other_edge = (const RenderGraphEdge*)edges[i];
+        const RenderGraphResourceNode* node = (const RenderGraphResourceNode*)graph.GetNode(other_edge->GetFromNode());
+
+        if (other_edge == edge || node->GetResource() != resource || !other_edge->HasSubresource(subresource))
+        {
+            continue;
+        }
+
+        uint32_t other_view = other_edge->GetView(subresource, m_nViewCount);
+        if (other_view < view && (state == GfxResourceState::Present || other_view >= prev_view))
+        {
+            state = other_edge->GetUsage();
+            prev_view = other_view;
+        }
+    }
+
+    return state;
+}
+
+void RenderGraphPassBase::ResolveRenderPass(const DirectedAcyclicGraph& graph)
+{
+    for (int i = 0; i < 8; ++i)
+    {
+        if (m_pColorRT[i] != nullptr)
+        {
+            RenderGraphResourceNode* node = (RenderGraphResourceNode*)graph.GetNode(m_pColorRT[i]->GetToNode());
+            IGfxTexture* texture = ((RGTexture*)node->GetResource())->GetTexture();
+
+            uint32_t mip, slice;
+            DecomposeSubresource(texture->GetDesc(), m_pColorRT[i]->GetSubresource(), mip, slice);
+
+            GfxRenderPassColorAttachment& color = m_renderPassDesc.color[i];
+            color.texture = texture;
+            color.mip_slice = mip;
+            color.array_slice = slice;
+            color.load_op = InferLoadOp(m_pColorRT[i]->GetLoadOp(), node);
+            color.store_op = InferStoreOp(node);
+            memcpy(color.clear_color, m_pColorRT[i]->GetClearColor(), sizeof(float) * 4);
+
+            //nothing reads what is written, so clearing or loading it is useless
+            if (color.store_op == GfxRenderPassStoreOp::DontCare)
+            {
+                color.load_op = GfxRenderPassLoadOp::DontCare;
+            }
+        }
+    }
+
+    if (m_pDepthRT != nullptr)
+    {
+        RenderGraphResourceNode* node = (RenderGraphResourceNode*)graph.GetNode(m_pDepthRT->GetToNode());
+        IGfxTexture* texture = ((RGTexture*)node->GetResource())->GetTexture();
+
+        uint32_t mip, slice;
+        DecomposeSubresource(texture->GetDesc(), m_pDepthRT->GetSubresource(), mip, slice);
+
+        //depth and stencil are tested in the pass, so their load actions are kept even if the output is not stored
+        GfxRenderPassDepthAttachment& depth = m_renderPassDesc.depth;
+        depth.texture = texture;
+        depth.mip_slice = mip;
+        depth.array_slice = slice;
+        depth.load_op = InferLoadOp(m_pDepthRT->GetDepthLoadOp(), node);
+        depth.store_op = InferStoreOp(node);
+        depth.stencil_load_op = InferLoadOp(m_pDepthRT->GetStencilLoadOp(), node);
+        depth.stencil_store_op = depth.store_op;
+        depth.clear_depth = m_pDepthRT->GetClearDepth();
+        depth.clear_stencil = m_pDepthRT->GetClearStencil();
+    }
+}
+
+void RenderGraphPassBase::ResolveSplitBarriers(const DirectedAcyclicGraph& graph, const eastl::vector<RenderGraphPassBase*>& passes)
+{
+    //begin and end of a split barrier should be in the same command list
     if (m_type == RenderPassType::AsyncCompute)
     {
-        eastl::vector<DAGEdge*> edges;
+        return;
+    }
 
-        eastl::vector<DAGEdge*> resource_incoming;
-        eastl::vector<DAGEdge*> resource_outgoing;
+    for (size_t i = 0; i < m_resourceBarriers.size(); ++i)
+    {
+        ResourceBarrier& barrier = m_resourceBarriers[i];
+        if (barrier.begin_pass == UINT32_MAX)
+        {
+            continue;
+        }
 
-        graph.GetIncomingEdges(this, edges);
-        for (size_t i = 0; i < edges.size(); ++i)
+        RenderGraphPassBase* begin_pass = (RenderGraphPassBase*)graph.GetNode(barrier.begin_pass);
+        if (begin_pass->GetType() == RenderPassType::AsyncCompute || begin_pass->m_signalValue != -1 || m_waitValue != -1)
         {
-            RenderGraphEdge* edge = (RenderGraphEdge*)edges[i];
-            RE_ASSERT(edge->GetToNode() == this->GetId());
+            continue;
+        }
 
-            RenderGraphResourceNode* resource_node = (RenderGraphResourceNode*)graph.GetNode(edge->GetFromNode());
+        //passes are in the execution order, only split if there is some work to overlap and the command list is not submitted in between
+        bool has_work = false;
+        bool submitted = false;
 
-            graph.GetIncomingEdges(resource_node, resource_incoming);
-            RE_ASSERT(resource_incoming.size() <= 1);
+        for (uint32_t j = begin_pass->m_nExecuteIndex + 1; j < m_nExecuteIndex; ++j)
+        {
+            RenderGraphPassBase* pass = passes[j];
+            if (pass->GetType() == RenderPassType::AsyncCompute)
+            {
+                continue;
+            }
 
-            if(!resource_incoming.empty())
+            if (pass->m_waitValue != -1 || pass->m_signalValue != -1)
             {
-                RenderGraphPassBase* prePass = (RenderGraphPassBase*)graph.GetNode(resource_incoming[0]->GetFromNode());
-                if (!prePass->IsCulled() && prePass->GetType() != RenderPassType::AsyncCompute)
-                {
-                    context.preGraphicsQueuePasses.push_back(prePass->GetId());
-                }
+                submitted = true;
+                break;
+            }
+
+            if (!pass->IsCulled())
+            {
+                has_work = true;
             }
         }
 
-        graph.GetOutgoingEdges(this, edges);
-        for (size_t i = 0; i < edges.size(); ++i)
+        if (has_work && !submitted)
         {
-            RenderGraphEdge* edge = (RenderGraphEdge*)edges[i];
-            RE_ASSERT(edge->GetFromNode() == this->GetId());
+            barrier.split = true;
+            begin_pass->m_endBarriers.push_back(barrier);
+        }
+    }
+}
+
+void RenderGraphPassBase::GetBarrierStats(RenderGraphBarrierStats& stats) const
+{
+    stats.transitionBarriers += (uint32_t)m_resourceBarriers.size();
 
-            RenderGraphResourceNode* resource_node = (RenderGraphResourceNode*)graph.GetNode(edge->GetToNode());
-            graph.GetOutgoingEdges(resource_node, resource_outgoing);
+    for (size_t i = 0; i < m_endBarriers.size(); ++i)
+    {
+        if (m_endBarriers[i].split)
+        {
+            stats.splitBarriers++;
+        }
+        else
+        {
+            stats.transitionBarriers++;
+        }
+    }
 
-            for (size_t i = 0; i < resource_outgoing.size(); i++)
+    for (size_t i = 0; i < m_viewBarriers.size(); ++i)
+    {
+        if (m_viewBarriers[i].old_state == m_viewBarriers[i].new_state)
+        {
+            stats.uavBarriers++;
+        }
+        else
+        {
+            stats.transitionBarriers++;
+        }
+    }
+
+    stats.uavBarriers += (uint32_t)m_uavBarriers.size();
+    stats.aliasingBarriers += (uint32_t)m_aliasBarriers.size();
+}
+
+void RenderGraphPassBase::ResolveAsyncCompute(const DirectedAcyclicGraph& graph, RenderGraphAsyncResolveContext& context)
+{
+    if (m_type == RenderPassType::AsyncCompute)
+    {
+        eastl::vector<DAGNodeID> pre_passes;
+        eastl::vector<DAGNodeID> post_passes;
+        GetQueueDependencies(graph, pre_passes, post_passes);
+
+        for (size_t i = 0; i < pre_passes.size(); ++i)
+        {
+            RenderGraphPassBase* prePass = (RenderGraphPassBase*)graph.GetNode(pre_passes[i]);
+            if (prePass->GetType() != RenderPassType::AsyncCompute)
             {
-                RenderGraphPassBase* postPass = (RenderGraphPassBase*)graph.GetNode(resource_outgoing[i]->GetToNode());
-                if (!postPass->IsCulled() && postPass->GetType() != RenderPassType::AsyncCompute)
-                {
-                    context.postGraphicsQueuePasses.push_back(postPass->GetId());
-                }
+                context.preGraphicsQueuePasses.push_back(prePass->GetId());
+            }
+        }
+
+        for (size_t i = 0; i < post_passes.size(); ++i)
+        {
+            RenderGraphPassBase* postPass = (RenderGraphPassBase*)graph.GetNode(post_passes[i]);
+            if (postPass->GetType() != RenderPassType::AsyncCompute)
+            {
+                context.postGraphicsQueuePasses.push_back(postPass->GetId());
             }
         }
 
@@ -168,9 +478,15 @@ void RenderGraphPassBase::ResolveAsyncCompute(const DirectedAcyclicGraph& graph,
     {
         if (!context.computeQueuePasses.empty())
         {
+            //the last pass to wait for and the first one to signal, in the execution order
+            auto execute_order = [&](DAGNodeID a, DAGNodeID b)
+            {
+                return ((RenderGraphPassBase*)graph.GetNode(a))->m_nExecuteIndex < ((RenderGraphPassBase*)graph.GetNode(b))->m_nExecuteIndex;
+            };
+
             if (!context.preGraphicsQueuePasses.empty())
             {
-                DAGNodeID graphicsPassToWaitID = *eastl::max_element(context.preGraphicsQueuePasses.begin(), context.preGraphicsQueuePasses.end());
+                DAGNodeID graphicsPassToWaitID = *eastl::max_element(context.preGraphicsQueuePasses.begin(), context.preGraphicsQueuePasses.end(), execute_order);
 
                 RenderGraphPassBase* graphicsPassToWait = (RenderGraphPassBase*)graph.GetNode(graphicsPassToWaitID);
                 if (graphicsPassToWait->m_signalValue == -1)
@@ -185,12 +501,13 @@ void RenderGraphPassBase::ResolveAsyncCompute(const DirectedAcyclicGraph& graph,
                 {
                     RenderGraphPassBase* computePass = (RenderGraphPassBase*)graph.GetNode(context.computeQueuePasses[i]);
                     computePass->m_waitGraphicsPass = graphicsPassToWaitID;
+                    computePass->m_nWaitGraphicsPassIndex = graphicsPassToWait->m_nExecuteIndex;
                 }
             }
 
             if (!context.postGraphicsQueuePasses.empty())
             {
-                DAGNodeID graphicsPassToSignalID = *eastl::min_element(context.postGraphicsQueuePasses.begin(), context.postGraphicsQueuePasses.end());
+                DAGNodeID graphicsPassToSignalID = *eastl::min_element(context.postGraphicsQueuePasses.begin(), context.postGraphicsQueuePasses.end(), execute_order);
 
                 RenderGraphPassBase* computePass = (RenderGraphPassBase*)graph.GetNode(context.computeQueuePasses.back());
                 if (computePass->m_signalValue == -1)
@@ -205,6 +522,7 @@ void RenderGraphPassBase::ResolveAsyncCompute(const DirectedAcyclicGraph& graph,
                 {
                     RenderGraphPassBase* computePass = (RenderGraphPassBase*)graph.GetNode(context.computeQueuePasses[i]);
                     computePass->m_signalGraphicsPass = graphicsPassToSignalID;
+                    computePass->m_nSignalGraphicsPassIndex = graphicsPassToSignal->m_nExecuteIndex;
                 }
             }            
 
@@ -215,6 +533,111 @@ void RenderGraphPassBase::ResolveAsyncCompute(const DirectedAcyclicGraph& graph,
     }
 }
 
+void RenderGraphPassBase::GetQueueDependencies(const DirectedAcyclicGraph& graph, eastl::vector<DAGNodeID>& pre_passes, eastl::vector<DAGNodeID>& post_passes) const
+{
+    pre_passes.clear();
+    post_passes.clear();
+
+    eastl::vector<DAGEdge*> edges;
+    eastl::vector<DAGEdge*> resource_incoming;
+    eastl::vector<DAGEdge*> resource_outgoing;
+
+    graph.GetIncomingEdges(this, edges);
+    for (size_t i = 0; i < edges.size(); ++i)
+    {
+        RenderGraphEdge* edge = (RenderGraphEdge*)edges[i];
+        RenderGraphResourceNode* resource_node = (RenderGraphResourceNode*)graph.GetNode(edge->GetFromNode());
+        RenderGraphResource* resource = resource_node->GetResource();
+
+        //the pass which output this version
+        graph.GetIncomingEdges(resource_node, resource_incoming);
+        if (!resource_incoming.empty() && !graph.GetNode(resource_incoming[0]->GetFromNode())->IsCulled())
+        {
+            pre_passes.push_back(resource_incoming[0]->GetFromNode());
+        }
+
+        //other passes using this version : write after read, or reads in different states which can't run in parallel
+        bool write = IsWritingResource(graph, this, resource);
+
+        graph.GetOutgoingEdges(resource_node, resource_outgoing);
+        for (size_t j = 0; j < resource_outgoing.size(); ++j)
+        {
+            RenderGraphEdge* other_edge = (RenderGraphEdge*)resource_outgoing[j];
+            const RenderGraphPassBase* other_pass = (const RenderGraphPassBase*)graph.GetNode(other_edge->GetToNode());
+
+            if (other_pass == this || other_pass->IsCulled() || !other_edge->Overlaps(edge))
+            {
+                continue;
+            }
+
+            bool other_write = IsWritingResource(graph, other_pass, resource);
+            if (other_pass->m_nExecuteIndex < m_nExecuteIndex && (write || other_write || other_edge->GetUsage() != edge->GetUsage()))
+            {
+                pre_passes.push_back(other_pass->GetId());
+            }
+            else if (other_pass->m_nExecuteIndex > m_nExecuteIndex && (other_write || other_edge->GetUsage() != edge->GetUsage()))
+            {
+                post_passes.push_back(other_pass->GetId());
+            }
+        }
+    }
+
+    graph.GetOutgoingEdges(this, edges);
+    for (size_t i = 0; i < edges.size(); ++i)
+    {
+        RenderGraphResourceNode* resource_node = (RenderGraphResourceNode*)graph.GetNode(edges[i]->GetToNode());
+
+        graph.GetOutgoingEdges(resource_node, resource_outgoing);
+        for (size_t j = 0; j < resource_outgoing.size(); ++j)
+        {
+            const DAGNode* post_pass = graph.GetNode(resource_outgoing[j]->GetToNode());
+            if (!post_pass->IsCulled())
+            {
+                post_passes.push_back(post_pass->GetId());
+            }
+        }
+    }
+}
+
+bool RenderGraphPassBase::IsAsyncComputeCompatible(const DirectedAcyclicGraph& graph) const
+{
+    eastl::vector<DAGEdge*> edges;
+    eastl::vector<DAGEdge*> resource_incoming;
+    graph.GetIncomingEdges(this, edges);
+
+    for (size_t i = 0; i < edges.size(); ++i)
+    {
+        if (!IsComputeQueueState(((RenderGraphEdge*)edges[i])->GetUsage()))
+        {
+            return false;
+        }
+
+        //without a pass outputting it, the resource may have no graphics pass to wait for, which would transition it from a graphics state
+        RenderGraphResourceNode* resource_node = (RenderGraphResourceNode*)graph.GetNode(edges[i]->GetFromNode());
+        graph.GetIncomingEdges(resource_node, resource_incoming);
+        if (resource_incoming.empty() && !IsComputeQueueState(resource_node->GetResource()->GetInitialState()))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+float RenderGraphPassBase::EstimateCost(const DirectedAcyclicGraph& graph) const
+{
+    //bytes of the resources it accesses, every resource written also has an incoming edge
+    eastl::vector<DAGEdge*> edges;
+    graph.GetIncomingEdges(this, edges);
+
+    float cost = 0.0f;
+    for (size_t i = 0; i < edges.size(); ++i)
+    {
+        RenderGraphResourceNode* resource_node = (RenderGraphResourceNode*)graph.GetNode(edges[i]->GetFromNode());
+        cost += (float)resource_node->GetResource()->GetSize();
+    }
+    return cost;
+}
+
 void RenderGraphPassBase::Execute(const RenderGraph& graph, RenderGraphPassExecuteContext& context)
 {
     IGfxCommandList* pCommandList = m_type == RenderPassType::AsyncCompute ? context.computeCommandList : context.graphicsCommandList;
@@ -239,17 +662,25 @@ void RenderGraphPassBase::Execute(const RenderGraph& graph, RenderGraphPassExecu
 
     for (size_t i = 0; i < m_eventNames.size(); ++i)
     {
-        context.graphicsCommandList->BeginEvent(m_eventNames[i]);
-        BeginMPGpuEvent(context.graphicsCommandList, m_eventNames[i]);
+        context.graphicsCommandList->BeginEvent(m_eventNames[i].c_str());
+        BeginMPGpuEvent(context.graphicsCommandList, m_eventNames[i].c_str());
     }
 
     if (!IsCulled())
     {        
-        GPU_EVENT(pCommandList, m_name);
+        GPU_EVENT(pCommandList, m_name.c_str());
 
-        Begin(graph, pCommandList);
+        Begin(pCommandList);
         ExecuteImpl(pCommandList);
         End(pCommandList);
+
+        for (size_t i = 0; i < m_endBarriers.size(); ++i)
+        {
+            const ResourceBarrier& barrier = m_endBarriers[i];
+
+            pCommandList->ResourceBarrier(barrier.resource->GetResource(), barrier.sub_resource, barrier.old_state, barrier.new_state,
+                barrier.split ? GfxBarrierFlag::BeginOnly : GfxBarrierFlag::None);
+        }
     }
 
     for (uint32_t i = 0; i < m_nEndEventNum; ++i)
@@ -278,7 +709,7 @@ void RenderGraphPassBase::Execute(const RenderGraph& graph, RenderGraphPassExecu
     }
 }
 
-void RenderGraphPassBase::Begin(const RenderGraph& graph, IGfxCommandList* pCommandList)
+void RenderGraphPassBase::Begin(IGfxCommandList* pCommandList)
 {
     for (size_t i = 0; i < m_aliasBarriers.size(); ++i)
     {
@@ -289,52 +720,18 @@ void RenderGraphPassBase::Begin(const RenderGraph& graph, IGfxCommandList* pComm
     {
         const ResourceBarrier& barrier = m_resourceBarriers[i];
 
-        pCommandList->ResourceBarrier(barrier.resource->GetResource(), barrier.sub_resource, barrier.old_state, barrier.new_state);
+        pCommandList->ResourceBarrier(barrier.resource->GetResource(), barrier.sub_resource, barrier.old_state, barrier.new_state,
+            barrier.split ? GfxBarrierFlag::EndOnly : GfxBarrierFlag::None);
     }
 
-    if (HasGfxRenderPass())
+    for (size_t i = 0; i < m_uavBarriers.size(); ++i)
     {
-        GfxRenderPassDesc desc;
-
-        for (int i = 0; i < 8; ++i)
-        {
-            if (m_pColorRT[i] != nullptr)
-            {
-                RenderGraphResourceNode* node = (RenderGraphResourceNode*)graph.GetDAG().GetNode(m_pColorRT[i]->GetToNode());
-                IGfxTexture* texture = ((RGTexture*)node->GetResource())->GetTexture();
-
-                uint32_t mip, slice;
-                DecomposeSubresource(texture->GetDesc(), m_pColorRT[i]->GetSubresource(), mip, slice);
-
-                desc.color[i].texture = texture;
-                desc.color[i].mip_slice = mip;
-                desc.color[i].array_slice = slice;
-                desc.color[i].load_op = m_pColorRT[i]->GetLoadOp();
-                desc.color[i].store_op = node->IsCulled() ? GfxRenderPassStoreOp::DontCare : GfxRenderPassStoreOp::Store;
-                memcpy(desc.color[i].clear_color, m_pColorRT[i]->GetClearColor(), sizeof(float) * 4);
-            }
-        }
-
-        if (m_pDepthRT != nullptr)
-        {
-            RenderGraphResourceNode* node = (RenderGraphResourceNode*)graph.GetDAG().GetNode(m_pDepthRT->GetToNode());
-            IGfxTexture* texture = ((RGTexture*)node->GetResource())->GetTexture();
-
-            uint32_t mip, slice;
-            DecomposeSubresource(texture->GetDesc(), m_pDepthRT->GetSubresource(), mip, slice);
-
-            desc.depth.texture = ((RGTexture*)node->GetResource())->GetTexture();
-            desc.depth.load_op = m_pDepthRT->GetDepthLoadOp();
-            desc.depth.mip_slice = mip;
-            desc.depth.array_slice = slice;
-            desc.depth.store_op = node->IsCulled() ? GfxRenderPassStoreOp::DontCare : GfxRenderPassStoreOp::Store;
-            desc.depth.stencil_load_op = m_pDepthRT->GetStencilLoadOp();
-            desc.depth.stencil_store_op = node->IsCulled() ? GfxRenderPassStoreOp::DontCare : GfxRenderPassStoreOp::Store;
-            desc.depth.clear_depth = m_pDepthRT->GetClearDepth();
-            desc.depth.clear_stencil = m_pDepthRT->GetClearStencil();
-        }
+        pCommandList->UavBarrier(m_uavBarriers[i]->GetResource());
+    }
 
-        pCommandList->BeginRenderPass(desc);
+    if (HasGfxRenderPass())
+    {
+        pCommandList->BeginRenderPass(m_renderPassDesc);
     }
 }
 
@@ -346,6 +743,31 @@ void RenderGraphPassBase::End(IGfxCommandList* pCommandList)
     }
 }
 
+void RenderGraphPassBase::BeginView(IGfxCommandList* pCommandList, uint32_t view)
+{
+    RenderGraphResource* uav_resource = nullptr;
+
+    for (size_t i = 0; i < m_viewBarriers.size(); ++i)
+    {
+        const ViewBarrier& barrier = m_viewBarriers[i];
+        if (barrier.view != view)
+        {
+            continue;
+        }
+
+        if (barrier.old_state != barrier.new_state)
+        {
+            pCommandList->ResourceBarrier(barrier.resource->GetResource(), barrier.sub_resource, barrier.old_state, barrier.new_state);
+        }
+        else if (barrier.resource != uav_resource)
+        {
+            //uav barriers are for the whole resource, the subresources of a view need only one
+            pCommandList->UavBarrier(barrier.resource->GetResource());
+            uav_resource = barrier.resource;
+        }
+    }
+}
+
 bool RenderGraphPassBase::HasGfxRenderPass() const
 {
     for (int i = 0; i < 8; i++)
@@ -1,12 +1,16 @@
 #pragma once
 
 #include "directed_acyclic_graph.h"
+#include "render_graph_name.h"
 #include "gfx/gfx.h"
+#include "utils/assert.h"
 #include "EASTL/functional.h"
+#include "EASTL/fixed_vector.h"
 
 class Renderer;
 class RenderGraph;
 class RenderGraphResource;
+class RenderGraphEdge;
 class RenderGraphEdgeColorAttchment;
 class RenderGraphEdgeDepthAttchment;
 
@@ -28,6 +32,14 @@ struct RenderGraphAsyncResolveContext
     uint64_t graphicsFence = 0;
 };
 
+struct RenderGraphBarrierStats
+{
+    uint32_t transitionBarriers = 0;
+    uint32_t splitBarriers = 0;
+    uint32_t uavBarriers = 0;
+    uint32_t aliasingBarriers = 0;
+};
+
 struct RenderGraphPassExecuteContext
 {
     Renderer* renderer;
@@ -46,35 +58,71 @@ struct RenderGraphPassExecuteContext
 class RenderGraphPassBase : public DAGNode
 {
 public:
-    RenderGraphPassBase(const eastl::string& name, RenderPassType type, DirectedAcyclicGraph& graph);
+    RenderGraphPassBase(const RGName& name, RenderPassType type, DirectedAcyclicGraph& graph);
+    RenderGraphPassBase(const RGName& name, RenderPassType type); //recorded by a setup task, added to the graph when it is merged
 
     void ResolveBarriers(const DirectedAcyclicGraph& graph);
+    void ResolveSplitBarriers(const DirectedAcyclicGraph& graph, const eastl::vector<RenderGraphPassBase*>& passes);
     void ResolveAsyncCompute(const DirectedAcyclicGraph& graph, RenderGraphAsyncResolveContext& context);
+    void GetQueueDependencies(const DirectedAcyclicGraph& graph, eastl::vector<DAGNodeID>& pre_passes, eastl::vector<DAGNodeID>& post_passes) const;
+    bool IsAsyncComputeCompatible(const DirectedAcyclicGraph& graph) const;
+    float EstimateCost(const DirectedAcyclicGraph& graph) const;
     void Execute(const RenderGraph& graph, RenderGraphPassExecuteContext& context);
 
+    const char* GetName() const { return m_name.c_str(); }
     virtual eastl::string GetGraphvizName() const override { return m_name.c_str(); }
     virtual const char* GetGraphvizColor() const { return !IsCulled() ? "darkgoldenrod1" : "darkgoldenrod4"; }
 
-    void BeginEvent(const eastl::string& name) { m_eventNames.push_back(name); }
+    void BeginEvent(const RGName& name) { m_eventNames.push_back(name); }
     void EndEvent() { m_nEndEventNum++; }
+    void ClearEvents() { m_eventNames.clear(); m_nEndEventNum = 0; }
+    const eastl::fixed_vector<RGName, 4>& GetEventNames() const { return m_eventNames; }
+    uint32_t GetEndEventNum() const { return m_nEndEventNum; }
 
     RenderPassType GetType() const { return m_type; }
+    uint32_t GetViewCount() const { return m_nViewCount; }
+    uint32_t GetExecuteIndex() const { return m_nExecuteIndex; }
+    void SetExecuteIndex(uint32_t index) { m_nExecuteIndex = index; }
+    void MoveToAsyncCompute() { RE_ASSERT(m_type == RenderPassType::Compute); m_type = RenderPassType::AsyncCompute; }
+    void MoveToGraphicsQueue() { RE_ASSERT(m_type == RenderPassType::AsyncCompute); m_type = RenderPassType::Compute; }
+    //only compute passes which access no resources outside of the graph may be moved to the async compute queue by RenderGraph::Compile
+    void AllowAsyncCompute() { RE_ASSERT(m_type == RenderPassType::Compute); m_bAsyncComputeAllowed = true; }
+    bool IsAsyncComputeAllowed() const { return m_bAsyncComputeAllowed; }
     DAGNodeID GetWaitGraphicsPassID() const { return m_waitGraphicsPass; }
     DAGNodeID GetSignalGraphicsPassID() const { return m_signalGraphicsPass; }
+    uint32_t GetWaitGraphicsPassIndex() const { return m_nWaitGraphicsPassIndex; }
+    uint32_t GetSignalGraphicsPassIndex() const { return m_nSignalGraphicsPassIndex; }
+
+    void GetBarrierStats(RenderGraphBarrierStats& stats) const;
+
+    //state of the subresource after the pass, a multi-view pass may transition what its views wrote for the later views
+    GfxResourceState GetFinalState(const DirectedAcyclicGraph& graph, const RenderGraphEdge* edge, uint32_t subresource) const;
+
+    //attachments with the load/store actions inferred in RenderGraph::Compile
+    bool HasGfxRenderPass() const;
+    const GfxRenderPassDesc& GetRenderPassDesc() const { return m_renderPassDesc; }
 
 private:
-    void Begin(const RenderGraph& graph, IGfxCommandList* pCommandList);
+    void Begin(IGfxCommandList* pCommandList);
     void End(IGfxCommandList* pCommandList);
 
-    bool HasGfxRenderPass() const;
+    void ResolveRenderPass(const DirectedAcyclicGraph& graph);
+    bool HasAliasBarrier(RenderGraphResource* resource) const;
+    GfxResourceState GetPrevViewState(const DirectedAcyclicGraph& graph, const eastl::vector<DAGEdge*>& edges, const RenderGraphEdge* edge, uint32_t subresource, uint32_t view) const;
 
     virtual void ExecuteImpl(IGfxCommandList* pCommandList) = 0;
 
 protected:
-    eastl::string m_name;
+    void BeginView(IGfxCommandList* pCommandList, uint32_t view);
+
+protected:
+    RGName m_name;
     RenderPassType m_type;
+    uint32_t m_nViewCount = 1;
+    uint32_t m_nExecuteIndex = 0; //position in the execution order, passes may be reordered in RenderGraph::Compile
+    bool m_bAsyncComputeAllowed = false;
 
-    eastl::vector<eastl::string> m_eventNames;
+    eastl::fixed_vector<RGName, 4> m_eventNames;
     uint32_t m_nEndEventNum = 0;
 
     struct ResourceBarrier
@@ -83,8 +131,22 @@ protected:
         uint32_t sub_resource;
         GfxResourceState old_state;
         GfxResourceState new_state;
+        DAGNodeID begin_pass; //the pass which left the resource in old_state
+        bool split;
     };
     eastl::vector<ResourceBarrier> m_resourceBarriers;
+    eastl::vector<ResourceBarrier> m_endBarriers; //barriers for the later passes issued after this pass, begin-only if split
+    eastl::vector<RenderGraphResource*> m_uavBarriers;
+
+    struct ViewBarrier
+    {
+        RenderGraphResource* resource;
+        uint32_t sub_resource;
+        GfxResourceState old_state;
+        GfxResourceState new_state; //same as old_state for a uav barrier
+        uint32_t view; //issued before the view
+    };
+    eastl::vector<ViewBarrier> m_viewBarriers; //transitions between the views of a multi-view pass
 
     struct AliasBarrier
     {
@@ -95,10 +157,13 @@ protected:
 
     RenderGraphEdgeColorAttchment* m_pColorRT[8] = {};
     RenderGraphEdgeDepthAttchment* m_pDepthRT = nullptr;
+    GfxRenderPassDesc m_renderPassDesc;
 
     //only for async-compute pass
     DAGNodeID m_waitGraphicsPass = UINT32_MAX;
     DAGNodeID m_signalGraphicsPass = UINT32_MAX;
+    uint32_t m_nWaitGraphicsPassIndex = UINT32_MAX;
+    uint32_t m_nSignalGraphicsPassIndex = UINT32_MAX;
 
     uint64_t m_signalValue = -1;
     uint64_t m_waitValue = -1;
@@ -108,12 +173,18 @@ template<class T>
 class RenderGraphPass : public RenderGraphPassBase
 {
 public:
-    RenderGraphPass(const eastl::string& name, RenderPassType type, DirectedAcyclicGraph& graph, const eastl::function<void(const T&, IGfxCommandList*)>& execute) :
+    RenderGraphPass(const RGName& name, RenderPassType type, DirectedAcyclicGraph& graph, const eastl::function<void(const T&, IGfxCommandList*)>& execute) :
         RenderGraphPassBase(name, type, graph)
     {
         m_execute = execute;
     }
 
+    RenderGraphPass(const RGName& name, RenderPassType type, const eastl::function<void(const T&, IGfxCommandList*)>& execute) :
+        RenderGraphPassBase(name, type)
+    {
+        m_execute = execute;
+    }
+
     T& GetData() { return m_parameters; }
     T const* operator->() { return &GetData(); }
 
@@ -128,3 +199,44 @@ protected:
     eastl::function<void(const T&, IGfxCommandList*)> m_execute;
 };
 
+//a pass executed once for each view, e.g. the mips of a downsampling chain.
+//it is one node in the graph, the subresources of the views are declared with RGBuilder::ReadViews/WriteViews.
+//graphics passes are not supported : the views would share one render pass, and barriers can't be issued inside it
+template<class T>
+class RenderGraphMultiViewPass : public RenderGraphPassBase
+{
+public:
+    RenderGraphMultiViewPass(const RGName& name, RenderPassType type, uint32_t view_count, DirectedAcyclicGraph& graph, const eastl::function<void(const T&, uint32_t, IGfxCommandList*)>& execute) :
+        RenderGraphPassBase(name, type, graph)
+    {
+        RE_ASSERT(view_count > 0 && type != RenderPassType::Graphics);
+        m_nViewCount = view_count;
+        m_execute = execute;
+    }
+
+    RenderGraphMultiViewPass(const RGName& name, RenderPassType type, uint32_t view_count, const eastl::function<void(const T&, uint32_t, IGfxCommandList*)>& execute) :
+        RenderGraphPassBase(name, type)
+    {
+        RE_ASSERT(view_count > 0 && type != RenderPassType::Graphics);
+        m_nViewCount = view_count;
+        m_execute = execute;
+    }
+
+    T& GetData() { return m_parameters; }
+    T const* operator->() { return &GetData(); }
+
+private:
+    void ExecuteImpl(IGfxCommandList* pCommandList) override
+    {
+        for (uint32_t i = 0; i < m_nViewCount; ++i)
+        {
+            BeginView(pCommandList, i);
+            m_execute(m_parameters, i, pCommandList);
+        }
+    }
+
+protected:
+    T m_parameters;
+    eastl::function<void(const T&, uint32_t, IGfxCommandList*)> m_execute;
+};
+
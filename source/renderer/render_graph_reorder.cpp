@@ -0,0 +1,310 @@
+#include "render_graph_reorder.h"
+#include "utils/assert.h"
+#include "EASTL/algorithm.h"
+
+void RGPassReorderer::Reorder(const eastl::vector<RGReorderPass>& passes, const eastl::vector<uint64_t>& resource_sizes, RGReorderResult& result)
+{
+    uint32_t pass_count = (uint32_t)passes.size();
+
+    result.order.resize(pass_count);
+    for (uint32_t i = 0; i < pass_count; ++i)
+    {
+        result.order[i] = i;
+    }
+
+    result.events.clear();
+    result.peakBytesBefore = GetPeakBytes(passes, resource_sizes, result.order);
+    result.peakBytesAfter = result.peakBytesBefore;
+
+    //unbalanced events, keep the declaration order
+    if (pass_count == 0 || !BuildUnits(passes))
+    {
+        return;
+    }
+
+    m_remainingUsers.clear();
+    m_remainingUsers.resize(resource_sizes.size(), 0);
+    m_allocated.clear();
+    m_allocated.resize(resource_sizes.size(), false);
+    m_unitUsers.clear();
+    m_unitUsers.resize(resource_sizes.size(), 0);
+
+    for (uint32_t i = 0; i < pass_count; ++i)
+    {
+        for (size_t j = 0; j < passes[i].resources.size(); ++j)
+        {
+            m_remainingUsers[passes[i].resources[j]]++;
+        }
+    }
+
+    eastl::vector<uint32_t> order;
+    order.reserve(pass_count);
+    ScheduleUnit(passes, resource_sizes, 0, order);
+    RE_ASSERT(order.size() == pass_count);
+
+    //the greedy order is not always better
+    uint64_t peak_bytes = GetPeakBytes(passes, resource_sizes, order);
+    if (peak_bytes >= result.peakBytesBefore)
+    {
+        return;
+    }
+
+    result.order = order;
+    result.peakBytesAfter = peak_bytes;
+
+    //events are attached to passes, so they are moved to the new first and last passes of their scopes
+    eastl::vector<uint32_t> position(pass_count);
+    for (uint32_t i = 0; i < pass_count; ++i)
+    {
+        position[order[i]] = i;
+    }
+
+    for (size_t i = 0; i < m_units.size(); ++i)
+    {
+        const Unit& unit = m_units[i];
+        if (unit.event == UINT32_MAX)
+        {
+            continue;
+        }
+
+        uint32_t first = UINT32_MAX;
+        uint32_t last = 0;
+        for (uint32_t pass = unit.begin; pass < unit.end; ++pass)
+        {
+            first = eastl::min(first, position[pass]);
+            last = eastl::max(last, position[pass]);
+        }
+
+        result.events.push_back({ unit.begin, unit.event, order[first], order[last] });
+    }
+}
+
+uint64_t RGPassReorderer::GetPeakBytes(const eastl::vector<RGReorderPass>& passes, const eastl::vector<uint64_t>& resource_sizes, const eastl::vector<uint32_t>& order)
+{
+    eastl::vector<uint32_t> first_use(resource_sizes.size(), UINT32_MAX);
+    eastl::vector<uint32_t> last_use(resource_sizes.size(), 0);
+
+    for (uint32_t i = 0; i < (uint32_t)order.size(); ++i)
+    {
+        const RGReorderPass& pass = passes[order[i]];
+
+        for (size_t j = 0; j < pass.resources.size(); ++j)
+        {
+            uint32_t resource = pass.resources[j];
+            first_use[resource] = eastl::min(first_use[resource], i);
+            last_use[resource] = eastl::max(last_use[resource], i);
+        }
+    }
+
+    eastl::vector<int64_t> delta(order.size() + 1, 0);
+    for (size_t i = 0; i < resource_sizes.size(); ++i)
+    {
+        if (first_use[i] != UINT32_MAX)
+        {
+            delta[first_use[i]] += (int64_t)resource_sizes[i];
+            delta[last_use[i] + 1] -= (int64_t)resource_sizes[i];
+        }
+    }
+
+    int64_t live_bytes = 0;
+    int64_t peak_bytes = 0;
+    for (size_t i = 0; i < order.size(); ++i)
+    {
+        live_bytes += delta[i];
+        peak_bytes = eastl::max(peak_bytes, live_bytes);
+    }
+
+    return (uint64_t)peak_bytes;
+}
+
+bool RGPassReorderer::BuildUnits(const eastl::vector<RGReorderPass>& passes)
+{
+    uint32_t pass_count = (uint32_t)passes.size();
+
+    m_units.clear();
+    m_units.push_back({ 0, pass_count, false, UINT32_MAX });
+
+    eastl::vector<uint32_t> scopes;
+    scopes.push_back(0);
+
+    for (uint32_t i = 0; i < pass_count; ++i)
+    {
+        const RGReorderPass& pass = passes[i];
+
+        for (uint32_t j = 0; j < pass.beginEvents; ++j)
+        {
+            uint32_t scope = (uint32_t)m_units.size();
+            m_units.push_back({ i, i, false, j });
+            m_units[scopes.back()].children.push_back(scope);
+            scopes.push_back(scope);
+        }
+
+        //consecutive async compute passes share one fence pair, so they are not separated
+        eastl::vector<uint32_t>& siblings = m_units[scopes.back()].children;
+        if (pass.asyncCompute && !siblings.empty() && m_units[siblings.back()].asyncCompute && m_units[siblings.back()].end == i)
+        {
+            m_units[siblings.back()].end = i + 1;
+        }
+        else
+        {
+            uint32_t unit = (uint32_t)m_units.size();
+            m_units.push_back({ i, i + 1, pass.asyncCompute, UINT32_MAX });
+            m_units[scopes.back()].children.push_back(unit);
+        }
+
+        for (uint32_t j = 0; j < pass.endEvents; ++j)
+        {
+            if (scopes.size() <= 1)
+            {
+                return false;
+            }
+
+            m_units[scopes.back()].end = i + 1;
+            scopes.pop_back();
+        }
+    }
+
+    return scopes.size() == 1;
+}
+
+void RGPassReorderer::ScheduleUnit(const eastl::vector<RGReorderPass>& passes, const eastl::vector<uint64_t>& resource_sizes, uint32_t unit, eastl::vector<uint32_t>& order)
+{
+    if (m_units[unit].children.empty())
+    {
+        for (uint32_t i = m_units[unit].begin; i < m_units[unit].end; ++i)
+        {
+            order.push_back(i);
+
+            for (size_t j = 0; j < passes[i].resources.size(); ++j)
+            {
+                uint32_t resource = passes[i].resources[j];
+                m_remainingUsers[resource]--;
+                m_allocated[resource] = true;
+            }
+        }
+        return;
+    }
+
+    const eastl::vector<uint32_t>& children = m_units[unit].children;
+    uint32_t child_count = (uint32_t)children.size();
+
+    m_owner.resize(passes.size());
+    for (uint32_t i = 0; i < child_count; ++i)
+    {
+        for (uint32_t pass = m_units[children[i]].begin; pass < m_units[children[i]].end; ++pass)
+        {
+            m_owner[pass] = i;
+        }
+    }
+
+    //m_owner is reused by the children, so the dependencies are collected before scheduling them.
+    //dependencies outside of this unit are already scheduled by the parent
+    eastl::vector<eastl::vector<uint32_t>> dependents(child_count);
+    eastl::vector<uint32_t> dependency_count(child_count, 0);
+
+    for (uint32_t i = 0; i < child_count; ++i)
+    {
+        for (uint32_t pass = m_units[children[i]].begin; pass < m_units[children[i]].end; ++pass)
+        {
+            for (size_t j = 0; j < passes[pass].dependencies.size(); ++j)
+            {
+                uint32_t dependency = passes[pass].dependencies[j];
+                if (dependency < m_units[unit].begin || dependency >= m_units[unit].end || m_owner[dependency] == i)
+                {
+                    continue;
+                }
+
+                uint32_t owner = m_owner[dependency];
+                RE_ASSERT(owner < i);
+
+                if (eastl::find(dependents[owner].begin(), dependents[owner].end(), i) == dependents[owner].end())
+                {
+                    dependents[owner].push_back(i);
+                    dependency_count[i]++;
+                }
+            }
+        }
+    }
+
+    eastl::vector<uint32_t> ready;
+    for (uint32_t i = 0; i < child_count; ++i)
+    {
+        if (dependency_count[i] == 0)
+        {
+            ready.push_back(i);
+        }
+    }
+
+    for (uint32_t scheduled = 0; scheduled < child_count; ++scheduled)
+    {
+        RE_ASSERT(!ready.empty());
+
+        //the unit which frees the most memory, the declaration order is kept for ties
+        size_t best = 0;
+        int64_t best_delta = GetMemoryDelta(passes, resource_sizes, m_units[children[ready[0]]]);
+
+        for (size_t i = 1; i < ready.size(); ++i)
+        {
+            int64_t delta = GetMemoryDelta(passes, resource_sizes, m_units[children[ready[i]]]);
+            if (delta < best_delta || (delta == best_delta && ready[i] < ready[best]))
+            {
+                best = i;
+                best_delta = delta;
+            }
+        }
+
+        uint32_t child = ready[best];
+        ready.erase(ready.begin() + best);
+
+        ScheduleUnit(passes, resource_sizes, children[child], order);
+
+        for (size_t i = 0; i < dependents[child].size(); ++i)
+        {
+            uint32_t dependent = dependents[child][i];
+            if (--dependency_count[dependent] == 0)
+            {
+                ready.push_back(dependent);
+            }
+        }
+    }
+}
+
+int64_t RGPassReorderer::GetMemoryDelta(const eastl::vector<RGReorderPass>& passes, const eastl::vector<uint64_t>& resource_sizes, const Unit& unit)
+{
+    //bytes allocated by the unit, minus bytes of the resources which are not used after it
+    int64_t delta = 0;
+
+    for (uint32_t pass = unit.begin; pass < unit.end; ++pass)
+    {
+        for (size_t i = 0; i < passes[pass].resources.size(); ++i)
+        {
+            m_unitUsers[passes[pass].resources[i]]++;
+        }
+    }
+
+    for (uint32_t pass = unit.begin; pass < unit.end; ++pass)
+    {
+        for (size_t i = 0; i < passes[pass].resources.size(); ++i)
+        {
+            uint32_t resource = passes[pass].resources[i];
+            if (m_unitUsers[resource] == 0)
+            {
+                continue; //already counted
+            }
+
+            if (!m_allocated[resource])
+            {
+                delta += (int64_t)resource_sizes[resource];
+            }
+
+            if (m_remainingUsers[resource] == m_unitUsers[resource])
+            {
+                delta -= (int64_t)resource_sizes[resource];
+            }
+
+            m_unitUsers[resource] = 0;
+        }
+    }
+
+    return delta;
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "EASTL/vector.h"
+
+//a pass of the reorderer input, passes are in the declaration order and culled passes are included
+struct RGReorderPass
+{
+    uint32_t beginEvents = 0;  //events opened before the pass
+    uint32_t endEvents = 0;    //events closed after the pass
+    bool asyncCompute = false;
+
+    eastl::vector<uint32_t> dependencies; //indices of the passes it should run after
+    eastl::vector<uint32_t> resources;    //indices of the transient resources it accesses
+};
+
+//an event scope after reordering, its first and last passes may change
+struct RGReorderEvent
+{
+    uint32_t pass;      //the pass which opened the event, and the index in its events
+    uint32_t index;
+    uint32_t firstPass; //the passes which should open and close the event now
+    uint32_t lastPass;
+};
+
+struct RGReorderResult
+{
+    eastl::vector<uint32_t> order;        //pass indices in the execution order
+    eastl::vector<RGReorderEvent> events; //outer events first, empty if the order is not changed
+    uint64_t peakBytesBefore = 0;         //peak of the live transient resources, in the declaration order
+    uint64_t peakBytesAfter = 0;
+};
+
+//picks a topological order of the passes which lowers the peak transient memory,
+//event scopes and runs of async compute passes are moved as a whole
+class RGPassReorderer
+{
+public:
+    void Reorder(const eastl::vector<RGReorderPass>& passes, const eastl::vector<uint64_t>& resource_sizes, RGReorderResult& result);
+
+    static uint64_t GetPeakBytes(const eastl::vector<RGReorderPass>& passes, const eastl::vector<uint64_t>& resource_sizes, const eastl::vector<uint32_t>& order);
+
+private:
+    struct Unit
+    {
+        uint32_t begin;                  //range of the passes in the declaration order
+        uint32_t end;
+        bool asyncCompute;
+        uint32_t event;                   //index in the events of the first pass, UINT32_MAX if it is not an event scope
+        eastl::vector<uint32_t> children; //empty if the passes are kept in the declaration order
+    };
+
+    bool BuildUnits(const eastl::vector<RGReorderPass>& passes);
+    void ScheduleUnit(const eastl::vector<RGReorderPass>& passes, const eastl::vector<uint64_t>& resource_sizes, uint32_t unit, eastl::vector<uint32_t>& order);
+    int64_t GetMemoryDelta(const eastl::vector<RGReorderPass>& passes, const eastl::vector<uint64_t>& resource_sizes, const Unit& unit);
+
+private:
+    eastl::vector<Unit> m_units;
+    eastl::vector<uint32_t> m_owner;
+
+    eastl::vector<uint32_t> m_remainingUsers;
+    eastl::vector<bool> m_allocated;
+    eastl::vector<uint32_t> m_unitUsers;
+};
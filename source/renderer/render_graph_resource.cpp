@@ -3,23 +3,25 @@
 
 void RenderGraphResource::Resolve(RenderGraphEdge* edge, RenderGraphPassBase* pass)
 {
-    if (pass->GetId() >= m_lastPass)
+    //lifetime is in the execution order, which may differ from the pass ids if the passes are reordered
+    uint32_t index = pass->GetExecuteIndex();
+    if (index >= m_lastPass)
     {
         m_lastState = edge->GetUsage();
     }
 
-    m_firstPass = eastl::min(m_firstPass, pass->GetId());
-    m_lastPass = eastl::max(m_lastPass, pass->GetId());
+    m_firstPass = eastl::min(m_firstPass, index);
+    m_lastPass = eastl::max(m_lastPass, index);
 
     //for resources used in async compute, we should extend its lifetime range
     if (pass->GetType() == RenderPassType::AsyncCompute)
     {
-        m_firstPass = eastl::min(m_firstPass, pass->GetWaitGraphicsPassID());
-        m_lastPass = eastl::max(m_lastPass, pass->GetSignalGraphicsPassID());
+        m_firstPass = eastl::min(m_firstPass, pass->GetWaitGraphicsPassIndex());
+        m_lastPass = eastl::max(m_lastPass, pass->GetSignalGraphicsPassIndex());
     }
 }
 
-RGTexture::RGTexture(RenderGraphResourceAllocator& allocator, const eastl::string& name, const Desc& desc) :
+RGTexture::RGTexture(RenderGraphResourceAllocator& allocator, const RGName& name, const Desc& desc) :
     RenderGraphResource(name),
     m_allocator(allocator)
 {
@@ -36,9 +38,25 @@ RGTexture::RGTexture(RenderGraphResourceAllocator& allocator, IGfxTexture* textu
     m_bImported = true;
 }
 
+RGTexture::RGTexture(RenderGraphResourceAllocator& allocator, const RGName& name, const Desc& desc, bool prev_frame) :
+    RenderGraphResource(prev_frame ? RGName::Format("{} (prev)", name.c_str()) : name),
+    m_allocator(allocator)
+{
+    //history textures are persistent, so they are allocated right away and can be used even when they are not realized
+    m_pTexture = allocator.AllocateHistoryTexture(desc, name, prev_frame, m_initialState);
+    m_desc = m_pTexture->GetDesc();
+    m_historyName = name;
+    m_bHistory = true;
+    m_bPrevHistory = prev_frame;
+}
+
 RGTexture::~RGTexture()
 {
-    if (!m_bImported)
+    if (m_bHistory)
+    {
+        m_allocator.FreeHistoryTexture(m_pTexture, m_lastState, IsUsed());
+    }
+    else if (!m_bImported)
     {
         if (m_bOutput)
         {
@@ -57,6 +75,16 @@ IGfxDescriptor* RGTexture::GetSRV()
     return m_allocator.GetDescriptor(m_pTexture, GfxShaderResourceViewDesc());
 }
 
+IGfxDescriptor* RGTexture::GetSRV(uint32_t mip, uint32_t slice)
+{
+    RE_ASSERT(!IsImported());
+    GfxShaderResourceViewDesc desc;
+    desc.texture.mip_slice = mip;
+    desc.texture.mip_levels = 1;
+    desc.texture.array_slice = slice;
+    return m_allocator.GetDescriptor(m_pTexture, desc);
+}
+
 IGfxDescriptor* RGTexture::GetUAV()
 {
     RE_ASSERT(!IsImported()); 
@@ -96,25 +124,33 @@ void RGTexture::Resolve(RenderGraphEdge* edge, RenderGraphPassBase* pass)
 
 void RGTexture::Realize()
 {
-    if (!m_bImported)
+    if (!m_bImported && !m_bHistory)
     {
         if (m_bOutput)
         {
-            m_pTexture = m_allocator.AllocateNonOverlappingTexture(m_desc, m_name, m_initialState);
+            m_pTexture = m_allocator.AllocateNonOverlappingTexture(m_desc, m_name.c_str(), m_initialState);
         }
         else
         {
-            m_pTexture = m_allocator.AllocateTexture(m_firstPass, m_lastPass, m_desc, m_name, m_initialState);
+            m_pTexture = m_allocator.AllocateTexture(m_firstPass, m_lastPass, m_desc, m_name.c_str(), m_initialState);
         }
     }
 }
 
+uint64_t RGTexture::GetSize() const
+{
+    uint32_t block_height = GetFormatBlockHeight(m_desc.format);
+    uint32_t row_count = (m_desc.height + block_height - 1) / block_height;
+
+    return (uint64_t)GetFormatRowPitch(m_desc.format, m_desc.width) * row_count * m_desc.depth * m_desc.array_size;
+}
+
 IGfxResource* RGTexture::GetAliasedPrevResource()
 {
     return m_allocator.GetAliasedPrevResource(m_pTexture, m_firstPass);
 }
 
-RGBuffer::RGBuffer(RenderGraphResourceAllocator& allocator, const eastl::string& name, const Desc& desc) :
+RGBuffer::RGBuffer(RenderGraphResourceAllocator& allocator, const RGName& name, const Desc& desc) :
     RenderGraphResource(name),
     m_allocator(allocator)
 {
@@ -207,7 +243,7 @@ void RGBuffer::Realize()
 {
     if (!m_bImported)
     {
-        m_pBuffer = m_allocator.AllocateBuffer(m_firstPass, m_lastPass, m_desc, m_name, m_initialState);
+        m_pBuffer = m_allocator.AllocateBuffer(m_firstPass, m_lastPass, m_desc, m_name.c_str(), m_initialState);
     }
 }
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "directed_acyclic_graph.h"
+#include "render_graph_name.h"
 #include "gfx/gfx.h"
 #include "utils/assert.h"
 
@@ -11,7 +12,7 @@ class RenderGraphResourceAllocator;
 class RenderGraphResource
 {
 public:
-    RenderGraphResource(const eastl::string& name)
+    RenderGraphResource(const RGName& name)
     {
         m_name = name;
     }
@@ -21,13 +22,17 @@ public:
     virtual void Realize() = 0;
     virtual IGfxResource* GetResource() = 0;
     virtual GfxResourceState GetInitialState() = 0;
+    virtual uint64_t GetSize() const = 0; //estimated, used for scheduling
 
     const char* GetName() const { return m_name.c_str(); }
-    DAGNodeID GetFirstPassID() const { return m_firstPass; }
-    DAGNodeID GetLastPassID() const { return m_lastPass; }
+    uint32_t GetFirstPassIndex() const { return m_firstPass; } //execute index of the pass
+    uint32_t GetLastPassIndex() const { return m_lastPass; }
 
     bool IsUsed() const { return m_firstPass != UINT32_MAX; }
     bool IsImported() const { return m_bImported; }
+    bool IsHistory() const { return m_bHistory; }
+    bool IsPrevHistory() const { return m_bPrevHistory; }
+    bool HasInitialContents() const { return m_bImported || m_bPrevHistory; } //the first version is not undefined
 
     GfxResourceState GetFinalState() const { return m_lastState; }
     void SetFinalState(GfxResourceState state) { m_lastState = state; }
@@ -35,19 +40,21 @@ public:
     bool IsOutput() const { return m_bOutput; }
     void SetOutput(bool value) { m_bOutput = value; }
 
-    bool IsOverlapping() const { return !IsImported() && !IsOutput(); }
+    bool IsOverlapping() const { return !IsImported() && !IsOutput() && !IsHistory(); }
 
     virtual IGfxResource* GetAliasedPrevResource() = 0;
 
 protected:
-    eastl::string m_name;
+    RGName m_name;
 
-    DAGNodeID m_firstPass = UINT32_MAX;
-    DAGNodeID m_lastPass = 0;
+    uint32_t m_firstPass = UINT32_MAX;
+    uint32_t m_lastPass = 0;
     GfxResourceState m_lastState = GfxResourceState::Common;
 
     bool m_bImported = false;
     bool m_bOutput = false;
+    bool m_bHistory = false;
+    bool m_bPrevHistory = false;
 };
 
 class RGTexture : public RenderGraphResource
@@ -55,12 +62,16 @@ class RGTexture : public RenderGraphResource
 public:
     using Desc = GfxTextureDesc;
 
-    RGTexture(RenderGraphResourceAllocator& allocator, const eastl::string& name, const Desc& desc);
+    RGTexture(RenderGraphResourceAllocator& allocator, const RGName& name, const Desc& desc);
     RGTexture(RenderGraphResourceAllocator& allocator, IGfxTexture* texture, GfxResourceState state);
+    RGTexture(RenderGraphResourceAllocator& allocator, const RGName& name, const Desc& desc, bool prev_frame); //history texture
     ~RGTexture();
 
     IGfxTexture* GetTexture() const { return m_pTexture; }
+    const Desc& GetDesc() const { return m_desc; }
+    const RGName& GetHistoryName() const { return m_historyName; } //name passed to CreateHistory/ImportPrevHistory
     IGfxDescriptor* GetSRV();
+    IGfxDescriptor* GetSRV(uint32_t mip, uint32_t slice);
     IGfxDescriptor* GetUAV();
     IGfxDescriptor* GetUAV(uint32_t mip, uint32_t slice);
 
@@ -68,11 +79,13 @@ public:
     virtual void Realize() override;
     virtual IGfxResource* GetResource() override { return m_pTexture; }
     virtual GfxResourceState GetInitialState() override { return m_initialState; }
+    virtual uint64_t GetSize() const override;
     virtual IGfxResource* GetAliasedPrevResource() override;
 
 private:
     Desc m_desc;
     IGfxTexture* m_pTexture = nullptr;
+    RGName m_historyName;
     GfxResourceState m_initialState = GfxResourceState::Common;
     RenderGraphResourceAllocator& m_allocator;
 };
@@ -82,11 +95,12 @@ class RGBuffer : public RenderGraphResource
 public:
     using Desc = GfxBufferDesc;
 
-    RGBuffer(RenderGraphResourceAllocator& allocator, const eastl::string& name, const Desc& desc);
+    RGBuffer(RenderGraphResourceAllocator& allocator, const RGName& name, const Desc& desc);
     RGBuffer(RenderGraphResourceAllocator& allocator, IGfxBuffer* buffer, GfxResourceState state);
     ~RGBuffer();
 
     IGfxBuffer* GetBuffer() const { return m_pBuffer; }
+    const Desc& GetDesc() const { return m_desc; }
     IGfxDescriptor* GetSRV();
     IGfxDescriptor* GetUAV();
 
@@ -94,6 +108,7 @@ public:
     virtual void Realize() override;
     virtual IGfxResource* GetResource() override { return m_pBuffer; }
     virtual GfxResourceState GetInitialState() override { return m_initialState; }
+    virtual uint64_t GetSize() const override { return m_desc.size; }
     virtual IGfxResource* GetAliasedPrevResource() override;
 
 private:
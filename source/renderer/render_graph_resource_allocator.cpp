@@ -1,6 +1,24 @@
 #include "render_graph_resource_allocator.h"
 #include "utils/assert.h"
 #include "fmt/format.h"
+#include "EASTL/algorithm.h"
+
+static inline GfxResourceState GetTextureInitialState(const GfxTextureDesc& desc)
+{
+    if (IsDepthFormat(desc.format))
+    {
+        return GfxResourceState::DepthStencil;
+    }
+    else if (desc.usage & GfxTextureUsageRenderTarget)
+    {
+        return GfxResourceState::RenderTarget;
+    }
+    else if (desc.usage & GfxTextureUsageUnorderedAccess)
+    {
+        return GfxResourceState::UnorderedAccess;
+    }
+    return GfxResourceState::Common;
+}
 
 RenderGraphResourceAllocator::RenderGraphResourceAllocator(IGfxDevice* pDevice)
 {
@@ -27,19 +45,32 @@ RenderGraphResourceAllocator::~RenderGraphResourceAllocator()
         DeleteDescriptor(iter->texture);
         delete iter->texture;
     }
+
+    for (auto iter = m_historyTextures.begin(); iter != m_historyTextures.end(); ++iter)
+    {
+        DeleteHistoryTexture(iter->second);
+    }
 }
 
 void RenderGraphResourceAllocator::Reset()
 {
-    for (auto iter = m_allocatedHeaps.begin(); iter != m_allocatedHeaps.end();)
+    for (size_t i = 0; i < m_allocatedHeaps.size(); ++i)
     {
-        Heap& heap = *iter;
-        CheckHeapUsage(heap);
+        CheckHeapUsage(m_allocatedHeaps[i]);
+    }
+
+    //empty heaps are not deleted right away, they can be reused after resolution changes
+    TrimHeapPool();
 
-        if (heap.resources.empty())
+    uint64_t current_frame = m_pDevice->GetFrameID();
+
+    for (auto iter = m_freeOverlappingTextures.begin(); iter != m_freeOverlappingTextures.end(); )
+    {
+        if (current_frame - iter->lastUsedFrame > 30)
         {
-            delete heap.heap;
-            iter = m_allocatedHeaps.erase(iter);
+            DeleteDescriptor(iter->texture);
+            delete iter->texture;
+            iter = m_freeOverlappingTextures.erase(iter);
         }
         else
         {
@@ -47,21 +78,34 @@ void RenderGraphResourceAllocator::Reset()
         }
     }
 
-    uint64_t current_frame = m_pDevice->GetFrameID();
+    EvictDescriptors();
 
-    for (auto iter = m_freeOverlappingTextures.begin(); iter != m_freeOverlappingTextures.end(); )
+    for (auto iter = m_historyTextures.begin(); iter != m_historyTextures.end(); )
     {
-        if (current_frame - iter->lastUsedFrame > 30)
+        HistoryTexture& history = iter->second;
+
+        if (current_frame - history.lastUsedFrame > 30)
         {
-            DeleteDescriptor(iter->texture);
-            delete iter->texture;
-            iter = m_freeOverlappingTextures.erase(iter);
+            DeleteHistoryTexture(history);
+            iter = m_historyTextures.erase(iter);
         }
         else
         {
+            //what was written in the last frame becomes the previous frame
+            if (history.written)
+            {
+                history.current = 1 - history.current;
+            }
+            history.valid = history.written;
+            history.written = false;
+
             ++iter;
         }
     }
+
+    m_descriptorCacheStats.descriptors = (uint32_t)(m_srvCache.size() + m_uavCache.size());
+    m_lastDescriptorCacheStats = m_descriptorCacheStats;
+    m_descriptorCacheStats = RenderGraphDescriptorCacheStats();
 }
 
 void RenderGraphResourceAllocator::CheckHeapUsage(Heap& heap)
@@ -86,7 +130,7 @@ void RenderGraphResourceAllocator::CheckHeapUsage(Heap& heap)
     }
 }
 
-IGfxTexture* RenderGraphResourceAllocator::AllocateTexture(uint32_t firstPass, uint32_t lastPass, const GfxTextureDesc& desc, const eastl::string& name, GfxResourceState& initial_state)
+IGfxTexture* RenderGraphResourceAllocator::AllocateTexture(uint32_t firstPass, uint32_t lastPass, const GfxTextureDesc& desc, const char* name, GfxResourceState& initial_state)
 {
     LifetimeRange lifetime = { firstPass, lastPass };
     uint32_t texture_size = m_pDevice->GetAllocationSize(desc);
@@ -106,39 +150,33 @@ IGfxTexture* RenderGraphResourceAllocator::AllocateTexture(uint32_t firstPass, u
             if (aliasedResource.isTexture && !aliasedResource.lifetime.IsUsed() && ((IGfxTexture*)aliasedResource.resource)->GetDesc() == desc)
             {
                 aliasedResource.lifetime = lifetime;
+                heap.lastUsedFrame = m_pDevice->GetFrameID();
                 initial_state = aliasedResource.lastUsedState;
                 return (IGfxTexture*)aliasedResource.resource;
             }
-        }        
-
-        AliasedResource aliasedTexture;
-        aliasedTexture.resource = m_pDevice->CreateTexture(desc, heap.heap, 0, "RGTexture " + name);
-        aliasedTexture.isTexture = true;
-        aliasedTexture.lifetime = lifetime;
-        heap.resources.push_back(aliasedTexture);
-
-        if (IsDepthFormat(desc.format))
-        {
-            initial_state = GfxResourceState::DepthStencil;
-        }
-        else if (desc.usage & GfxTextureUsageRenderTarget)
-        {
-            initial_state = GfxResourceState::RenderTarget;
-        }
-        else if (desc.usage & GfxTextureUsageUnorderedAccess)
-        {
-            initial_state = GfxResourceState::UnorderedAccess;
         }
+    }
 
-        RE_ASSERT(aliasedTexture.resource != nullptr);
-        return (IGfxTexture*)aliasedTexture.resource;
+    Heap* heap = FindHeap(texture_size, lifetime);
+    if (heap == nullptr)
+    {
+        heap = AllocateHeap(texture_size);
     }
 
-    AllocateHeap(texture_size);
-    return AllocateTexture(firstPass, lastPass, desc, name, initial_state);
+    AliasedResource aliasedTexture;
+    aliasedTexture.resource = m_pDevice->CreateTexture(desc, heap->heap, 0, eastl::string("RGTexture ") + name);
+    aliasedTexture.isTexture = true;
+    aliasedTexture.lifetime = lifetime;
+    heap->resources.push_back(aliasedTexture);
+    heap->lastUsedFrame = m_pDevice->GetFrameID();
+
+    initial_state = GetTextureInitialState(desc);
+
+    RE_ASSERT(aliasedTexture.resource != nullptr);
+    return (IGfxTexture*)aliasedTexture.resource;
 }
 
-IGfxBuffer* RenderGraphResourceAllocator::AllocateBuffer(uint32_t firstPass, uint32_t lastPass, const GfxBufferDesc& desc, const eastl::string& name, GfxResourceState& initial_state)
+IGfxBuffer* RenderGraphResourceAllocator::AllocateBuffer(uint32_t firstPass, uint32_t lastPass, const GfxBufferDesc& desc, const char* name, GfxResourceState& initial_state)
 {
     LifetimeRange lifetime = { firstPass, lastPass };
     uint32_t buffer_size = desc.size;
@@ -158,39 +196,106 @@ IGfxBuffer* RenderGraphResourceAllocator::AllocateBuffer(uint32_t firstPass, uin
             if (!aliasedResource.isTexture && !aliasedResource.lifetime.IsUsed() && ((IGfxBuffer*)aliasedResource.resource)->GetDesc() == desc)
             {
                 aliasedResource.lifetime = lifetime;
+                heap.lastUsedFrame = m_pDevice->GetFrameID();
                 initial_state = aliasedResource.lastUsedState;
                 return (IGfxBuffer*)aliasedResource.resource;
             }
         }
+    }
+
+    Heap* heap = FindHeap(buffer_size, lifetime);
+    if (heap == nullptr)
+    {
+        heap = AllocateHeap(buffer_size);
+    }
+
+    AliasedResource aliasedBuffer;
+    aliasedBuffer.resource = m_pDevice->CreateBuffer(desc, heap->heap, 0, eastl::string("RGBuffer ") + name);
+    aliasedBuffer.isTexture = false;
+    aliasedBuffer.lifetime = lifetime;
+    heap->resources.push_back(aliasedBuffer);
+    heap->lastUsedFrame = m_pDevice->GetFrameID();
 
-        AliasedResource aliasedBuffer;
-        aliasedBuffer.resource = m_pDevice->CreateBuffer(desc, heap.heap, 0, "RGBuffer " + name);
-        aliasedBuffer.isTexture = false;
-        aliasedBuffer.lifetime = lifetime;
-        heap.resources.push_back(aliasedBuffer);
+    initial_state = GfxResourceState::Common;
 
-        initial_state = GfxResourceState::Common;
+    RE_ASSERT(aliasedBuffer.resource != nullptr);
+    return (IGfxBuffer*)aliasedBuffer.resource;
+}
+
+RenderGraphResourceAllocator::Heap* RenderGraphResourceAllocator::FindHeap(uint32_t size, const LifetimeRange& lifetime)
+{
+    //the smallest one, so small resources don't take the large heaps
+    Heap* best_heap = nullptr;
+
+    for (size_t i = 0; i < m_allocatedHeaps.size(); ++i)
+    {
+        Heap& heap = m_allocatedHeaps[i];
+        if (heap.heap->GetDesc().size < size ||
+            heap.IsOverlapping(lifetime))
+        {
+            continue;
+        }
 
-        RE_ASSERT(aliasedBuffer.resource != nullptr);
-        return (IGfxBuffer*)aliasedBuffer.resource;
+        if (best_heap == nullptr || heap.heap->GetDesc().size < best_heap->heap->GetDesc().size)
+        {
+            best_heap = &heap;
+        }
     }
 
-    AllocateHeap(buffer_size);
-    return AllocateBuffer(firstPass, lastPass, desc, name, initial_state);
+    return best_heap;
 }
 
-void RenderGraphResourceAllocator::AllocateHeap(uint32_t size)
+RenderGraphResourceAllocator::Heap* RenderGraphResourceAllocator::AllocateHeap(uint32_t size)
 {
-#define ALIGN(address, alignment) (((address) + (alignment) - 1) & ~((alignment) - 1)) 
+    //power of two size classes, so the heaps still fit the resources after small resolution changes
+    uint32_t heap_size = 64u * 1024;
+    while (heap_size < size && heap_size < 0x80000000u)
+    {
+        heap_size <<= 1;
+    }
 
     GfxHeapDesc heapDesc;
-    heapDesc.size = ALIGN(size, 64u * 1024);
+    heapDesc.size = eastl::max(heap_size, size);
 
     eastl::string heapName = fmt::format("RG Heap {:.1f} MB", heapDesc.size / (1024.0f * 1024.0f)).c_str();
 
     Heap heap;
     heap.heap = m_pDevice->CreateHeap(heapDesc, heapName);
     m_allocatedHeaps.push_back(heap);
+
+    return &m_allocatedHeaps.back();
+}
+
+void RenderGraphResourceAllocator::TrimHeapPool()
+{
+    uint64_t total_size = 0;
+    for (size_t i = 0; i < m_allocatedHeaps.size(); ++i)
+    {
+        total_size += m_allocatedHeaps[i].heap->GetDesc().size;
+    }
+
+    //delete the least recently used empty heaps until it fits the budget
+    while (total_size > m_nHeapPoolBudget)
+    {
+        auto lru_heap = m_allocatedHeaps.end();
+
+        for (auto iter = m_allocatedHeaps.begin(); iter != m_allocatedHeaps.end(); ++iter)
+        {
+            if (iter->resources.empty() && (lru_heap == m_allocatedHeaps.end() || iter->lastUsedFrame < lru_heap->lastUsedFrame))
+            {
+                lru_heap = iter;
+            }
+        }
+
+        if (lru_heap == m_allocatedHeaps.end())
+        {
+            break;
+        }
+
+        total_size -= lru_heap->heap->GetDesc().size;
+        delete lru_heap->heap;
+        m_allocatedHeaps.erase(lru_heap);
+    }
 }
 
 void RenderGraphResourceAllocator::Free(IGfxResource* resource, GfxResourceState state)
@@ -252,7 +357,32 @@ IGfxResource* RenderGraphResourceAllocator::GetAliasedPrevResource(IGfxResource*
     return nullptr;
 }
 
-IGfxTexture* RenderGraphResourceAllocator::AllocateNonOverlappingTexture(const GfxTextureDesc& desc, const eastl::string& name, GfxResourceState& initial_state)
+bool RenderGraphResourceAllocator::GetHeapAllocation(IGfxResource* resource, RenderGraphHeapAllocation& allocation) const
+{
+    for (size_t i = 0; i < m_allocatedHeaps.size(); ++i)
+    {
+        const Heap& heap = m_allocatedHeaps[i];
+
+        for (size_t j = 0; j < heap.resources.size(); ++j)
+        {
+            const AliasedResource& aliasedResource = heap.resources[j];
+            if (aliasedResource.resource != resource)
+            {
+                continue;
+            }
+
+            allocation.heap = (uint32_t)i;
+            allocation.heapSize = heap.heap->GetDesc().size;
+            allocation.offset = 0;
+            allocation.size = aliasedResource.isTexture ? m_pDevice->GetAllocationSize(((IGfxTexture*)resource)->GetDesc()) : ((IGfxBuffer*)resource)->GetDesc().size;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+IGfxTexture* RenderGraphResourceAllocator::AllocateNonOverlappingTexture(const GfxTextureDesc& desc, const char* name, GfxResourceState& initial_state)
 {
     for (auto iter = m_freeOverlappingTextures.begin(); iter != m_freeOverlappingTextures.end(); ++iter)
     {
@@ -264,20 +394,10 @@ IGfxTexture* RenderGraphResourceAllocator::AllocateNonOverlappingTexture(const G
             return texture;
         }
     }
-    if (IsDepthFormat(desc.format))
-    {
-        initial_state = GfxResourceState::DepthStencil;
-    }
-    else if (desc.usage & GfxTextureUsageRenderTarget)
-    {
-        initial_state = GfxResourceState::RenderTarget;
-    }
-    else if (desc.usage & GfxTextureUsageUnorderedAccess)
-    {
-        initial_state = GfxResourceState::UnorderedAccess;
-    }
 
-    return m_pDevice->CreateTexture(desc, "RGTexture " + name);
+    initial_state = GetTextureInitialState(desc);
+
+    return m_pDevice->CreateTexture(desc, eastl::string("RGTexture ") + name);
 }
 
 void RenderGraphResourceAllocator::FreeNonOverlappingTexture(IGfxTexture* texture, GfxResourceState state)
@@ -290,46 +410,95 @@ void RenderGraphResourceAllocator::FreeNonOverlappingTexture(IGfxTexture* textur
 
 IGfxDescriptor* RenderGraphResourceAllocator::GetDescriptor(IGfxResource* resource, const GfxShaderResourceViewDesc& desc)
 {
-    for (size_t i = 0; i < m_allocatedSRVs.size(); ++i)
+    auto iter = m_srvCache.find({ resource, desc });
+    if (iter != m_srvCache.end())
     {
-        if (m_allocatedSRVs[i].resource == resource &&
-            m_allocatedSRVs[i].desc == desc)
-        {
-            return m_allocatedSRVs[i].descriptor;
-        }
+        iter->second.lastUsedFrame = m_pDevice->GetFrameID();
+        m_descriptorCacheStats.hits++;
+        return iter->second.descriptor;
     }
 
     IGfxDescriptor* srv = m_pDevice->CreateShaderResourceView(resource, desc, resource->GetName());
-    m_allocatedSRVs.push_back({ resource, srv, desc });
+    m_srvCache.insert(eastl::make_pair(DescriptorKey<GfxShaderResourceViewDesc> { resource, desc }, CachedDescriptor { srv, m_pDevice->GetFrameID() }));
+    m_resourceDescriptors[resource].srvs.push_back(desc);
+    m_descriptorCacheStats.misses++;
 
     return srv;
 }
 
 IGfxDescriptor* RenderGraphResourceAllocator::GetDescriptor(IGfxResource* resource, const GfxUnorderedAccessViewDesc& desc)
 {
-    for (size_t i = 0; i < m_allocatedUAVs.size(); ++i)
+    auto iter = m_uavCache.find({ resource, desc });
+    if (iter != m_uavCache.end())
     {
-        if (m_allocatedUAVs[i].resource == resource &&
-            m_allocatedUAVs[i].desc == desc)
-        {
-            return m_allocatedUAVs[i].descriptor;
-        }
+        iter->second.lastUsedFrame = m_pDevice->GetFrameID();
+        m_descriptorCacheStats.hits++;
+        return iter->second.descriptor;
     }
 
-    IGfxDescriptor* srv = m_pDevice->CreateUnorderedAccessView(resource, desc, resource->GetName());
-    m_allocatedUAVs.push_back({ resource, srv, desc });
+    IGfxDescriptor* uav = m_pDevice->CreateUnorderedAccessView(resource, desc, resource->GetName());
+    m_uavCache.insert(eastl::make_pair(DescriptorKey<GfxUnorderedAccessViewDesc> { resource, desc }, CachedDescriptor { uav, m_pDevice->GetFrameID() }));
+    m_resourceDescriptors[resource].uavs.push_back(desc);
+    m_descriptorCacheStats.misses++;
 
-    return srv;
+    return uav;
 }
 
 void RenderGraphResourceAllocator::DeleteDescriptor(IGfxResource* resource)
 {
-    for (auto iter = m_allocatedSRVs.begin(); iter != m_allocatedSRVs.end(); )
+    auto iter = m_resourceDescriptors.find(resource);
+    if (iter == m_resourceDescriptors.end())
     {
-        if (iter->resource == resource)
+        return;
+    }
+
+    const ResourceDescriptors& descriptors = iter->second;
+
+    for (size_t i = 0; i < descriptors.srvs.size(); ++i)
+    {
+        auto srv = m_srvCache.find({ resource, descriptors.srvs[i] });
+        RE_ASSERT(srv != m_srvCache.end());
+
+        delete srv->second.descriptor;
+        m_srvCache.erase(srv);
+    }
+
+    for (size_t i = 0; i < descriptors.uavs.size(); ++i)
+    {
+        auto uav = m_uavCache.find({ resource, descriptors.uavs[i] });
+        RE_ASSERT(uav != m_uavCache.end());
+
+        delete uav->second.descriptor;
+        m_uavCache.erase(uav);
+    }
+
+    m_resourceDescriptors.erase(iter);
+}
+
+void RenderGraphResourceAllocator::EvictDescriptors()
+{
+    //views which are not used for a while, e.g. of mips or slices used only by some passes
+    uint64_t current_frame = m_pDevice->GetFrameID();
+
+    for (auto iter = m_srvCache.begin(); iter != m_srvCache.end(); )
+    {
+        if (current_frame - iter->second.lastUsedFrame > 30)
         {
-            delete iter->descriptor;
-            iter = m_allocatedSRVs.erase(iter);
+            auto descriptors = m_resourceDescriptors.find(iter->first.resource);
+            if (descriptors != m_resourceDescriptors.end())
+            {
+                eastl::vector<GfxShaderResourceViewDesc>& srvs = descriptors->second.srvs;
+                srvs.erase(eastl::remove(srvs.begin(), srvs.end(), iter->first.desc), srvs.end());
+
+                if (srvs.empty() && descriptors->second.uavs.empty())
+                {
+                    m_resourceDescriptors.erase(descriptors);
+                }
+            }
+
+            delete iter->second.descriptor;
+            iter = m_srvCache.erase(iter);
+            m_descriptorCacheStats.evictions++;
         }
         else
         {
@@ -337,12 +506,25 @@ void RenderGraphResourceAllocator::DeleteDescriptor(IGfxResource* resource)
         }
     }
 
-    for (auto iter = m_allocatedUAVs.begin(); iter != m_allocatedUAVs.end(); )
+    for (auto iter = m_uavCache.begin(); iter != m_uavCache.end(); )
     {
-        if (iter->resource == resource)
+        if (current_frame - iter->second.lastUsedFrame > 30)
         {
-            delete iter->descriptor;
-            iter = m_allocatedUAVs.erase(iter);
+            auto descriptors = m_resourceDescriptors.find(iter->first.resource);
+            if (descriptors != m_resourceDescriptors.end())
+            {
+                eastl::vector<GfxUnorderedAccessViewDesc>& uavs = descriptors->second.uavs;
+                uavs.erase(eastl::remove(uavs.begin(), uavs.end(), iter->first.desc), uavs.end());
+
+                if (uavs.empty() && descriptors->second.srvs.empty())
+                {
+                    m_resourceDescriptors.erase(descriptors);
+                }
+            }
+
+            delete iter->second.descriptor;
+            iter = m_uavCache.erase(iter);
+            m_descriptorCacheStats.evictions++;
         }
         else
         {
@@ -350,3 +532,86 @@ void RenderGraphResourceAllocator::DeleteDescriptor(IGfxResource* resource)
         }
     }
 }
+
+IGfxTexture* RenderGraphResourceAllocator::AllocateHistoryTexture(const GfxTextureDesc& desc, const RGName& name, bool prev_frame, GfxResourceState& initial_state)
+{
+    //both textures are used as render target/uav in alternate frames, so the usage shouldn't depend on the passes of one frame
+    GfxTextureDesc historyDesc = desc;
+    historyDesc.usage |= IsDepthFormat(desc.format) ? GfxTextureUsageDepthStencil : (GfxTextureUsageRenderTarget | GfxTextureUsageUnorderedAccess);
+
+    uint64_t current_frame = m_pDevice->GetFrameID();
+    HistoryTexture& history = m_historyTextures[name.c_str()];
+
+    if (history.texture[0] == nullptr || !(history.texture[0]->GetDesc() == historyDesc))
+    {
+        RE_ASSERT(history.texture[0] == nullptr || history.lastUsedFrame != current_frame); //desc changed in the middle of a frame
+        DeleteHistoryTexture(history);
+
+        for (uint32_t i = 0; i < 2; ++i)
+        {
+            history.texture[i] = m_pDevice->CreateTexture(historyDesc, fmt::format("RGHistory {} {}", name.c_str(), i).c_str());
+            history.state[i] = GetTextureInitialState(historyDesc);
+            RE_ASSERT(history.texture[i] != nullptr);
+        }
+
+        history.current = 0;
+        history.written = false;
+        history.valid = false;
+    }
+
+    history.lastUsedFrame = current_frame;
+
+    uint32_t index = prev_frame ? 1 - history.current : history.current;
+    initial_state = history.state[index];
+    return history.texture[index];
+}
+
+void RenderGraphResourceAllocator::FreeHistoryTexture(IGfxTexture* texture, GfxResourceState state, bool used)
+{
+    for (auto iter = m_historyTextures.begin(); iter != m_historyTextures.end(); ++iter)
+    {
+        HistoryTexture& history = iter->second;
+
+        for (uint32_t i = 0; i < 2; ++i)
+        {
+            if (history.texture[i] == texture)
+            {
+                if (used)
+                {
+                    history.state[i] = state;
+
+                    if (i == history.current)
+                    {
+                        history.written = true;
+                    }
+                }
+                return;
+            }
+        }
+    }
+
+    RE_ASSERT(false);
+}
+
+bool RenderGraphResourceAllocator::IsHistoryValid(const RGName& name) const
+{
+    auto iter = m_historyTextures.find(name.c_str());
+    if (iter != m_historyTextures.end())
+    {
+        return iter->second.valid;
+    }
+    return false;
+}
+
+void RenderGraphResourceAllocator::DeleteHistoryTexture(HistoryTexture& history)
+{
+    for (uint32_t i = 0; i < 2; ++i)
+    {
+        if (history.texture[i])
+        {
+            DeleteDescriptor(history.texture[i]);
+            delete history.texture[i];
+            history.texture[i] = nullptr;
+        }
+    }
+}
\ No newline at end of file
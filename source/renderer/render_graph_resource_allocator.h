@@ -1,6 +1,25 @@
 #pragma once
 
+#include "render_graph_name.h"
 #include "gfx/gfx.h"
+#include "EASTL/hash_map.h"
+#include "xxHash/xxhash.h"
+
+struct RenderGraphDescriptorCacheStats
+{
+    uint32_t hits = 0;
+    uint32_t misses = 0;
+    uint32_t evictions = 0;
+    uint32_t descriptors = 0; //cached descriptors at the end of the frame
+};
+
+struct RenderGraphHeapAllocation
+{
+    uint32_t heap = UINT32_MAX; //index in the heap pool
+    uint64_t heapSize = 0;
+    uint64_t offset = 0; //always 0, each heap is created for one resource and the resources aliasing it are placed at its start
+    uint64_t size = 0;
+};
 
 class RenderGraphResourceAllocator
 {
@@ -37,6 +56,7 @@ class RenderGraphResourceAllocator
     {
         IGfxHeap* heap;
         eastl::vector<AliasedResource> resources;
+        uint64_t lastUsedFrame = 0;
 
         bool IsOverlapping(const LifetimeRange& lifetime) const
         {
@@ -63,18 +83,49 @@ class RenderGraphResourceAllocator
         }
     };
 
-    struct SRVDescriptor
+    template<typename Desc>
+    struct DescriptorKey
     {
         IGfxResource* resource;
-        IGfxDescriptor* descriptor;
-        GfxShaderResourceViewDesc desc;
+        Desc desc;
+
+        bool operator==(const DescriptorKey& other) const { return resource == other.resource && desc == other.desc; }
     };
 
-    struct UAVDescriptor
+    template<typename Desc>
+    struct DescriptorKeyHash
+    {
+        size_t operator()(const DescriptorKey<Desc>& key) const
+        {
+            //view descs are all uint32_t without padding, so hashing the bytes matches operator==
+            return (size_t)XXH3_64bits_withSeed(&key.desc, sizeof(Desc), (uint64_t)key.resource);
+        }
+    };
+
+    struct CachedDescriptor
     {
-        IGfxResource* resource;
         IGfxDescriptor* descriptor;
-        GfxUnorderedAccessViewDesc desc;
+        uint64_t lastUsedFrame;
+    };
+
+    template<typename Desc>
+    using DescriptorCache = eastl::hash_map<DescriptorKey<Desc>, CachedDescriptor, DescriptorKeyHash<Desc>>;
+
+    //views of a resource, so they can be deleted without walking the caches
+    struct ResourceDescriptors
+    {
+        eastl::vector<GfxShaderResourceViewDesc> srvs;
+        eastl::vector<GfxUnorderedAccessViewDesc> uavs;
+    };
+
+    struct HistoryTexture
+    {
+        IGfxTexture* texture[2] = {};
+        GfxResourceState state[2] = {};
+        uint32_t current = 0; //written in the current frame, the other one holds the previous frame
+        uint64_t lastUsedFrame = 0;
+        bool written = false;
+        bool valid = false;
     };
 
 public:
@@ -83,27 +134,47 @@ public:
 
     void Reset();
 
-    IGfxTexture* AllocateNonOverlappingTexture(const GfxTextureDesc& desc, const eastl::string& name, GfxResourceState& initial_state);
+    //heaps are pooled in power of two sizes, empty heaps are kept until the total size of the heaps exceeds the budget
+    uint64_t GetHeapPoolBudget() const { return m_nHeapPoolBudget; }
+    void SetHeapPoolBudget(uint64_t size) { m_nHeapPoolBudget = size; }
+
+    IGfxTexture* AllocateNonOverlappingTexture(const GfxTextureDesc& desc, const char* name, GfxResourceState& initial_state);
     void FreeNonOverlappingTexture(IGfxTexture* texture, GfxResourceState state);
 
-    IGfxTexture* AllocateTexture(uint32_t firstPass, uint32_t lastPass, const GfxTextureDesc& desc, const eastl::string& name, GfxResourceState& initial_state);
-    IGfxBuffer* AllocateBuffer(uint32_t firstPass, uint32_t lastPass, const GfxBufferDesc& desc, const eastl::string& name, GfxResourceState& initial_state);
+    IGfxTexture* AllocateTexture(uint32_t firstPass, uint32_t lastPass, const GfxTextureDesc& desc, const char* name, GfxResourceState& initial_state);
+    IGfxBuffer* AllocateBuffer(uint32_t firstPass, uint32_t lastPass, const GfxBufferDesc& desc, const char* name, GfxResourceState& initial_state);
     void Free(IGfxResource* resource, GfxResourceState state);
 
     IGfxResource* GetAliasedPrevResource(IGfxResource* resource, uint32_t firstPass);
 
+    //placement of a resource from AllocateTexture/AllocateBuffer, false for the other resources
+    bool GetHeapAllocation(IGfxResource* resource, RenderGraphHeapAllocation& allocation) const;
+
+    //history textures are double-buffered and never aliased, the two textures are flipped in Reset
+    IGfxTexture* AllocateHistoryTexture(const GfxTextureDesc& desc, const RGName& name, bool prev_frame, GfxResourceState& initial_state);
+    void FreeHistoryTexture(IGfxTexture* texture, GfxResourceState state, bool used);
+    bool IsHistoryValid(const RGName& name) const;
+
     IGfxDescriptor* GetDescriptor(IGfxResource* resource, const GfxShaderResourceViewDesc& desc);
     IGfxDescriptor* GetDescriptor(IGfxResource* resource, const GfxUnorderedAccessViewDesc& desc);
 
+    //counters of the last frame
+    const RenderGraphDescriptorCacheStats& GetDescriptorCacheStats() const { return m_lastDescriptorCacheStats; }
+
 private:
     void CheckHeapUsage(Heap& heap);
     void DeleteDescriptor(IGfxResource* resource);
-    void AllocateHeap(uint32_t size);
+    void EvictDescriptors();
+    Heap* FindHeap(uint32_t size, const LifetimeRange& lifetime);
+    Heap* AllocateHeap(uint32_t size);
+    void TrimHeapPool();
+    void DeleteHistoryTexture(HistoryTexture& history);
 
 private:
     IGfxDevice* m_pDevice;
 
     eastl::vector<Heap> m_allocatedHeaps;
+    uint64_t m_nHeapPoolBudget = 512 * 1024 * 1024;
 
     struct NonOverlappingTexture
     {
@@ -113,6 +184,12 @@ private:
     };
     eastl::vector<NonOverlappingTexture> m_freeOverlappingTextures;
 
-    eastl::vector<SRVDescriptor> m_allocatedSRVs;
-    eastl::vector<UAVDescriptor> m_allocatedUAVs;
+    eastl::hash_map<const void*, HistoryTexture> m_historyTextures; //key is the interned string of the name, which is unique even if the hashes collide
+
+    DescriptorCache<GfxShaderResourceViewDesc> m_srvCache;
+    DescriptorCache<GfxUnorderedAccessViewDesc> m_uavCache;
+    eastl::hash_map<IGfxResource*, ResourceDescriptors> m_resourceDescriptors;
+
+    RenderGraphDescriptorCacheStats m_descriptorCacheStats;
+    RenderGraphDescriptorCacheStats m_lastDescriptorCacheStats;
 };
\ No newline at end of file
@@ -0,0 +1,379 @@
+#include "render_graph_setup.h"
+#include "render_graph.h"
+
+static thread_local RGSetupRecorder* s_pCurrentRecorder = nullptr;
+
+RGSetupRecorder::RGSetupRecorder(RenderGraph* graph, uint16_t id)
+{
+    m_pGraph = graph;
+    m_nID = id;
+}
+
+RGSetupRecorder::~RGSetupRecorder()
+{
+    Clear();
+}
+
+RGSetupRecorder* RGSetupRecorder::GetCurrent(const RenderGraph* graph)
+{
+    if (s_pCurrentRecorder && s_pCurrentRecorder->m_pGraph == graph)
+    {
+        return s_pCurrentRecorder;
+    }
+    return nullptr;
+}
+
+void RGSetupRecorder::Record(const eastl::function<void()>& task)
+{
+    //a task may wait for other tasks, which can run on this thread in the meantime
+    RGSetupRecorder* prev_recorder = s_pCurrentRecorder;
+    s_pCurrentRecorder = this;
+
+    task();
+
+    s_pCurrentRecorder = prev_recorder;
+}
+
+void RGSetupRecorder::Merge()
+{
+    RenderGraph* graph = m_pGraph;
+
+    for (size_t i = 0; i < m_ops.size(); ++i)
+    {
+        const Op& op = m_ops[i];
+
+        switch (op.type)
+        {
+        case OpType::BeginPass:
+            graph->m_graph.AddNode(op.pass);
+            graph->BeginPass(op.pass);
+            break;
+        case OpType::EndPass:
+            graph->EndPass(op.pass);
+            break;
+        case OpType::BeginEvent:
+            graph->BeginEvent(op.name);
+            break;
+        case OpType::EndEvent:
+            graph->EndEvent();
+            break;
+        case OpType::CreateTexture:
+            MapHandle(op.output, graph->Create<RGTexture>(m_textureDescs[op.index], op.name));
+            break;
+        case OpType::CreateBuffer:
+            MapHandle(op.output, graph->Create<RGBuffer>(m_bufferDescs[op.index], op.name));
+            break;
+        case OpType::CreateHistory:
+            MapHandle(op.output, graph->CreateHistory(m_textureDescs[op.index], op.name));
+            break;
+        case OpType::ImportPrevHistory:
+            MapHandle(op.output, graph->ImportPrevHistory(m_textureDescs[op.index], op.name));
+            break;
+        case OpType::ImportTexture:
+            MapHandle(op.output, graph->Import((IGfxTexture*)op.resource, op.usage));
+            break;
+        case OpType::ImportBuffer:
+            MapHandle(op.output, graph->Import((IGfxBuffer*)op.resource, op.usage));
+            break;
+        case OpType::Present:
+            graph->Present(Resolve(op.input), op.usage);
+            break;
+        case OpType::Read:
+            graph->Read(op.pass, Resolve(op.input), op.usage, op.subresource, op.subresourceCount, op.firstView);
+            break;
+        case OpType::Write:
+            MapHandle(op.output, graph->Write(op.pass, Resolve(op.input), op.usage, op.subresource, op.subresourceCount, op.firstView));
+            break;
+        case OpType::WriteColor:
+            MapHandle(op.output, graph->WriteColor(op.pass, op.index, Resolve(op.input), op.subresource, op.loadOp, op.clearValue));
+            break;
+        case OpType::WriteDepth:
+            MapHandle(op.output, graph->WriteDepth(op.pass, Resolve(op.input), op.subresource, op.loadOp, op.stencilLoadOp, op.clearValue.x, (uint32_t)op.clearValue.y));
+            break;
+        case OpType::ReadDepth:
+            MapHandle(op.output, graph->ReadDepth(op.pass, Resolve(op.input), op.subresource));
+            break;
+        default:
+            RE_ASSERT(false);
+            break;
+        }
+    }
+}
+
+void RGSetupRecorder::Clear()
+{
+    for (size_t i = 0; i < m_objFinalizer.size(); ++i)
+    {
+        m_objFinalizer[i].finalizer(m_objFinalizer[i].obj);
+    }
+    m_objFinalizer.clear();
+
+    m_allocator.Reset();
+
+    m_ops.clear();
+    m_textureDescs.clear();
+    m_bufferDescs.clear();
+    m_resourceIndices.clear();
+    m_nodeIndices.clear();
+}
+
+RGHandle RGSetupRecorder::Resolve(const RGHandle& handle) const
+{
+    if (handle.recorder != m_nID)
+    {
+        return handle;
+    }
+
+    RGHandle output;
+    output.index = m_resourceIndices[handle.index];
+    output.node = m_nodeIndices[handle.node];
+    RE_ASSERT(output.IsValid()); //the recorder is not merged yet, setup tasks shouldn't share handles
+
+    return output;
+}
+
+void RGSetupRecorder::BeginPass(RenderGraphPassBase* pass)
+{
+    Op op;
+    op.type = OpType::BeginPass;
+    op.pass = pass;
+    m_ops.push_back(op);
+}
+
+void RGSetupRecorder::EndPass(RenderGraphPassBase* pass)
+{
+    Op op;
+    op.type = OpType::EndPass;
+    op.pass = pass;
+    m_ops.push_back(op);
+}
+
+void RGSetupRecorder::BeginEvent(const RGName& name)
+{
+    Op op;
+    op.type = OpType::BeginEvent;
+    op.name = name;
+    m_ops.push_back(op);
+}
+
+void RGSetupRecorder::EndEvent()
+{
+    Op op;
+    op.type = OpType::EndEvent;
+    m_ops.push_back(op);
+}
+
+RGHandle RGSetupRecorder::Create(const GfxTextureDesc& desc, const RGName& name)
+{
+    Op op;
+    op.type = OpType::CreateTexture;
+    op.output = AddResource();
+    op.name = name;
+    op.index = (uint32_t)m_textureDescs.size();
+    m_ops.push_back(op);
+
+    m_textureDescs.push_back(desc);
+
+    return op.output;
+}
+
+RGHandle RGSetupRecorder::Create(const GfxBufferDesc& desc, const RGName& name)
+{
+    Op op;
+    op.type = OpType::CreateBuffer;
+    op.output = AddResource();
+    op.name = name;
+    op.index = (uint32_t)m_bufferDescs.size();
+    m_ops.push_back(op);
+
+    m_bufferDescs.push_back(desc);
+
+    return op.output;
+}
+
+RGHandle RGSetupRecorder::CreateHistory(const GfxTextureDesc& desc, const RGName& name)
+{
+    Op op;
+    op.type = OpType::CreateHistory;
+    op.output = AddResource();
+    op.name = name;
+    op.index = (uint32_t)m_textureDescs.size();
+    m_ops.push_back(op);
+
+    m_textureDescs.push_back(desc);
+
+    return op.output;
+}
+
+RGHandle RGSetupRecorder::ImportPrevHistory(const GfxTextureDesc& desc, const RGName& name)
+{
+    Op op;
+    op.type = OpType::ImportPrevHistory;
+    op.output = AddResource();
+    op.name = name;
+    op.index = (uint32_t)m_textureDescs.size();
+    m_ops.push_back(op);
+
+    m_textureDescs.push_back(desc);
+
+    return op.output;
+}
+
+RGHandle RGSetupRecorder::Import(IGfxTexture* texture, GfxResourceState state)
+{
+    Op op;
+    op.type = OpType::ImportTexture;
+    op.output = AddResource();
+    op.usage = state;
+    op.resource = texture;
+    m_ops.push_back(op);
+
+    return op.output;
+}
+
+RGHandle RGSetupRecorder::Import(IGfxBuffer* buffer, GfxResourceState state)
+{
+    Op op;
+    op.type = OpType::ImportBuffer;
+    op.output = AddResource();
+    op.usage = state;
+    op.resource = buffer;
+    m_ops.push_back(op);
+
+    return op.output;
+}
+
+void RGSetupRecorder::Present(const RGHandle& handle, GfxResourceState state)
+{
+    Op op;
+    op.type = OpType::Present;
+    op.input = GetInput(handle);
+    op.usage = state;
+    m_ops.push_back(op);
+}
+
+RGHandle RGSetupRecorder::Read(RenderGraphPassBase* pass, const RGHandle& input, GfxResourceState usage, uint32_t subresource, uint32_t subresource_count, uint32_t first_view)
+{
+    Op op;
+    op.type = OpType::Read;
+    op.pass = pass;
+    op.input = GetInput(input);
+    op.usage = usage;
+    op.subresource = subresource;
+    op.subresourceCount = subresource_count;
+    op.firstView = first_view;
+    m_ops.push_back(op);
+
+    //same as RenderGraph::Read, reading doesn't create a new version
+    return input;
+}
+
+RGHandle RGSetupRecorder::Write(RenderGraphPassBase* pass, const RGHandle& input, GfxResourceState usage, uint32_t subresource, uint32_t subresource_count, uint32_t first_view)
+{
+    Op op;
+    op.type = OpType::Write;
+    op.pass = pass;
+    op.input = GetInput(input);
+    op.output = AddVersion(op.input);
+    op.usage = usage;
+    op.subresource = subresource;
+    op.subresourceCount = subresource_count;
+    op.firstView = first_view;
+    m_ops.push_back(op);
+
+    return op.output;
+}
+
+RGHandle RGSetupRecorder::WriteColor(RenderGraphPassBase* pass, uint32_t color_index, const RGHandle& input, uint32_t subresource, GfxRenderPassLoadOp load_op, const float4& clear_color)
+{
+    Op op;
+    op.type = OpType::WriteColor;
+    op.pass = pass;
+    op.input = GetInput(input);
+    op.output = AddVersion(op.input);
+    op.subresource = subresource;
+    op.index = color_index;
+    op.loadOp = load_op;
+    op.clearValue = clear_color;
+    m_ops.push_back(op);
+
+    return op.output;
+}
+
+RGHandle RGSetupRecorder::WriteDepth(RenderGraphPassBase* pass, const RGHandle& input, uint32_t subresource, GfxRenderPassLoadOp depth_load_op, GfxRenderPassLoadOp stencil_load_op, float clear_depth, uint32_t clear_stencil)
+{
+    Op op;
+    op.type = OpType::WriteDepth;
+    op.pass = pass;
+    op.input = GetInput(input);
+    op.output = AddVersion(op.input);
+    op.subresource = subresource;
+    op.loadOp = depth_load_op;
+    op.stencilLoadOp = stencil_load_op;
+    op.clearValue = float4(clear_depth, (float)clear_stencil, 0.0f, 0.0f);
+    m_ops.push_back(op);
+
+    return op.output;
+}
+
+RGHandle RGSetupRecorder::ReadDepth(RenderGraphPassBase* pass, const RGHandle& input, uint32_t subresource)
+{
+    Op op;
+    op.type = OpType::ReadDepth;
+    op.pass = pass;
+    op.input = GetInput(input);
+    op.output = AddVersion(op.input);
+    op.subresource = subresource;
+    m_ops.push_back(op);
+
+    return op.output;
+}
+
+RGHandle RGSetupRecorder::GetInput(const RGHandle& handle) const
+{
+    //handles of the recorders merged before are resolved to the graph now
+    if (handle.recorder == m_nID)
+    {
+        return handle;
+    }
+    return m_pGraph->Resolve(handle);
+}
+
+RGHandle RGSetupRecorder::AddResource(uint16_t index)
+{
+    RGHandle handle;
+    handle.index = (uint16_t)m_resourceIndices.size();
+    handle.node = (uint16_t)m_nodeIndices.size();
+    handle.recorder = m_nID;
+
+    m_resourceIndices.push_back(index);
+    m_nodeIndices.push_back(uint16_t(-1));
+
+    return handle;
+}
+
+RGHandle RGSetupRecorder::AddVersion(const RGHandle& input)
+{
+    if (input.recorder != m_nID)
+    {
+        //a resource of the graph, it needs a local index for the new node
+        return AddResource(input.index);
+    }
+
+    RGHandle handle;
+    handle.index = input.index;
+    handle.node = (uint16_t)m_nodeIndices.size();
+    handle.recorder = m_nID;
+
+    m_nodeIndices.push_back(uint16_t(-1));
+
+    return handle;
+}
+
+void RGSetupRecorder::MapHandle(const RGHandle& local, const RGHandle& handle)
+{
+    RE_ASSERT(local.recorder == m_nID && handle.recorder == 0);
+
+    m_resourceIndices[local.index] = handle.index;
+    m_nodeIndices[local.node] = handle.node;
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+#include "render_graph_pass.h"
+#include "render_graph_handle.h"
+#include "utils/linear_allocator.h"
+#include "utils/math.h"
+
+class RenderGraph;
+
+//records the render graph calls of a setup task in RenderGraph::RunSetupTasks, it is bound to the thread running the task.
+//handles are local to the recorder until it is merged, merging replays the calls so the graph is the same as a serial build
+class RGSetupRecorder
+{
+public:
+    RGSetupRecorder(RenderGraph* graph, uint16_t id);
+    ~RGSetupRecorder();
+
+    static RGSetupRecorder* GetCurrent(const RenderGraph* graph);
+
+    void Record(const eastl::function<void()>& task);
+    void Merge();
+    void Clear();
+
+    RGHandle Resolve(const RGHandle& handle) const;
+
+    template<typename T, typename... ArgsT>
+    T* Allocate(ArgsT&&... arguments);
+
+    void BeginPass(RenderGraphPassBase* pass);
+    void EndPass(RenderGraphPassBase* pass);
+    void BeginEvent(const RGName& name);
+    void EndEvent();
+
+    RGHandle Create(const GfxTextureDesc& desc, const RGName& name);
+    RGHandle Create(const GfxBufferDesc& desc, const RGName& name);
+    RGHandle CreateHistory(const GfxTextureDesc& desc, const RGName& name);
+    RGHandle ImportPrevHistory(const GfxTextureDesc& desc, const RGName& name);
+    RGHandle Import(IGfxTexture* texture, GfxResourceState state);
+    RGHandle Import(IGfxBuffer* buffer, GfxResourceState state);
+    void Present(const RGHandle& handle, GfxResourceState state);
+
+    RGHandle Read(RenderGraphPassBase* pass, const RGHandle& input, GfxResourceState usage, uint32_t subresource, uint32_t subresource_count, uint32_t first_view);
+    RGHandle Write(RenderGraphPassBase* pass, const RGHandle& input, GfxResourceState usage, uint32_t subresource, uint32_t subresource_count, uint32_t first_view);
+    RGHandle WriteColor(RenderGraphPassBase* pass, uint32_t color_index, const RGHandle& input, uint32_t subresource, GfxRenderPassLoadOp load_op, const float4& clear_color);
+    RGHandle WriteDepth(RenderGraphPassBase* pass, const RGHandle& input, uint32_t subresource, GfxRenderPassLoadOp depth_load_op, GfxRenderPassLoadOp stencil_load_op, float clear_depth, uint32_t clear_stencil);
+    RGHandle ReadDepth(RenderGraphPassBase* pass, const RGHandle& input, uint32_t subresource);
+
+private:
+    enum class OpType
+    {
+        BeginPass,
+        EndPass,
+        BeginEvent,
+        EndEvent,
+        CreateTexture,
+        CreateBuffer,
+        CreateHistory,
+        ImportPrevHistory,
+        ImportTexture,
+        ImportBuffer,
+        Present,
+        Read,
+        Write,
+        WriteColor,
+        WriteDepth,
+        ReadDepth,
+    };
+
+    struct Op
+    {
+        OpType type;
+        RenderGraphPassBase* pass = nullptr;
+        RGHandle input;
+        RGHandle output;
+        RGName name;
+        GfxResourceState usage = GfxResourceState::Common;
+        uint32_t subresource = 0;
+        uint32_t subresourceCount = 1;
+        uint32_t firstView = 0;
+        uint32_t index = 0; //desc index for created resources, color index for color attachments
+        GfxRenderPassLoadOp loadOp = GfxRenderPassLoadOp::Load;
+        GfxRenderPassLoadOp stencilLoadOp = GfxRenderPassLoadOp::Load;
+        float4 clearValue = float4(0.0f, 0.0f, 0.0f, 0.0f); //depth and stencil are x and y
+        IGfxResource* resource = nullptr;
+    };
+
+    RGHandle GetInput(const RGHandle& handle) const;
+    RGHandle AddResource(uint16_t index = uint16_t(-1));
+    RGHandle AddVersion(const RGHandle& input);
+    void MapHandle(const RGHandle& local, const RGHandle& handle);
+
+private:
+    RenderGraph* m_pGraph;
+    uint16_t m_nID;
+    bool m_bMerged = false;
+
+    LinearAllocator m_allocator { 256 * 1024 };
+
+    struct ObjFinalizer
+    {
+        void* obj;
+        void(*finalizer)(void*);
+    };
+    eastl::vector<ObjFinalizer> m_objFinalizer;
+
+    eastl::vector<Op> m_ops;
+    eastl::vector<GfxTextureDesc> m_textureDescs;
+    eastl::vector<GfxBufferDesc> m_bufferDescs;
+
+    eastl::vector<uint16_t> m_resourceIndices; //local resource index -> index in the graph
+    eastl::vector<uint16_t> m_nodeIndices;     //local node index -> index in the graph
+};
+
+template<typename T, typename... ArgsT>
+inline T* RGSetupRecorder::Allocate(ArgsT&&... arguments)
+{
+    T* p = (T*)m_allocator.Alloc(sizeof(T), alignof(T));
+    new (p) T(arguments...);
+
+    ObjFinalizer finalizer;
+    finalizer.obj = p;
+    finalizer.finalizer = [](void* p) { ((T*)p)->~T(); };
+    m_objFinalizer.push_back(finalizer);
+
+    return p;
+}
@@ -0,0 +1,427 @@
+#include "render_graph.h"
+#include "utils/profiler.h"
+#include "EASTL/hash_map.h"
+#include <fstream>
+
+#define RENDER_GRAPH_TOPOLOGY_MAGIC 0x47525245 //"ERRG"
+#define RENDER_GRAPH_TOPOLOGY_VERSION 3
+
+struct RenderGraphTopologyHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t resourceCount;
+    uint32_t nodeCount;
+    uint32_t passCount;
+    uint32_t edgeCount;
+    uint32_t outputCount;
+};
+
+enum RenderGraphTopologyFlag : uint8_t
+{
+    RGTopologyFlagBuffer = 1 << 0,
+    RGTopologyFlagImported = 1 << 1,
+    RGTopologyFlagHistory = 1 << 2,
+    RGTopologyFlagPrevHistory = 1 << 3,
+
+    RGTopologyFlagPass = 1 << 4,
+    RGTopologyFlagTarget = 1 << 5,
+
+    RGTopologyFlagColorAttachment = 1 << 6,
+    RGTopologyFlagDepthAttachment = 1 << 7,
+};
+
+//passes of a loaded graph have no data and do nothing
+struct RGTopologyPassData
+{
+};
+
+template<typename T>
+inline void WriteValue(std::ofstream& os, const T& value)
+{
+    os.write((const char*)&value, sizeof(T));
+}
+
+template<typename T>
+inline T ReadValue(std::ifstream& is)
+{
+    T value = {};
+    is.read((char*)&value, sizeof(T));
+    return value;
+}
+
+inline void WriteName(std::ofstream& os, const char* name)
+{
+    uint32_t length = (uint32_t)strlen(name);
+    os.write((const char*)&length, sizeof(length));
+    os.write(name, length);
+}
+
+inline RGName ReadName(std::ifstream& is)
+{
+    uint32_t length = ReadValue<uint32_t>(is);
+
+    char name[256];
+    if (is.fail() || length > sizeof(name))
+    {
+        is.setstate(std::ios::failbit);
+        return RGName();
+    }
+
+    is.read(name, length);
+    return RGName(name, length);
+}
+
+bool RenderGraph::SaveTopology(const eastl::string& file) const
+{
+    CPU_EVENT("Render", "RenderGraph::SaveTopology");
+
+    std::ofstream os;
+    os.open(file.c_str(), std::ios::binary);
+    if (os.fail())
+    {
+        return false;
+    }
+
+    const eastl::vector<DAGEdge*>& edges = m_graph.GetEdges();
+
+    RenderGraphTopologyHeader header;
+    header.magic = RENDER_GRAPH_TOPOLOGY_MAGIC;
+    header.version = RENDER_GRAPH_TOPOLOGY_VERSION;
+    header.resourceCount = (uint32_t)m_resources.size();
+    header.nodeCount = m_graph.GetNodeCount();
+    header.passCount = (uint32_t)m_passes.size();
+    header.edgeCount = (uint32_t)edges.size();
+    header.outputCount = (uint32_t)m_outputResources.size();
+    WriteValue(os, header);
+
+    eastl::hash_map<const RenderGraphResource*, uint32_t> resource_indices;
+
+    for (uint32_t i = 0; i < header.resourceCount; ++i)
+    {
+        const RenderGraphResource* resource = m_resources[i];
+        resource_indices.insert(eastl::make_pair(resource, i));
+
+        const RGTexture* texture = dynamic_cast<const RGTexture*>(resource);
+
+        uint8_t flags = 0;
+        if (texture == nullptr) flags |= RGTopologyFlagBuffer;
+        if (resource->IsImported()) flags |= RGTopologyFlagImported;
+        if (resource->IsHistory()) flags |= RGTopologyFlagHistory;
+        if (resource->IsPrevHistory()) flags |= RGTopologyFlagPrevHistory;
+        WriteValue(os, flags);
+
+        //history textures are loaded with the name passed to CreateHistory/ImportPrevHistory, so both frames share them
+        WriteName(os, resource->IsHistory() ? texture->GetHistoryName().c_str() : resource->GetName());
+        WriteValue(os, (uint32_t)((RenderGraphResource*)resource)->GetInitialState());
+
+        if (texture)
+        {
+            WriteValue(os, texture->GetDesc());
+        }
+        else
+        {
+            WriteValue(os, ((const RGBuffer*)resource)->GetDesc());
+        }
+    }
+
+    for (uint32_t i = 0; i < header.nodeCount; ++i)
+    {
+        const DAGNode* node = m_graph.GetNode(i);
+        const RenderGraphPassBase* pass = dynamic_cast<const RenderGraphPassBase*>(node);
+
+        uint8_t flags = 0;
+        if (pass) flags |= RGTopologyFlagPass;
+        if (node->IsTarget()) flags |= RGTopologyFlagTarget;
+        WriteValue(os, flags);
+
+        if (pass)
+        {
+            WriteName(os, pass->GetName());
+            WriteValue(os, (uint32_t)pass->GetType());
+            WriteValue(os, pass->GetViewCount());
+            WriteValue(os, (uint8_t)pass->IsAsyncComputeAllowed());
+
+            const eastl::fixed_vector<RGName, 4>& events = pass->GetEventNames();
+            WriteValue(os, (uint32_t)events.size());
+            for (size_t j = 0; j < events.size(); ++j)
+            {
+                WriteName(os, events[j].c_str());
+            }
+            WriteValue(os, pass->GetEndEventNum());
+        }
+        else
+        {
+            const RenderGraphResourceNode* resource_node = (const RenderGraphResourceNode*)node;
+            WriteValue(os, resource_indices[resource_node->GetResource()]);
+            WriteValue(os, resource_node->GetVersion());
+        }
+    }
+
+    for (uint32_t i = 0; i < header.passCount; ++i)
+    {
+        WriteValue(os, m_passes[i]->GetId());
+    }
+
+    for (uint32_t i = 0; i < header.edgeCount; ++i)
+    {
+        const RenderGraphEdge* edge = (const RenderGraphEdge*)edges[i];
+        const RenderGraphEdgeColorAttchment* color = dynamic_cast<const RenderGraphEdgeColorAttchment*>(edge);
+        const RenderGraphEdgeDepthAttchment* depth = dynamic_cast<const RenderGraphEdgeDepthAttchment*>(edge);
+
+        uint8_t flags = 0;
+        if (color) flags |= RGTopologyFlagColorAttachment;
+        if (depth) flags |= RGTopologyFlagDepthAttachment;
+        WriteValue(os, flags);
+
+        WriteValue(os, edge->GetFromNode());
+        WriteValue(os, edge->GetToNode());
+        WriteValue(os, (uint32_t)edge->GetUsage());
+        WriteValue(os, edge->GetSubresource());
+        WriteValue(os, edge->GetSubresourceCount());
+        WriteValue(os, edge->GetFirstView());
+
+        if (color)
+        {
+            WriteValue(os, color->GetColorIndex());
+            WriteValue(os, (uint32_t)color->GetLoadOp());
+            os.write((const char*)color->GetClearColor(), sizeof(float) * 4);
+        }
+        else if (depth)
+        {
+            WriteValue(os, (uint32_t)depth->GetDepthLoadOp());
+            WriteValue(os, (uint32_t)depth->GetStencilLoadOp());
+            WriteValue(os, depth->GetClearDepth());
+            WriteValue(os, depth->GetClearStencil());
+        }
+    }
+
+    for (uint32_t i = 0; i < header.outputCount; ++i)
+    {
+        WriteValue(os, resource_indices[m_outputResources[i].resource]);
+        WriteValue(os, (uint32_t)m_outputResources[i].state);
+    }
+
+    return !os.fail();
+}
+
+bool RenderGraph::LoadTopology(const eastl::string& file, IGfxDevice* pDevice, eastl::vector<eastl::unique_ptr<IGfxResource>>& imported_resources)
+{
+    CPU_EVENT("Render", "RenderGraph::LoadTopology");
+
+    RE_ASSERT(m_passes.empty() && m_resources.empty());
+
+    std::ifstream is;
+    is.open(file.c_str(), std::ios::binary);
+    if (is.fail())
+    {
+        return false;
+    }
+
+    RenderGraphTopologyHeader header = ReadValue<RenderGraphTopologyHeader>(is);
+    if (is.fail() || header.magic != RENDER_GRAPH_TOPOLOGY_MAGIC || header.version != RENDER_GRAPH_TOPOLOGY_VERSION)
+    {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < header.resourceCount && !is.fail(); ++i)
+    {
+        uint8_t flags = ReadValue<uint8_t>(is);
+        RGName name = ReadName(is);
+        GfxResourceState state = (GfxResourceState)ReadValue<uint32_t>(is);
+
+        RenderGraphResource* resource = nullptr;
+
+        if (flags & RGTopologyFlagBuffer)
+        {
+            GfxBufferDesc desc = ReadValue<GfxBufferDesc>(is);
+            if (is.fail())
+            {
+                break;
+            }
+
+            if (flags & RGTopologyFlagImported)
+            {
+                IGfxBuffer* buffer = pDevice->CreateBuffer(desc, name.c_str());
+                imported_resources.emplace_back(buffer);
+                resource = Allocate<RGBuffer>(m_resourceAllocator, buffer, state);
+            }
+            else
+            {
+                resource = Allocate<RGBuffer>(m_resourceAllocator, name, desc);
+            }
+        }
+        else
+        {
+            GfxTextureDesc desc = ReadValue<GfxTextureDesc>(is);
+            if (is.fail())
+            {
+                break;
+            }
+
+            if (flags & RGTopologyFlagImported)
+            {
+                IGfxTexture* texture = pDevice->CreateTexture(desc, name.c_str());
+                imported_resources.emplace_back(texture);
+                resource = Allocate<RGTexture>(m_resourceAllocator, texture, state);
+            }
+            else if (flags & RGTopologyFlagHistory)
+            {
+                resource = Allocate<RGTexture>(m_resourceAllocator, name, desc, (flags & RGTopologyFlagPrevHistory) != 0);
+            }
+            else
+            {
+                resource = Allocate<RGTexture>(m_resourceAllocator, name, desc);
+            }
+        }
+
+        m_resources.push_back(resource);
+    }
+
+    eastl::function<void(const RGTopologyPassData&, IGfxCommandList*)> execute = [](const RGTopologyPassData&, IGfxCommandList*) {};
+    eastl::function<void(const RGTopologyPassData&, uint32_t, IGfxCommandList*)> view_execute = [](const RGTopologyPassData&, uint32_t, IGfxCommandList*) {};
+
+    //nodes are created in the same order, so they have the same ids as in the captured graph
+    for (uint32_t i = 0; i < header.nodeCount && !is.fail(); ++i)
+    {
+        uint8_t flags = ReadValue<uint8_t>(is);
+        DAGNode* node = nullptr;
+
+        if (flags & RGTopologyFlagPass)
+        {
+            RGName name = ReadName(is);
+            RenderPassType type = (RenderPassType)ReadValue<uint32_t>(is);
+            uint32_t view_count = ReadValue<uint32_t>(is);
+            bool async_compute_allowed = ReadValue<uint8_t>(is) != 0;
+            if (is.fail() || view_count == 0 || (view_count > 1 && type == RenderPassType::Graphics))
+            {
+                return false;
+            }
+
+            RenderGraphPassBase* pass;
+            if (view_count > 1)
+            {
+                pass = Allocate<RenderGraphMultiViewPass<RGTopologyPassData>>(name, type, view_count, m_graph, view_execute);
+            }
+            else
+            {
+                pass = Allocate<RenderGraphPass<RGTopologyPassData>>(name, type, m_graph, execute);
+            }
+
+            if (async_compute_allowed)
+            {
+                pass->AllowAsyncCompute();
+            }
+
+            uint32_t event_count = ReadValue<uint32_t>(is);
+            for (uint32_t j = 0; j < event_count && !is.fail(); ++j)
+            {
+                pass->BeginEvent(ReadName(is));
+            }
+
+            uint32_t end_event_count = ReadValue<uint32_t>(is);
+            for (uint32_t j = 0; j < end_event_count && !is.fail(); ++j)
+            {
+                pass->EndEvent();
+            }
+
+            node = pass;
+        }
+        else
+        {
+            uint32_t resource = ReadValue<uint32_t>(is);
+            uint32_t version = ReadValue<uint32_t>(is);
+            if (is.fail() || resource >= m_resources.size())
+            {
+                return false;
+            }
+
+            RenderGraphResourceNode* resource_node = AllocatePOD<RenderGraphResourceNode>(m_graph, m_resources[resource], version);
+            m_resourceNodes.push_back(resource_node);
+
+            node = resource_node;
+        }
+
+        if (flags & RGTopologyFlagTarget)
+        {
+            node->MakeTarget();
+        }
+    }
+
+    for (uint32_t i = 0; i < header.passCount && !is.fail(); ++i)
+    {
+        DAGNodeID id = ReadValue<DAGNodeID>(is);
+        if (id >= m_graph.GetNodeCount())
+        {
+            return false;
+        }
+
+        RenderGraphPassBase* pass = dynamic_cast<RenderGraphPassBase*>(m_graph.GetNode(id));
+        if (pass == nullptr)
+        {
+            return false;
+        }
+
+        m_passes.push_back(pass);
+    }
+
+    for (uint32_t i = 0; i < header.edgeCount && !is.fail(); ++i)
+    {
+        uint8_t flags = ReadValue<uint8_t>(is);
+        DAGNodeID from = ReadValue<DAGNodeID>(is);
+        DAGNodeID to = ReadValue<DAGNodeID>(is);
+        GfxResourceState usage = (GfxResourceState)ReadValue<uint32_t>(is);
+        uint32_t subresource = ReadValue<uint32_t>(is);
+        uint32_t subresource_count = ReadValue<uint32_t>(is);
+        uint32_t first_view = ReadValue<uint32_t>(is);
+
+        if (is.fail() || from >= m_graph.GetNodeCount() || to >= m_graph.GetNodeCount())
+        {
+            return false;
+        }
+
+        DAGNode* from_node = m_graph.GetNode(from);
+        DAGNode* to_node = m_graph.GetNode(to);
+
+        if (flags & RGTopologyFlagColorAttachment)
+        {
+            uint32_t color_index = ReadValue<uint32_t>(is);
+            GfxRenderPassLoadOp load_op = (GfxRenderPassLoadOp)ReadValue<uint32_t>(is);
+            float4 clear_color = ReadValue<float4>(is);
+
+            AllocatePOD<RenderGraphEdgeColorAttchment>(m_graph, from_node, to_node, usage, subresource, color_index, load_op, clear_color);
+        }
+        else if (flags & RGTopologyFlagDepthAttachment)
+        {
+            GfxRenderPassLoadOp depth_load_op = (GfxRenderPassLoadOp)ReadValue<uint32_t>(is);
+            GfxRenderPassLoadOp stencil_load_op = (GfxRenderPassLoadOp)ReadValue<uint32_t>(is);
+            float clear_depth = ReadValue<float>(is);
+            uint32_t clear_stencil = ReadValue<uint32_t>(is);
+
+            AllocatePOD<RenderGraphEdgeDepthAttchment>(m_graph, from_node, to_node, usage, subresource, depth_load_op, stencil_load_op, clear_depth, clear_stencil);
+        }
+        else
+        {
+            AllocatePOD<RenderGraphEdge>(m_graph, from_node, to_node, usage, subresource, subresource_count, first_view);
+        }
+    }
+
+    for (uint32_t i = 0; i < header.outputCount && !is.fail(); ++i)
+    {
+        uint32_t resource = ReadValue<uint32_t>(is);
+        GfxResourceState state = (GfxResourceState)ReadValue<uint32_t>(is);
+        if (is.fail() || resource >= m_resources.size())
+        {
+            return false;
+        }
+
+        m_resources[resource]->SetOutput(true);
+
+        PresentTarget target;
+        target.resource = m_resources[resource];
+        target.state = state;
+        m_outputResources.push_back(target);
+    }
+
+    return !is.fail() && m_resources.size() == header.resourceCount && m_graph.GetNodeCount() == header.nodeCount;
+}
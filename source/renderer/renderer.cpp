@@ -47,6 +47,8 @@ void Renderer::CreateDevice(void* window_handle, uint32_t window_width, uint32_t
     desc.max_frame_lag = GFX_MAX_INFLIGHT_FRAMES;
     m_pDevice.reset(CreateGfxDevice(desc));
 
+    m_pPipelineCache->LoadPipelineCache(Engine::GetInstance()->GetWorkPath() + "pipeline_cache.bin");
+
     GfxSwapchainDesc swapchainDesc;
     swapchainDesc.window_handle = window_handle;
     swapchainDesc.width = window_width;
@@ -81,7 +83,7 @@ void Renderer::CreateDevice(void* window_handle, uint32_t window_width, uint32_t
 
     CreateCommonResources();
 
-    m_pRenderGraph = eastl::make_unique<RenderGraph>(this);
+    m_pRenderGraph = eastl::make_unique<RenderGraph>(m_pDevice.get());
     m_pGpuScene = eastl::make_unique<GpuScene>(this);
     m_pHZB = eastl::make_unique<HZB>(this);
     m_pBasePass = eastl::make_unique<BasePass>(this);
@@ -94,6 +96,17 @@ void Renderer::CreateDevice(void* window_handle, uint32_t window_width, uint32_t
     m_pSkyCubeMap = eastl::make_unique<SkyCubeMap>(this);
 }
 
+void Renderer::CreateHeadlessDevice(GfxRenderBackend backend)
+{
+    GfxDeviceDesc desc;
+    desc.backend = backend;
+    desc.max_frame_lag = GFX_MAX_INFLIGHT_FRAMES;
+    m_pDevice.reset(CreateGfxDevice(desc));
+
+    m_pFrameFence.reset(m_pDevice->CreateFence("Renderer::m_pFrameFence"));
+    m_pRenderGraph = eastl::make_unique<RenderGraph>(m_pDevice.get());
+}
+
 void Renderer::RenderFrame()
 {
     CPU_EVENT("Render", "Renderer::RenderFrame");
@@ -110,6 +123,18 @@ void Renderer::BeginFrame()
 {
     CPU_EVENT("Render", "Renderer::BeginFrame");
 
+    //shaders and PSOs requested since the last frame are compiled on the worker threads,
+    //in the async creation mode, only the PSOs which can't be skipped are waited for
+    if (m_pPipelineCache->IsAsyncCreation())
+    {
+        m_pPipelineCache->Update();
+    }
+    else
+    {
+        m_pPipelineCache->WaitForCreation();
+        m_pShaderCache->WaitForCompilation();
+    }
+
     uint32_t frame_index = m_pDevice->GetFrameID() % GFX_MAX_INFLIGHT_FRAMES;
     {
         CPU_EVENT("Render", "IGfxFence::Wait");
@@ -190,6 +215,17 @@ void Renderer::FlushComputePass(IGfxCommandList* pCommandList)
             DispatchBatch(pCommandList, m_animationBatchs[i]);
         }
 
+        if (!m_skinnedMeshletBatchs.empty())
+        {
+            //meshlet bounds are computed from the skinned positions
+            pCommandList->UavBarrier(m_pGpuScene->GetSceneAnimationBuffer());
+
+            for (size_t i = 0; i < m_skinnedMeshletBatchs.size(); ++i)
+            {
+                DispatchBatch(pCommandList, m_skinnedMeshletBatchs[i]);
+            }
+        }
+
         m_pGpuScene->EndAnimationUpdate(pCommandList);
     }
 }
@@ -335,26 +371,25 @@ void Renderer::SetupGlobalConstants(IGfxCommandList* pCommandList)
     pCommandList->SetComputeConstants(4, &sceneCB, sizeof(sceneCB));
 }
 
-void Renderer::ImportPrevFrameTextures()
+void Renderer::ImportHistoryTextures()
 {
-    if (m_pPrevLinearDepthTexture == nullptr ||
-        m_pPrevLinearDepthTexture->GetTexture()->GetDesc().width != m_nRenderWidth ||
-        m_pPrevLinearDepthTexture->GetTexture()->GetDesc().height != m_nRenderHeight)
-    {
-        m_pPrevLinearDepthTexture.reset(CreateTexture2D(m_nRenderWidth, m_nRenderHeight, 1, GfxFormat::R32F, GfxTextureUsageUnorderedAccess, "Prev LinearDepth"));
-        m_pPrevNormalTexture.reset(CreateTexture2D(m_nRenderWidth, m_nRenderHeight, 1, GfxFormat::RGBA8UNORM, GfxTextureUsageUnorderedAccess, "Prev Normal"));
-        m_pPrevSceneColorTexture.reset(CreateTexture2D(m_nRenderWidth, m_nRenderHeight, 1, GfxFormat::RGBA16F, GfxTextureUsageUnorderedAccess, "Prev SceneColor"));
+    //written by LinearizeDepthPass, BasePass and the scene color passes in the last frame
+    RGTexture::Desc desc;
+    desc.width = m_nRenderWidth;
+    desc.height = m_nRenderHeight;
 
-        m_bHistoryValid = false;
-    }
-    else
-    {
-        m_bHistoryValid = true;
-    }
+    desc.format = GfxFormat::R32F;
+    m_prevLinearDepthHandle = m_pRenderGraph->ImportPrevHistory(desc, "LinearDepth RT");
+
+    desc.format = GfxFormat::RGBA8UNORM;
+    m_prevNormalHandle = m_pRenderGraph->ImportPrevHistory(desc, "Normal RT");
 
-    m_prevLinearDepthHandle = m_pRenderGraph->Import(m_pPrevLinearDepthTexture->GetTexture(), m_bHistoryValid ? GfxResourceState::CopyDst : GfxResourceState::UnorderedAccess);
-    m_prevNormalHandle = m_pRenderGraph->Import(m_pPrevNormalTexture->GetTexture(), m_bHistoryValid ? GfxResourceState::CopyDst : GfxResourceState::UnorderedAccess);
-    m_prevSceneColorHandle = m_pRenderGraph->Import(m_pPrevSceneColorTexture->GetTexture(), m_bHistoryValid ? GfxResourceState::CopyDst : GfxResourceState::UnorderedAccess);
+    desc.format = GfxFormat::RGBA16F;
+    m_prevSceneColorHandle = m_pRenderGraph->ImportPrevHistory(desc, "SceneColor RT");
+
+    m_bHistoryValid = m_pRenderGraph->IsHistoryValid("LinearDepth RT") &&
+        m_pRenderGraph->IsHistoryValid("Normal RT") &&
+        m_pRenderGraph->IsHistoryValid("SceneColor RT");
 
     if (!m_bHistoryValid)
     {
@@ -374,10 +409,14 @@ void Renderer::ImportPrevFrameTextures()
             },
             [=](const ClearHistoryPassData& data, IGfxCommandList* pCommandList)
             {
+                RGTexture* linearDepth = m_pRenderGraph->GetTexture(data.linearDepth);
+                RGTexture* normal = m_pRenderGraph->GetTexture(data.normal);
+                RGTexture* color = m_pRenderGraph->GetTexture(data.color);
+
                 float clear_value[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
-                pCommandList->ClearUAV(m_pPrevLinearDepthTexture->GetTexture(), m_pPrevLinearDepthTexture->GetUAV(), clear_value);
-                pCommandList->ClearUAV(m_pPrevNormalTexture->GetTexture(), m_pPrevNormalTexture->GetUAV(), clear_value);
-                pCommandList->ClearUAV(m_pPrevSceneColorTexture->GetTexture(), m_pPrevSceneColorTexture->GetUAV(), clear_value);
+                pCommandList->ClearUAV(linearDepth->GetTexture(), linearDepth->GetUAV(), clear_value);
+                pCommandList->ClearUAV(normal->GetTexture(), normal->GetUAV(), clear_value);
+                pCommandList->ClearUAV(color->GetTexture(), color->GetUAV(), clear_value);
             });
 
         m_prevLinearDepthHandle = clear_pass->linearDepth;
@@ -399,13 +438,16 @@ void Renderer::Render()
     GPU_EVENT_PROFILER(pCommandList, "Render Frame");
 
     m_pRenderGraph->Clear();
+    m_pRenderGraph->SetParallelSetup(m_bEnableParallelSetup ? Engine::GetInstance()->GetTaskScheduler() : nullptr);
     m_pGpuScene->Update();
     
-    ImportPrevFrameTextures();
+    ImportHistoryTextures();
 
     RGHandle outputColorHandle, outputDepthHandle;
     BuildRenderGraph(outputColorHandle, outputDepthHandle);
 
+    m_pRenderGraph->SetPassReordering(m_bEnablePassReordering);
+    m_pRenderGraph->SetAsyncComputeScheduling(m_bEnableAsyncCompute);
     m_pRenderGraph->Compile();
 
     m_pGpuDebugLine->Clear(pCommandList);
@@ -510,6 +552,7 @@ void Renderer::EndFrame()
     m_pGpuScene->ResetFrameData();
 
     m_animationBatchs.clear();
+    m_skinnedMeshletBatchs.clear();
     m_forwardPassBatchs.clear();
     m_velocityPassBatchs.clear();
     m_idPassBatchs.clear();
@@ -554,6 +597,8 @@ void Renderer::MouseHitTest()
 
 void Renderer::ReloadShaders()
 {
+    m_pPipelineCache->WaitForCreation();
+    m_pShaderCache->WaitForCompilation();
     m_pShaderCache->ReloadShaders();
 }
 
@@ -562,19 +607,29 @@ IGfxShader* Renderer::GetShader(const eastl::string& file, const eastl::string&
     return m_pShaderCache->GetShader(file, entry_point, profile, defines, flags);
 }
 
-IGfxPipelineState* Renderer::GetPipelineState(const GfxGraphicsPipelineDesc& desc, const eastl::string& name)
+IGfxShader* Renderer::GetShader(const ShaderPermutation& permutation)
+{
+    return m_pShaderCache->GetShader(permutation);
+}
+
+IGfxShader* Renderer::GetShader(ShaderKey key) const
+{
+    return m_pShaderCache->GetShader(key);
+}
+
+IGfxPipelineState* Renderer::GetPipelineState(const GfxGraphicsPipelineDesc& desc, const char* name, bool async)
 {
-    return m_pPipelineCache->GetPipelineState(desc, name);
+    return m_pPipelineCache->GetPipelineState(desc, name, async);
 }
 
-IGfxPipelineState* Renderer::GetPipelineState(const GfxMeshShadingPipelineDesc& desc, const eastl::string& name)
+IGfxPipelineState* Renderer::GetPipelineState(const GfxMeshShadingPipelineDesc& desc, const char* name, bool async)
 {
-    return m_pPipelineCache->GetPipelineState(desc, name);
+    return m_pPipelineCache->GetPipelineState(desc, name, async);
 }
 
-IGfxPipelineState* Renderer::GetPipelineState(const GfxComputePipelineDesc& desc, const eastl::string& name)
+IGfxPipelineState* Renderer::GetPipelineState(const GfxComputePipelineDesc& desc, const char* name, bool async)
 {
-    return m_pPipelineCache->GetPipelineState(desc, name);
+    return m_pPipelineCache->GetPipelineState(desc, name, async);
 }
 
 void Renderer::CreateCommonResources()
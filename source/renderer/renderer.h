@@ -1,6 +1,7 @@
 #pragma once
 
 #include "render_graph.h"
+#include "shader_cache.h"
 #include "render_batch.h"
 #include "gpu_scene.h"
 #include "resource/texture_2d.h"
@@ -47,6 +48,8 @@ public:
     ~Renderer();
 
     void CreateDevice(void* window_handle, uint32_t window_width, uint32_t window_height);
+    //no swapchain and no render passes, only the shader and PSO caches can be used (see renderer_tests.h)
+    void CreateHeadlessDevice(GfxRenderBackend backend);
     void RenderFrame();
     void WaitGpuFinished();
 
@@ -72,9 +75,11 @@ public:
     IGfxDevice* GetDevice() const { return m_pDevice.get(); }
     IGfxSwapchain* GetSwapchain() const { return m_pSwapchain.get(); }
     IGfxShader* GetShader(const eastl::string& file, const eastl::string& entry_point, const eastl::string& profile, const eastl::vector<eastl::string>& defines, GfxShaderCompilerFlags flags = 0);
-    IGfxPipelineState* GetPipelineState(const GfxGraphicsPipelineDesc& desc, const eastl::string& name);
-    IGfxPipelineState* GetPipelineState(const GfxMeshShadingPipelineDesc& desc, const eastl::string& name);
-    IGfxPipelineState* GetPipelineState(const GfxComputePipelineDesc& desc, const eastl::string& name);
+    IGfxShader* GetShader(const ShaderPermutation& permutation); //for the execute lambdas, doesn't allocate once the permutation is interned
+    IGfxShader* GetShader(ShaderKey key) const;
+    IGfxPipelineState* GetPipelineState(const GfxGraphicsPipelineDesc& desc, const char* name, bool async = false);
+    IGfxPipelineState* GetPipelineState(const GfxMeshShadingPipelineDesc& desc, const char* name, bool async = false);
+    IGfxPipelineState* GetPipelineState(const GfxComputePipelineDesc& desc, const char* name, bool async = false);
     void ReloadShaders();
     IGfxDescriptor* GetPointSampler() const { return m_pPointRepeatSampler.get(); }
     IGfxDescriptor* GetLinearSampler() const { return m_pBilinearRepeatSampler.get(); }
@@ -112,6 +117,12 @@ public:
     bool IsAsyncComputeEnabled() const { return m_bEnableAsyncCompute; }
     void SetAsyncComputeEnabled(bool value) { m_bEnableAsyncCompute = value; }
 
+    bool IsPassReorderingEnabled() const { return m_bEnablePassReordering; }
+    void SetPassReorderingEnabled(bool value) { m_bEnablePassReordering = value; }
+
+    bool IsParallelSetupEnabled() const { return m_bEnableParallelSetup; }
+    void SetParallelSetupEnabled(bool value) { m_bEnableParallelSetup = value; }
+
     void UploadTexture(IGfxTexture* texture, const void* data);
     void UploadBuffer(IGfxBuffer* buffer, uint32_t offset, const void* data, uint32_t data_size);
     void BuildRayTracingBLAS(IGfxRayTracingBLAS* blas);
@@ -123,6 +134,7 @@ public:
     RenderBatch& AddVelocityPassBatch() { return m_velocityPassBatchs.emplace_back(*m_cbAllocator); }
     RenderBatch& AddObjectIDPassBatch() { return m_idPassBatchs.emplace_back(*m_cbAllocator); }
     ComputeBatch& AddAnimationBatch() { return m_animationBatchs.emplace_back(*m_cbAllocator); }
+    ComputeBatch& AddSkinnedMeshletBatch() { return m_skinnedMeshletBatchs.emplace_back(*m_cbAllocator); } //runs after all animation batches
 
     void SetupGlobalConstants(IGfxCommandList* pCommandList);
 
@@ -132,9 +144,9 @@ public:
     StagingBufferAllocator* GetStagingBufferAllocator() const;
 
     bool IsHistoryTextureValid() const { return m_bHistoryValid; }
-    Texture2D* GetPrevLinearDepthTexture() const { return m_pPrevLinearDepthTexture.get(); }
-    Texture2D* GetPrevNormalTexture() const { return m_pPrevNormalTexture.get(); }
-    Texture2D* GetPrevSceneColorTexture() const { return m_pPrevSceneColorTexture.get(); }
+    RGTexture* GetPrevLinearDepthTexture() const { return m_pRenderGraph->GetTexture(m_prevLinearDepthHandle); }
+    RGTexture* GetPrevNormalTexture() const { return m_pRenderGraph->GetTexture(m_prevNormalHandle); }
+    RGTexture* GetPrevSceneColorTexture() const { return m_pRenderGraph->GetTexture(m_prevSceneColorHandle); }
     RGHandle GetPrevLinearDepthHandle() const { return m_prevLinearDepthHandle; }
     RGHandle GetPrevNormalHandle() const { return m_prevNormalHandle; }
     RGHandle GetPrevSceneColorHandle() const { return m_prevSceneColorHandle; }
@@ -155,11 +167,10 @@ private:
     RGHandle VelocityPass(RGHandle& depth);
     RGHandle LinearizeDepthPass(RGHandle depth);
     void ObjectIDPass(RGHandle& depth);
-    void CopyHistoryPass(RGHandle linearDepth, RGHandle normal, RGHandle sceneColor);
 
     void FlushComputePass(IGfxCommandList* pCommandList);
     void BuildRayTracingAS(IGfxCommandList* pCommandList, IGfxCommandList* pComputeCommandList);
-    void ImportPrevFrameTextures();
+    void ImportHistoryTextures();
     void RenderBackbufferPass(IGfxCommandList* pCommandList, RGHandle color, RGHandle depth);
     void CopyToBackbuffer(IGfxCommandList* pCommandList, RGHandle color, RGHandle depth, bool needUpscaleDepth);
     void MouseHitTest();
@@ -259,9 +270,6 @@ private:
     eastl::unique_ptr<Texture2D> m_pPreintegratedGFTexture;
     eastl::unique_ptr<Texture2D> m_pSheenETexture;
 
-    eastl::unique_ptr<Texture2D> m_pPrevLinearDepthTexture;
-    eastl::unique_ptr<Texture2D> m_pPrevNormalTexture;
-    eastl::unique_ptr<Texture2D> m_pPrevSceneColorTexture;
     RGHandle m_prevLinearDepthHandle;
     RGHandle m_prevNormalHandle;
     RGHandle m_prevSceneColorHandle;
@@ -273,6 +281,8 @@ private:
     bool m_bGpuDrivenStatsEnabled = false;
     bool m_bShowMeshlets = false;
     bool m_bEnableAsyncCompute = false;
+    bool m_bEnablePassReordering = false;
+    bool m_bEnableParallelSetup = false;
 
     bool m_bEnableObjectIDRendering = false;
     uint32_t m_nMouseX = 0;
@@ -296,6 +306,7 @@ private:
     eastl::unique_ptr<class GpuDrivenStats> m_pGpuStats;
 
     eastl::vector<ComputeBatch> m_animationBatchs;
+    eastl::vector<ComputeBatch> m_skinnedMeshletBatchs;
 
     eastl::vector<RenderBatch> m_forwardPassBatchs;
     eastl::vector<RenderBatch> m_velocityPassBatchs;
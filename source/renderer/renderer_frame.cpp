@@ -16,9 +16,11 @@ void Renderer::BuildRenderGraph(RGHandle& outColor, RGHandle& outDepth)
 
     RGHandle sceneDepthRT = m_pBasePass->GetDepthRT();
     RGHandle velocityRT = VelocityPass(sceneDepthRT);
-    RGHandle linearDepthRT = LinearizeDepthPass(sceneDepthRT);
+    RGHandle linearDepthRT;
 
-    m_pHZB->GenerateSceneHZB(m_pRenderGraph.get(), sceneDepthRT);
+    m_pRenderGraph->RunSetupTasks({
+        [&]() { linearDepthRT = LinearizeDepthPass(sceneDepthRT); },
+        [&]() { m_pHZB->GenerateSceneHZB(m_pRenderGraph.get(), sceneDepthRT); } });
 
     RGHandle sceneColorRT;
     if (m_outputType == RendererOutput::PathTracing)
@@ -32,14 +34,20 @@ void Renderer::BuildRenderGraph(RGHandle& outColor, RGHandle& outDepth)
         ForwardPass(sceneColorRT, sceneDepthRT);
     }
 
-    RGHandle output = m_pPostProcessor->Render(m_pRenderGraph.get(), sceneColorRT, sceneDepthRT, linearDepthRT, velocityRT,
-        m_nRenderWidth, m_nRenderHeight, m_nDisplayWidth, m_nDisplayHeight);
+    //the object id pass writes a new version of the depth, the post processing reads the version before it
+    RGHandle output;
+    RGHandle objectIDDepthRT = sceneDepthRT;
 
-    ObjectIDPass(sceneDepthRT);
-    CopyHistoryPass(linearDepthRT, m_pBasePass->GetNormalRT(), sceneColorRT);
+    m_pRenderGraph->RunSetupTasks({
+        [&]()
+        {
+            output = m_pPostProcessor->Render(m_pRenderGraph.get(), sceneColorRT, sceneDepthRT, linearDepthRT, velocityRT,
+                m_nRenderWidth, m_nRenderHeight, m_nDisplayWidth, m_nDisplayHeight);
+        },
+        [&]() { ObjectIDPass(objectIDDepthRT); } });
 
     outColor = output;
-    outDepth = sceneDepthRT;
+    outDepth = objectIDDepthRT;
 
     m_pRenderGraph->Present(outColor, GfxResourceState::ShaderResourcePS);
     m_pRenderGraph->Present(outDepth, GfxResourceState::DepthStencilReadOnly);
@@ -116,7 +124,7 @@ RGHandle Renderer::VelocityPass(RGHandle& depth)
         [=](const CameraVelocityPassData& data, IGfxCommandList* pCommandList)
         {
             GfxComputePipelineDesc psoDesc;
-            psoDesc.cs = GetShader("velocity.hlsl", "main", "cs_6_6", {});
+            psoDesc.cs = GetShader(ShaderPermutation("velocity.hlsl", "main", "cs_6_6"));
             IGfxPipelineState* pPSO = GetPipelineState(psoDesc, "Velocity PSO");
 
             pCommandList->SetPipelineState(pPSO);
@@ -148,7 +156,7 @@ RGHandle Renderer::LinearizeDepthPass(RGHandle depth)
             desc.width = m_nRenderWidth;
             desc.height = m_nRenderHeight;
             desc.format = GfxFormat::R32F;
-            data.outputLinearDepthRT = builder.Create<RGTexture>(desc, "LinearDepth RT");
+            data.outputLinearDepthRT = builder.CreateHistory(desc, "LinearDepth RT");
 
             data.inputDepthRT = builder.Read(depth);
             data.outputLinearDepthRT = builder.Write(data.outputLinearDepthRT);
@@ -156,7 +164,7 @@ RGHandle Renderer::LinearizeDepthPass(RGHandle depth)
         [&](const LinearizeDepthPassData& data, IGfxCommandList* pCommandList)
         {
             GfxComputePipelineDesc psoDesc;
-            psoDesc.cs = GetShader("linearize_depth.hlsl", "main", "cs_6_6", {});
+            psoDesc.cs = GetShader(ShaderPermutation("linearize_depth.hlsl", "main", "cs_6_6"));
             IGfxPipelineState* pPSO = GetPipelineState(psoDesc, "LinearizeDepth PSO");
 
             pCommandList->SetPipelineState(pPSO);
@@ -236,43 +244,3 @@ void Renderer::ObjectIDPass(RGHandle& depth)
             });
     }
 }
-
-void Renderer::CopyHistoryPass(RGHandle linearDepth, RGHandle normal, RGHandle sceneColor)
-{
-    struct CopyPassData
-    {
-        RGHandle srcLinearDepthTexture;
-        RGHandle dstLinearDepthTexture;
-
-        RGHandle srcNormalTexture;
-        RGHandle dstNormalTexture;
-
-        RGHandle srcSceneColorTexture;
-        RGHandle dstSceneColorTexture;
-    };
-
-    m_pRenderGraph->AddPass<CopyPassData>("Copy History Textures", RenderPassType::Copy,
-        [&](CopyPassData& data, RGBuilder& builder)
-        {
-            data.srcLinearDepthTexture = builder.Read(linearDepth);
-            data.dstLinearDepthTexture = builder.Write(m_prevLinearDepthHandle);
-
-            data.srcNormalTexture = builder.Read(normal);
-            data.dstNormalTexture = builder.Write(m_prevNormalHandle);
-
-            data.srcSceneColorTexture = builder.Read(sceneColor);
-            data.dstSceneColorTexture = builder.Write(m_prevSceneColorHandle);
-
-            builder.SkipCulling();
-        },
-        [&](const CopyPassData& data, IGfxCommandList* pCommandList)
-        {
-            RGTexture* srcLinearDepthTexture = m_pRenderGraph->GetTexture(data.srcLinearDepthTexture);
-            RGTexture* srcNormalTexture = m_pRenderGraph->GetTexture(data.srcNormalTexture);
-            RGTexture* srcSceneColorTexture = m_pRenderGraph->GetTexture(data.srcSceneColorTexture);
-
-            pCommandList->CopyTexture(m_pPrevLinearDepthTexture->GetTexture(), 0, 0, srcLinearDepthTexture->GetTexture(), 0, 0);
-            pCommandList->CopyTexture(m_pPrevNormalTexture->GetTexture(), 0, 0, srcNormalTexture->GetTexture(), 0, 0);
-            pCommandList->CopyTexture(m_pPrevSceneColorTexture->GetTexture(), 0, 0, srcSceneColorTexture->GetTexture(), 0, 0);
-        });
-}
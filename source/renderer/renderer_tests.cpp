@@ -0,0 +1,313 @@
+#include "renderer_tests.h"
+#include "renderer.h"
+#include "shader_cache.h"
+#include "pipeline_cache.h"
+#include "gfx/gfx.h"
+#include "gfx/mock/mock_device.h"
+#include "core/engine.h"
+#include "utils/log.h"
+
+static bool Check(bool condition, const char* test, const char* message)
+{
+    if (!condition)
+    {
+        RE_LOG("{} failed : {}", test, message);
+    }
+    return condition;
+}
+
+struct TestPassData
+{
+    RGHandle output;
+};
+
+static RGTexture::Desc GetTestTextureDesc(uint32_t size, GfxFormat format)
+{
+    RGTexture::Desc desc;
+    desc.width = size;
+    desc.height = size;
+    desc.format = format;
+    return desc;
+}
+
+//depth -> ao (compute) -> composite, with an independent shading pass the ao pass can overlap
+static RenderGraphPassBase* BuildAsyncComputeGraph(RenderGraph* graph, bool allow_async_compute)
+{
+    auto& depth_pass = graph->AddPass<TestPassData>("Depth", RenderPassType::Graphics,
+        [&](TestPassData& data, RGBuilder& builder)
+        {
+            data.output = builder.Create<RGTexture>(GetTestTextureDesc(1024, GfxFormat::R32F), "Depth");
+            data.output = builder.WriteColor(0, data.output, 0, GfxRenderPassLoadOp::Clear);
+        },
+        [](const TestPassData& data, IGfxCommandList* pCommandList) {});
+
+    auto& ao_pass = graph->AddPass<TestPassData>("AO", RenderPassType::Compute,
+        [&](TestPassData& data, RGBuilder& builder)
+        {
+            if (allow_async_compute)
+            {
+                builder.AllowAsyncCompute();
+            }
+
+            builder.Read(depth_pass.GetData().output);
+
+            data.output = builder.Create<RGTexture>(GetTestTextureDesc(1024, GfxFormat::R8UNORM), "AO");
+            data.output = builder.Write(data.output);
+        },
+        [](const TestPassData& data, IGfxCommandList* pCommandList) {});
+
+    auto& shading_pass = graph->AddPass<TestPassData>("Shading", RenderPassType::Graphics,
+        [&](TestPassData& data, RGBuilder& builder)
+        {
+            data.output = builder.Create<RGTexture>(GetTestTextureDesc(2048, GfxFormat::RGBA16F), "Shading");
+            data.output = builder.WriteColor(0, data.output, 0, GfxRenderPassLoadOp::Clear);
+        },
+        [](const TestPassData& data, IGfxCommandList* pCommandList) {});
+
+    graph->AddPass<TestPassData>("Composite", RenderPassType::Graphics,
+        [&](TestPassData& data, RGBuilder& builder)
+        {
+            builder.Read(ao_pass.GetData().output);
+            builder.Read(shading_pass.GetData().output);
+
+            data.output = builder.Create<RGTexture>(GetTestTextureDesc(2048, GfxFormat::RGBA8UNORM), "Composite");
+            data.output = builder.WriteColor(0, data.output, 0, GfxRenderPassLoadOp::DontCare);
+
+            builder.SkipCulling();
+        },
+        [](const TestPassData& data, IGfxCommandList* pCommandList) {});
+
+    return &ao_pass;
+}
+
+bool TestAsyncComputeScheduling()
+{
+    bool result = true;
+
+    //the scheduler alone : a candidate which can't pay for the fences stays on the graphics queue
+    {
+        const char* test = "async compute scheduler";
+
+        eastl::vector<RGAsyncComputePass> passes(4);
+        passes[0].cost = 100.0f;
+        passes[1].candidate = true;
+        passes[1].cost = 100.0f;
+        passes[1].dependencies.push_back(0);
+        passes[1].dependents.push_back(3);
+        passes[2].cost = 100.0f;
+        passes[3].cost = 100.0f;
+        passes[3].dependencies.push_back(1);
+
+        RGAsyncComputeScheduler scheduler;
+        RGAsyncComputeSchedule schedule;
+
+        scheduler.SetFenceCost(50.0f);
+        scheduler.Schedule(passes, schedule);
+        result &= Check(schedule.movedPasses.size() == 1 && schedule.movedPasses[0] == 1, test, "the candidate is not moved");
+        result &= Check(schedule.batches.size() == 1 && schedule.batches[0].waitPass == 0 && schedule.batches[0].signalPass == 3, test, "wrong fence passes");
+        result &= Check(schedule.batches.size() == 1 && schedule.batches[0].overlap == 100.0f, test, "wrong overlap");
+
+        scheduler.SetFenceCost(200.0f);
+        scheduler.Schedule(passes, schedule);
+        result &= Check(schedule.movedPasses.empty() && schedule.batches.empty(), test, "the candidate is moved though it is cheaper than the fences");
+    }
+
+    GfxDeviceDesc desc;
+    desc.backend = GfxRenderBackend::Mock;
+    eastl::unique_ptr<IGfxDevice> device(CreateGfxDevice(desc));
+
+    //declared after the device, it is destroyed first
+    eastl::unique_ptr<RenderGraph> graph = eastl::make_unique<RenderGraph>(device.get());
+    graph->SetAsyncComputeScheduling(true);
+    graph->GetAsyncComputeScheduler().SetFenceCost(0.0f);
+
+    //synthetic graphs compiled on the mock device
+    {
+        const char* test = "async compute graph";
+
+        device->BeginFrame();
+        graph->Clear();
+
+        RenderGraphPassBase* ao_pass = BuildAsyncComputeGraph(graph.get(), true);
+        graph->Compile();
+
+        result &= Check(ao_pass->GetType() == RenderPassType::AsyncCompute, test, "the pass is not moved to the async compute queue");
+        result &= Check(ao_pass->GetWaitGraphicsPassID() != UINT32_MAX && ao_pass->GetSignalGraphicsPassID() != UINT32_MAX, test, "the moved pass is not synchronized with the graphics queue");
+
+        device->EndFrame();
+    }
+
+    {
+        const char* test = "async compute opt-in";
+
+        device->BeginFrame();
+        graph->Clear();
+
+        RenderGraphPassBase* ao_pass = BuildAsyncComputeGraph(graph.get(), false);
+        graph->Compile();
+
+        result &= Check(ao_pass->GetType() == RenderPassType::Compute, test, "a pass which didn't allow async compute is moved");
+
+        device->EndFrame();
+    }
+
+    {
+        const char* test = "async compute initial state";
+
+        device->BeginFrame();
+        graph->Clear();
+
+        //nothing outputs the imported texture, so no graphics pass could transition it from the pixel shader state for the compute queue
+        eastl::unique_ptr<IGfxTexture> texture(device->CreateTexture(GetTestTextureDesc(256, GfxFormat::RGBA8UNORM), "Imported"));
+        RGHandle imported = graph->Import(texture.get(), GfxResourceState::ShaderResourcePS);
+
+        auto& async_pass = graph->AddPass<TestPassData>("Async", RenderPassType::AsyncCompute,
+            [&](TestPassData& data, RGBuilder& builder)
+            {
+                builder.Read(imported);
+
+                data.output = builder.Create<RGTexture>(GetTestTextureDesc(256, GfxFormat::RGBA8UNORM), "Output");
+                data.output = builder.Write(data.output);
+
+                builder.SkipCulling();
+            },
+            [](const TestPassData& data, IGfxCommandList* pCommandList) {});
+
+        graph->Compile();
+
+        result &= Check(async_pass.GetType() == RenderPassType::Compute, test, "the pass is not moved back to the graphics queue");
+
+        device->EndFrame();
+
+        graph->Clear();
+    }
+
+    return result;
+}
+
+//the tasks use the handles of each other only after RunSetupTasks returns, some of them run nested tasks
+static void BuildSetupTaskGraph(RenderGraph* graph)
+{
+    auto& gbuffer_pass = graph->AddPass<TestPassData>("GBuffer", RenderPassType::Graphics,
+        [&](TestPassData& data, RGBuilder& builder)
+        {
+            data.output = builder.Create<RGTexture>(GetTestTextureDesc(1024, GfxFormat::RGBA8UNORM), "GBuffer");
+            data.output = builder.WriteColor(0, data.output, 0, GfxRenderPassLoadOp::Clear);
+        },
+        [](const TestPassData& data, IGfxCommandList* pCommandList) {});
+
+    RGHandle outputs[4];
+
+    auto add_compute_pass = [&](const char* name, RGHandle input, RGHandle& output)
+    {
+        auto& pass = graph->AddPass<TestPassData>(name, RenderPassType::Compute,
+            [&](TestPassData& data, RGBuilder& builder)
+            {
+                builder.Read(input);
+
+                data.output = builder.Create<RGTexture>(GetTestTextureDesc(512, GfxFormat::R16F), name);
+                data.output = builder.Write(data.output);
+            },
+            [](const TestPassData& data, IGfxCommandList* pCommandList) {});
+
+        output = pass.GetData().output;
+    };
+
+    graph->RunSetupTasks({
+        [&]()
+        {
+            RENDER_GRAPH_EVENT(graph, "Task 0");
+            add_compute_pass("Task 0 - 0", gbuffer_pass.GetData().output, outputs[0]);
+            add_compute_pass("Task 0 - 1", outputs[0], outputs[0]);
+        },
+        [&]()
+        {
+            RENDER_GRAPH_EVENT(graph, "Task 1");
+            graph->RunSetupTasks({
+                [&]() { add_compute_pass("Task 1 - 0", gbuffer_pass.GetData().output, outputs[1]); },
+                [&]() { add_compute_pass("Task 1 - 1", gbuffer_pass.GetData().output, outputs[2]); } });
+        },
+        [&]() { add_compute_pass("Task 2", gbuffer_pass.GetData().output, outputs[3]); } });
+
+    graph->AddPass<TestPassData>("Composite", RenderPassType::Graphics,
+        [&](TestPassData& data, RGBuilder& builder)
+        {
+            for (uint32_t i = 0; i < 4; ++i)
+            {
+                builder.Read(outputs[i]);
+            }
+
+            data.output = builder.Create<RGTexture>(GetTestTextureDesc(1024, GfxFormat::RGBA8UNORM), "Composite");
+            data.output = builder.WriteColor(0, data.output, 0, GfxRenderPassLoadOp::DontCare);
+
+            builder.SkipCulling();
+        },
+        [](const TestPassData& data, IGfxCommandList* pCommandList) {});
+}
+
+bool TestParallelSetup()
+{
+    const char* test = "parallel setup";
+
+    GfxDeviceDesc desc;
+    desc.backend = GfxRenderBackend::Mock;
+    eastl::unique_ptr<IGfxDevice> device(CreateGfxDevice(desc));
+    eastl::unique_ptr<RenderGraph> graph = eastl::make_unique<RenderGraph>(device.get());
+
+    graph->SetParallelSetup(nullptr);
+    BuildSetupTaskGraph(graph.get());
+    uint64_t serial_hash = graph->GetTopologyHash();
+    graph->Clear();
+
+    graph->SetParallelSetup(Engine::GetInstance()->GetTaskScheduler());
+    BuildSetupTaskGraph(graph.get());
+    uint64_t parallel_hash = graph->GetTopologyHash();
+    graph->Clear();
+
+    return Check(serial_hash == parallel_hash, test, "the topology is different from the serial build");
+}
+
+bool TestPipelineCacheWarmUp(const eastl::string& manifest_file, const eastl::string& pipeline_cache_file)
+{
+    const char* test = "pipeline cache warm up";
+    bool result = true;
+
+    uint32_t pso_count = 0;
+
+    for (uint32_t run = 0; run < 2; ++run)
+    {
+        eastl::unique_ptr<Renderer> renderer = eastl::make_unique<Renderer>();
+        renderer->CreateHeadlessDevice(GfxRenderBackend::Mock);
+
+        MockDevice* device = (MockDevice*)renderer->GetDevice();
+        PipelineStateCache* pipelineCache = renderer->GetPipelineStateCache();
+
+        if (run == 1)
+        {
+            result &= Check(pipelineCache->LoadPipelineCache(pipeline_cache_file), test, "failed to load the pipeline cache");
+        }
+
+        //same as the startup and the first Renderer::BeginFrame
+        pipelineCache->LoadManifest(manifest_file);
+        pipelineCache->WaitForCreation();
+        renderer->GetShaderCache()->WaitForCompilation();
+
+        if (run == 0)
+        {
+            pso_count = device->GetPipelineCacheMissCount();
+            result &= Check(pso_count > 0, test, "no PSO is created from the manifest");
+            result &= Check(device->GetPipelineCacheHitCount() == 0, test, "cache hits without a pipeline cache");
+
+            pipelineCache->SavePipelineCache(pipeline_cache_file);
+        }
+        else
+        {
+            result &= Check(device->GetPipelineCacheHitCount() == pso_count, test, "not all PSOs are loaded from the pipeline cache");
+            result &= Check(device->GetPipelineCacheMissCount() == 0, test, "PSOs missing in the pipeline cache");
+        }
+
+        RE_LOG("{} : run {}, {} hits, {} misses", test, run, device->GetPipelineCacheHitCount(), device->GetPipelineCacheMissCount());
+    }
+
+    return result;
+}
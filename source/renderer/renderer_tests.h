@@ -0,0 +1,14 @@
+#pragma once
+
+#include "EASTL/string.h"
+
+//tests of the renderer side logic on the mock device, they run without a GPU.
+//the failed checks are logged, the functions return false if any of them failed
+bool TestAsyncComputeScheduling();
+
+//builds a graph with setup tasks serially and on the worker threads, the topology hashes should be the same
+bool TestParallelSetup();
+
+//warms up the PSOs of a manifest saved by PipelineStateCache::SaveManifest twice, on two mock devices.
+//the second one loads the pipeline cache saved by the first one, so all of its PSOs should be cache hits
+bool TestPipelineCacheWarmUp(const eastl::string& manifest_file, const eastl::string& pipeline_cache_file);
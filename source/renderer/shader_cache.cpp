@@ -4,13 +4,16 @@
 #include "pipeline_cache.h"
 #include "utils/log.h"
 #include "core/engine.h"
+#include "utils/parallel_for.h"
+#include "utils/profiler.h"
+#include "xxHash/xxhash.h"
+#include "enkiTS/TaskScheduler.h"
 #include <fstream>
 #include <filesystem>
-#include <regex>
 
 inline bool operator==(const GfxShaderDesc& lhs, const GfxShaderDesc& rhs)
 {
-    if (lhs.file != rhs.file || lhs.entry_point != rhs.entry_point || lhs.profile != rhs.profile)
+    if (lhs.file != rhs.file || lhs.entry_point != rhs.entry_point || lhs.profile != rhs.profile || lhs.flags != rhs.flags)
     {
         return false;
     }
@@ -53,13 +56,115 @@ static inline eastl::string LoadFile(const eastl::string& path)
     return content;
 }
 
+#define SHADER_BINARY_MAGIC 0x42535245 //"ERSB"
+#define SHADER_BINARY_VERSION 1
+
+struct ShaderBinaryHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint64_t key;
+    uint32_t includeCount; //followed by (path length, path, content hash) of each included file
+    uint32_t blobSize; //followed by the DXIL blob
+};
+
 ShaderCache::ShaderCache(Renderer* pRenderer)
 {
     m_pRenderer = pRenderer;
+    m_shaderBinaryPath = Engine::GetInstance()->GetWorkPath() + "shader_cache/";
+
+    std::error_code error;
+    std::filesystem::create_directories(m_shaderBinaryPath.c_str(), error);
+}
+
+ShaderCache::~ShaderCache()
+{
+    //the pending tasks are completed by the task scheduler shutdown, which happens before the renderer is destroyed
+}
+
+ShaderPermutation::ShaderPermutation(const char* file, const char* entry_point, const char* profile, GfxShaderCompilerFlags flags) :
+    m_file(file),
+    m_entryPoint(entry_point),
+    m_profile(profile),
+    m_flags(flags)
+{
+    m_hash = XXH3_64bits(file, strlen(file));
+    m_hash = XXH3_64bits_withSeed(entry_point, strlen(entry_point), m_hash);
+    m_hash = XXH3_64bits_withSeed(profile, strlen(profile), m_hash);
+}
+
+void ShaderPermutation::AddDefine(const char* define)
+{
+    m_defines.push_back(define);
+    m_hash = XXH3_64bits_withSeed(define, strlen(define), m_hash);
+}
+
+ShaderKey ShaderPermutation::GetKey() const
+{
+    return XXH3_64bits_withSeed(&m_flags, sizeof(m_flags), m_hash);
+}
+
+static inline const char* GetCString(const eastl::string& str) { return str.c_str(); }
+static inline const char* GetCString(const char* str) { return str; }
+
+template<typename Defines>
+IGfxShader* ShaderCache::FindInternedShader(ShaderKey key, const char* file, const char* entry_point, const char* profile, const Defines& defines, GfxShaderCompilerFlags flags) const
+{
+    auto range = m_internedShaders.equal_range(key);
+    for (auto iter = range.first; iter != range.second; ++iter)
+    {
+        const GfxShaderDesc& desc = iter->second.shader->GetDesc();
+        if (iter->second.file != file || desc.entry_point != entry_point || desc.profile != profile || desc.flags != flags || desc.defines.size() != defines.size())
+        {
+            continue;
+        }
+
+        bool same_defines = true;
+        for (size_t i = 0; i < defines.size() && same_defines; ++i)
+        {
+            same_defines = desc.defines[i] == GetCString(defines[i]);
+        }
+
+        if (same_defines)
+        {
+            return iter->second.shader;
+        }
+    }
+
+    return nullptr;
+}
+
+IGfxShader* ShaderCache::GetShader(const ShaderPermutation& permutation)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_shaderMutex);
+
+        IGfxShader* pInternedShader = FindInternedShader(permutation.GetKey(), permutation.GetFile(), permutation.GetEntryPoint(), permutation.GetProfile(), permutation.GetDefines(), permutation.GetFlags());
+        if (pInternedShader)
+        {
+            return pInternedShader;
+        }
+    }
+
+    const eastl::fixed_vector<const char*, 8>& permutation_defines = permutation.GetDefines();
+    eastl::vector<eastl::string> defines(permutation_defines.begin(), permutation_defines.end());
+
+    return GetShader(permutation.GetFile(), permutation.GetEntryPoint(), permutation.GetProfile(), defines, permutation.GetFlags());
 }
 
 IGfxShader* ShaderCache::GetShader(const eastl::string& file, const eastl::string& entry_point, const eastl::string& profile, const eastl::vector<eastl::string>& defines, GfxShaderCompilerFlags flags)
 {
+    ShaderKey key = GetShaderKey(file, entry_point, profile, defines, flags);
+
+    std::lock_guard<std::mutex> lock(m_shaderMutex);
+
+    IGfxShader* pInternedShader = FindInternedShader(key, file.c_str(), entry_point.c_str(), profile.c_str(), defines, flags);
+    if (pInternedShader)
+    {
+        return pInternedShader;
+    }
+
+    //different relative paths may resolve to the same file, so the absolute path is used for the desc
     eastl::string file_path = Engine::GetInstance()->GetShaderPath() + file;
     eastl::string absolute_path = std::filesystem::absolute(file_path.c_str()).string().c_str();
 
@@ -73,20 +178,66 @@ IGfxShader* ShaderCache::GetShader(const eastl::string& file, const eastl::strin
     auto iter = m_cachedShaders.find(desc);
     if (iter != m_cachedShaders.end())
     {
+        m_internedShaders.insert(eastl::make_pair(key, InternedShader{ file, iter->second.get() }));
         return iter->second.get();
     }
 
-    IGfxShader* pShader = CreateShader(absolute_path, entry_point, profile, defines, flags);
-    if (pShader != nullptr)
+    eastl::string name = absolute_path + " : " + entry_point + "(" + profile + ")";
+    IGfxShader* pShader = m_pRenderer->GetDevice()->CreateShader(desc, {}, name);
+    m_cachedShaders.insert(eastl::make_pair(desc, eastl::unique_ptr<IGfxShader>(pShader)));
+    m_internedShaders.insert(eastl::make_pair(key, InternedShader{ file, pShader }));
+
+    enki::TaskSet* task = new enki::TaskSet([this, pShader](enki::TaskSetPartition range, uint32_t threadnum)
+        {
+            const GfxShaderDesc& desc = pShader->GetDesc();
+
+            eastl::vector<uint8_t> shader_blob;
+            eastl::vector<eastl::string> include_files;
+            if (CompileShader(desc.file, desc.entry_point, desc.profile, desc.defines, desc.flags, shader_blob, include_files))
+            {
+                pShader->SetShaderData(shader_blob.data(), (uint32_t)shader_blob.size());
+            }
+
+            UpdateDependencies(pShader, include_files);
+        });
+    m_compileTasks.insert(eastl::make_pair(pShader, eastl::unique_ptr<enki::TaskSet>(task)));
+
+    Engine::GetInstance()->GetTaskScheduler()->AddTaskSetToPipe(task);
+
+    return pShader;
+}
+
+IGfxShader* ShaderCache::GetShader(ShaderKey key) const
+{
+    std::lock_guard<std::mutex> lock(m_shaderMutex);
+
+    //a key shared by several permutations can't tell which one is requested
+    auto range = m_internedShaders.equal_range(key);
+    if (range.first != range.second && eastl::next(range.first) == range.second)
     {
-        m_cachedShaders.insert(eastl::make_pair(desc, eastl::unique_ptr<IGfxShader>(pShader)));
+        return range.first->second.shader;
     }
+    return nullptr;
+}
 
-    return pShader;
+ShaderKey ShaderCache::GetShaderKey(const eastl::string& file, const eastl::string& entry_point, const eastl::string& profile, const eastl::vector<eastl::string>& defines, GfxShaderCompilerFlags flags)
+{
+    uint64_t key = XXH3_64bits(file.data(), file.size());
+    key = XXH3_64bits_withSeed(entry_point.data(), entry_point.size(), key);
+    key = XXH3_64bits_withSeed(profile.data(), profile.size(), key);
+    for (size_t i = 0; i < defines.size(); ++i)
+    {
+        key = XXH3_64bits_withSeed(defines[i].data(), defines[i].size(), key);
+    }
+    key = XXH3_64bits_withSeed(&flags, sizeof(flags), key);
+
+    return key;
 }
 
 eastl::string ShaderCache::GetCachedFileContent(const eastl::string& file)
 {
+    std::lock_guard<std::mutex> lock(m_cachedFileMutex);
+
     auto iter = m_cachedFile.find(file);
     if (iter != m_cachedFile.end())
     {
@@ -97,123 +248,312 @@ eastl::string ShaderCache::GetCachedFileContent(const eastl::string& file)
 
     m_cachedFile.insert(eastl::make_pair(file, source));
 
+    std::error_code error;
+    m_cachedFileTime.insert(eastl::make_pair(file, std::filesystem::last_write_time(file.c_str(), error)));
+
     return source;
 }
 
+eastl::vector<IGfxShader*> ShaderCache::GetCachedShaders() const
+{
+    std::lock_guard<std::mutex> lock(m_shaderMutex);
+
+    eastl::vector<IGfxShader*> shaders;
+    shaders.reserve(m_cachedShaders.size());
+
+    for (auto iter = m_cachedShaders.begin(); iter != m_cachedShaders.end(); ++iter)
+    {
+        shaders.push_back(iter->second.get());
+    }
+
+    return shaders;
+}
+
+enki::TaskSet* ShaderCache::GetCompileTask(IGfxShader* shader) const
+{
+    std::lock_guard<std::mutex> lock(m_shaderMutex);
+
+    auto iter = m_compileTasks.find(shader);
+    if (iter != m_compileTasks.end())
+    {
+        return iter->second.get();
+    }
+    return nullptr;
+}
+
+void ShaderCache::WaitForCompilation()
+{
+    //the lock isn't held while waiting, WaitforTask may run the PSO tasks which call GetCompileTask
+    eastl::vector<enki::TaskSet*> tasks;
+    {
+        std::lock_guard<std::mutex> lock(m_shaderMutex);
+
+        tasks.reserve(m_compileTasks.size());
+        for (auto iter = m_compileTasks.begin(); iter != m_compileTasks.end(); ++iter)
+        {
+            tasks.push_back(iter->second.get());
+        }
+    }
+
+    if (tasks.empty())
+    {
+        return;
+    }
+
+    CPU_EVENT("Render", "ShaderCache::WaitForCompilation");
+
+    enki::TaskScheduler* ts = Engine::GetInstance()->GetTaskScheduler();
+    for (size_t i = 0; i < tasks.size(); ++i)
+    {
+        ts->WaitforTask(tasks[i]);
+    }
+
+    ReleaseCompletedTasks();
+}
+
+void ShaderCache::ReleaseCompletedTasks()
+{
+    std::lock_guard<std::mutex> lock(m_shaderMutex);
+
+    for (auto iter = m_compileTasks.begin(); iter != m_compileTasks.end();)
+    {
+        if (iter->second->GetIsComplete())
+        {
+            iter = m_compileTasks.erase(iter);
+        }
+        else
+        {
+            ++iter;
+        }
+    }
+}
+
 void ShaderCache::ReloadShaders()
 {
-    for (auto iter = m_cachedFile.begin(); iter != m_cachedFile.end(); ++iter)
+    eastl::vector<IGfxShader*> changedShaders;
+
     {
-        const eastl::string& path = iter->first;
-        const eastl::string& source = iter->second;
-        
-        eastl::string new_source = LoadFile(path);
+        //async compile tasks read and add files with GetCachedFileContent
+        std::lock_guard<std::mutex> lock(m_cachedFileMutex);
 
-        if (source != new_source)
+        for (auto iter = m_cachedFile.begin(); iter != m_cachedFile.end(); ++iter)
         {
-            m_cachedFile[path] = new_source;
+            const eastl::string& path = iter->first;
+            const eastl::string& source = iter->second;
+
+            //only the files whose timestamp changed are read again
+            std::error_code error;
+            std::filesystem::file_time_type time = std::filesystem::last_write_time(path.c_str(), error);
+            if (time == m_cachedFileTime[path])
+            {
+                continue;
+            }
+            m_cachedFileTime[path] = time;
+        
+            eastl::string new_source = LoadFile(path);
 
-            eastl::vector<IGfxShader*> changedShaders = GetShaderList(path);
-            for (size_t i = 0; i < changedShaders.size(); ++i)
+            if (source != new_source)
             {
-                RecompileShader(changedShaders[i]);
+                m_cachedFile[path] = new_source;
+
+                eastl::vector<IGfxShader*> shaders = GetShaderList(path);
+                for (size_t i = 0; i < shaders.size(); ++i)
+                {
+                    if (eastl::find(changedShaders.begin(), changedShaders.end(), shaders[i]) == changedShaders.end())
+                    {
+                        changedShaders.push_back(shaders[i]);
+                    }
+                }
             }
         }
     }
+
+    if (changedShaders.empty())
+    {
+        return;
+    }
+
+    eastl::vector<eastl::vector<uint8_t>> shader_blobs(changedShaders.size());
+    eastl::vector<uint8_t> compiled(changedShaders.size());
+
+    ParallelFor((uint32_t)changedShaders.size(), [&](uint32_t i)
+        {
+            const GfxShaderDesc& desc = changedShaders[i]->GetDesc();
+            RE_LOG("recompling shader : {}", desc.file.c_str());
+
+            eastl::vector<eastl::string> include_files;
+            compiled[i] = CompileShader(desc.file, desc.entry_point, desc.profile, desc.defines, desc.flags, shader_blobs[i], include_files);
+
+            UpdateDependencies(changedShaders[i], include_files);
+        });
+
+    PipelineStateCache* pipelineCache = m_pRenderer->GetPipelineStateCache();
+
+    for (size_t i = 0; i < changedShaders.size(); ++i)
+    {
+        if (compiled[i])
+        {
+            changedShaders[i]->SetShaderData(shader_blobs[i].data(), (uint32_t)shader_blobs[i].size());
+            pipelineCache->RecreatePSO(changedShaders[i]);
+        }
+    }
 }
 
-IGfxShader* ShaderCache::CreateShader(const eastl::string& file, const eastl::string& entry_point, const eastl::string& profile, const eastl::vector<eastl::string>& defines, GfxShaderCompilerFlags flags)
+bool ShaderCache::CompileShader(const eastl::string& file, const eastl::string& entry_point, const eastl::string& profile, const eastl::vector<eastl::string>& defines, GfxShaderCompilerFlags flags, 
+    eastl::vector<uint8_t>& shader_blob, eastl::vector<eastl::string>& include_files)
 {
+    uint64_t key = GetShaderBinaryKey(file, entry_point, profile, defines, flags);
+    if (LoadShaderBinary(key, shader_blob, include_files))
+    {
+        return true;
+    }
+
     eastl::string source = GetCachedFileContent(file);
 
-    eastl::vector<uint8_t> shader_blob;
-    if (!m_pRenderer->GetShaderCompiler()->Compile(source, file, entry_point, profile, defines, flags, shader_blob))
+    if (!m_pRenderer->GetShaderCompiler()->Compile(source, file, entry_point, profile, defines, flags, shader_blob, include_files))
     {
-        return nullptr;
+        return false;
     }
 
-    GfxShaderDesc desc;
-    desc.file = file;
-    desc.entry_point = entry_point;
-    desc.profile = profile;
-    desc.defines = defines;
-
-    eastl::string name = file + " : " + entry_point + "(" + profile + ")";
-    IGfxShader* shader = m_pRenderer->GetDevice()->CreateShader(desc, shader_blob, name);
-    return shader;
+    SaveShaderBinary(key, shader_blob, include_files);
+    return true;
 }
 
-void ShaderCache::RecompileShader(IGfxShader* shader)
+uint64_t ShaderCache::GetShaderBinaryKey(const eastl::string& file, const eastl::string& entry_point, const eastl::string& profile, const eastl::vector<eastl::string>& defines, GfxShaderCompilerFlags flags)
 {
-    const GfxShaderDesc& desc = shader->GetDesc();
-    RE_LOG("recompling shader : {}", desc.file.c_str());
-
-    eastl::string source = GetCachedFileContent(desc.file);
+    //included files are not known before compiling, they are validated against the hashes stored in the binary
+    eastl::string source = GetCachedFileContent(file);
 
-    eastl::vector<uint8_t> shader_blob;
-    if (!m_pRenderer->GetShaderCompiler()->Compile(source, desc.file, desc.entry_point, desc.profile, desc.defines, desc.flags, shader_blob))
+    eastl::string key = file + "\n" + entry_point + "\n" + profile + "\n" + m_pRenderer->GetShaderCompiler()->GetVersion() + "\n";
+    for (size_t i = 0; i < defines.size(); ++i)
     {
-        return;
+        key += defines[i] + "\n";
     }
 
-    shader->SetShaderData(shader_blob.data(), (uint32_t)shader_blob.size());
+    key += fmt::format("{:x} {} {}", XXH3_64bits(source.data(), source.size()), flags, (uint32_t)m_pRenderer->GetDevice()->GetVendor()).c_str();
 
-    PipelineStateCache* pipelineCache = m_pRenderer->GetPipelineStateCache();
-    pipelineCache->RecreatePSO(shader);
+#ifdef _DEBUG
+    key += " debug";
+#endif
+
+    return XXH3_64bits(key.data(), key.size());
 }
 
-eastl::vector<IGfxShader*> ShaderCache::GetShaderList(const eastl::string& file)
+bool ShaderCache::LoadShaderBinary(uint64_t key, eastl::vector<uint8_t>& shader_blob, eastl::vector<eastl::string>& include_files)
 {
-    eastl::vector<IGfxShader*> shaders;
+    eastl::string path = m_shaderBinaryPath + fmt::format("{:016x}.bin", key).c_str();
 
-    for (auto iter = m_cachedShaders.begin(); iter != m_cachedShaders.end(); ++iter)
+    std::ifstream is;
+    is.open(path.c_str(), std::ios::binary);
+    if (is.fail())
+    {
+        return false;
+    }
+
+    ShaderBinaryHeader header;
+    is.read((char*)&header, sizeof(header));
+    if (is.fail() || header.magic != SHADER_BINARY_MAGIC || header.version != SHADER_BINARY_VERSION || header.key != key)
     {
-        if (IsFileIncluded(iter->second.get(), file))
+        return false;
+    }
+
+    for (uint32_t i = 0; i < header.includeCount; ++i)
+    {
+        uint32_t length = 0;
+        is.read((char*)&length, sizeof(length));
+
+        eastl::string include_file;
+        include_file.resize(length);
+        is.read((char*)include_file.data(), length);
+
+        uint64_t hash = 0;
+        is.read((char*)&hash, sizeof(hash));
+
+        if (is.fail())
         {
-            shaders.push_back(iter->second.get());
+            return false;
+        }
+
+        eastl::string source = GetCachedFileContent(include_file);
+        if (XXH3_64bits(source.data(), source.size()) != hash)
+        {
+            include_files.clear();
+            return false;
         }
+
+        include_files.push_back(include_file);
     }
 
-    return shaders;
+    shader_blob.resize(header.blobSize);
+    is.read((char*)shader_blob.data(), header.blobSize);
+
+    return !is.fail();
 }
 
-bool ShaderCache::IsFileIncluded(const IGfxShader* shader, const eastl::string& file)
+void ShaderCache::SaveShaderBinary(uint64_t key, const eastl::vector<uint8_t>& shader_blob, const eastl::vector<eastl::string>& include_files)
 {
-    const GfxShaderDesc& desc = shader->GetDesc();
+    std::filesystem::create_directories(m_shaderBinaryPath.c_str());
+
+    eastl::string path = m_shaderBinaryPath + fmt::format("{:016x}.bin", key).c_str();
 
-    if (desc.file == file)
+    std::ofstream os;
+    os.open(path.c_str(), std::ios::binary);
+    if (os.fail())
     {
-        return true;
+        return;
     }
 
-    eastl::string extension = std::filesystem::path(file.c_str()).extension().string().c_str();
-    bool is_header = extension == ".hlsli" || extension == ".h";
+    ShaderBinaryHeader header;
+    header.magic = SHADER_BINARY_MAGIC;
+    header.version = SHADER_BINARY_VERSION;
+    header.key = key;
+    header.includeCount = (uint32_t)include_files.size();
+    header.blobSize = (uint32_t)shader_blob.size();
+    os.write((const char*)&header, sizeof(header));
 
-    if (is_header)
+    for (size_t i = 0; i < include_files.size(); ++i)
     {
-        std::string source = GetCachedFileContent(desc.file).c_str();
-        std::regex r("#include\\s*\"\\s*\\S+.\\S+\\s*\"");
+        eastl::string source = GetCachedFileContent(include_files[i]);
+        uint32_t length = (uint32_t)include_files[i].size();
+        uint64_t hash = XXH3_64bits(source.data(), source.size());
 
-        std::smatch result;
-        while (std::regex_search(source, result, r))
-        {
-            eastl::string include = result[0].str().c_str();
+        os.write((const char*)&length, sizeof(length));
+        os.write(include_files[i].data(), length);
+        os.write((const char*)&hash, sizeof(hash));
+    }
 
-            size_t first = include.find_first_of('\"');
-            size_t last = include.find_last_of('\"');
-            eastl::string header = include.substr(first + 1, last - first - 1);
+    os.write((const char*)shader_blob.data(), shader_blob.size());
+}
 
-            std::filesystem::path path(desc.file.c_str());
-            std::filesystem::path header_path = path.parent_path() / header.c_str();
+void ShaderCache::UpdateDependencies(IGfxShader* shader, const eastl::vector<eastl::string>& include_files)
+{
+    std::lock_guard<std::mutex> lock(m_dependencyMutex);
 
-            if (std::filesystem::absolute(header_path).string().c_str() == file)
-            {
-                return true;
-            }
+    eastl::vector<eastl::string>& dependencies = m_shaderDependencies[shader];
+    for (size_t i = 0; i < dependencies.size(); ++i)
+    {
+        eastl::vector<IGfxShader*>& dependents = m_fileDependents[dependencies[i]];
+        dependents.erase(eastl::remove(dependents.begin(), dependents.end(), shader), dependents.end());
+    }
 
-            source = result.suffix();
-        }
+    dependencies = include_files;
+    dependencies.push_back(shader->GetDesc().file);
+
+    for (size_t i = 0; i < dependencies.size(); ++i)
+    {
+        m_fileDependents[dependencies[i]].push_back(shader);
+    }
+}
+
+eastl::vector<IGfxShader*> ShaderCache::GetShaderList(const eastl::string& file)
+{
+    std::lock_guard<std::mutex> lock(m_dependencyMutex);
+
+    auto iter = m_fileDependents.find(file);
+    if (iter != m_fileDependents.end())
+    {
+        return iter->second;
     }
 
-    return false;
+    return {};
 }
@@ -2,7 +2,13 @@
 
 #include "../gfx/gfx.h"
 #include "EASTL/hash_map.h"
+#include "EASTL/fixed_vector.h"
 #include "EASTL/unique_ptr.h"
+#include "xxHash/xxhash.h"
+#include <mutex>
+#include <filesystem>
+
+namespace enki { class TaskSet; }
 
 namespace eastl
 {
@@ -11,17 +17,52 @@ namespace eastl
     {
         size_t operator()(const GfxShaderDesc& desc) const
         {
-            eastl::string s = desc.file + desc.entry_point + desc.profile;
+            //chained over the fields, without building a temporary string
+            uint64_t hash = XXH3_64bits(desc.file.data(), desc.file.size());
+            hash = XXH3_64bits_withSeed(desc.entry_point.data(), desc.entry_point.size(), hash);
+            hash = XXH3_64bits_withSeed(desc.profile.data(), desc.profile.size(), hash);
             for (size_t i = 0; i < desc.defines.size(); ++i)
             {
-                s += desc.defines[i];
+                hash = XXH3_64bits_withSeed(desc.defines[i].data(), desc.defines[i].size(), hash);
             }
+            hash = XXH3_64bits_withSeed(&desc.flags, sizeof(desc.flags), hash);
 
-            return eastl::hash<eastl::string>{}(s);
+            static_assert(sizeof(size_t) == sizeof(uint64_t), "only supports 64 bits platforms");
+            return hash;
         }
     };
 }
 
+//interned key of a shader permutation, computed from the GetShader arguments without any allocation.
+//callers which look up the same shader repeatedly can keep the key and use the GetShader(ShaderKey) overload
+using ShaderKey = uint64_t;
+
+//a shader permutation given by literals, for the lookups in the execute lambdas.
+//its key is the same as GetShaderKey with the same arguments, the eastl::string arguments are built only when it isn't interned yet
+class ShaderPermutation
+{
+public:
+    ShaderPermutation(const char* file, const char* entry_point, const char* profile, GfxShaderCompilerFlags flags = 0);
+
+    void AddDefine(const char* define);
+
+    ShaderKey GetKey() const;
+
+    const char* GetFile() const { return m_file; }
+    const char* GetEntryPoint() const { return m_entryPoint; }
+    const char* GetProfile() const { return m_profile; }
+    const eastl::fixed_vector<const char*, 8>& GetDefines() const { return m_defines; }
+    GfxShaderCompilerFlags GetFlags() const { return m_flags; }
+
+private:
+    const char* m_file;
+    const char* m_entryPoint;
+    const char* m_profile;
+    eastl::fixed_vector<const char*, 8> m_defines;
+    GfxShaderCompilerFlags m_flags;
+    uint64_t m_hash; //file, entry point, profile and defines, the flags are added in GetKey
+};
+
 class Renderer;
 
 class ShaderCache
@@ -29,20 +70,65 @@ class ShaderCache
 public:
     ShaderCache(Renderer* pRenderer);
 
+    ~ShaderCache();
+
+    //the returned shader is compiled asynchronously on the worker threads, its data is valid after its compile task is completed
     IGfxShader* GetShader(const eastl::string& file, const eastl::string& entry_point, const eastl::string& profile, const eastl::vector<eastl::string>& defines, GfxShaderCompilerFlags flags);
+    IGfxShader* GetShader(const ShaderPermutation& permutation);
+    //returns nullptr if the shader was never requested with the arguments of the key, or if the key is shared by several permutations
+    IGfxShader* GetShader(ShaderKey key) const;
+
+    static ShaderKey GetShaderKey(const eastl::string& file, const eastl::string& entry_point, const eastl::string& profile, const eastl::vector<eastl::string>& defines, GfxShaderCompilerFlags flags);
     eastl::string GetCachedFileContent(const eastl::string& file);
 
+    eastl::vector<IGfxShader*> GetCachedShaders() const;
+
+    enki::TaskSet* GetCompileTask(IGfxShader* shader) const;
+    void WaitForCompilation();
+    //the tasks can be released only if no pending PSO task is waiting for them
+    void ReleaseCompletedTasks();
+
     void ReloadShaders();
 
 private:
-    IGfxShader* CreateShader(const eastl::string& file, const eastl::string& entry_point, const eastl::string& profile, const eastl::vector<eastl::string>& defines, GfxShaderCompilerFlags flags);
-    void RecompileShader(IGfxShader* shader);
+    bool CompileShader(const eastl::string& file, const eastl::string& entry_point, const eastl::string& profile, const eastl::vector<eastl::string>& defines, GfxShaderCompilerFlags flags, 
+        eastl::vector<uint8_t>& shader_blob, eastl::vector<eastl::string>& include_files);
+
+    uint64_t GetShaderBinaryKey(const eastl::string& file, const eastl::string& entry_point, const eastl::string& profile, const eastl::vector<eastl::string>& defines, GfxShaderCompilerFlags flags);
+    bool LoadShaderBinary(uint64_t key, eastl::vector<uint8_t>& shader_blob, eastl::vector<eastl::string>& include_files);
+    void SaveShaderBinary(uint64_t key, const eastl::vector<uint8_t>& shader_blob, const eastl::vector<eastl::string>& include_files);
 
+    template<typename Defines>
+    IGfxShader* FindInternedShader(ShaderKey key, const char* file, const char* entry_point, const char* profile, const Defines& defines, GfxShaderCompilerFlags flags) const;
+
+    void UpdateDependencies(IGfxShader* shader, const eastl::vector<eastl::string>& include_files);
     eastl::vector<IGfxShader*> GetShaderList(const eastl::string& file);
-    bool IsFileIncluded(const IGfxShader* shader, const eastl::string& file);
 
 private:
     Renderer* m_pRenderer;
     eastl::hash_map<GfxShaderDesc, eastl::unique_ptr<IGfxShader>> m_cachedShaders;
+    eastl::hash_map<IGfxShader*, eastl::unique_ptr<enki::TaskSet>> m_compileTasks;
+
+    //the colliding keys are chained, a lookup returns a shader only if its arguments are the same.
+    //the file is kept as requested, the desc has the absolute path
+    struct InternedShader
+    {
+        eastl::string file;
+        IGfxShader* shader;
+    };
+    eastl::hash_multimap<ShaderKey, InternedShader> m_internedShaders;
+
+    //the shaders are requested from the render graph setup tasks and the PSO tasks on the worker threads
+    mutable std::mutex m_shaderMutex;
+
     eastl::hash_map<eastl::string, eastl::string> m_cachedFile;
+    eastl::hash_map<eastl::string, std::filesystem::file_time_type> m_cachedFileTime;
+    std::mutex m_cachedFileMutex;
+
+    //transitive includes of each shader recorded at compile time, and the reverse index from a file to its dependent shaders
+    eastl::hash_map<IGfxShader*, eastl::vector<eastl::string>> m_shaderDependencies;
+    eastl::hash_map<eastl::string, eastl::vector<IGfxShader*>> m_fileDependents;
+    std::mutex m_dependencyMutex;
+
+    eastl::string m_shaderBinaryPath;
 };
\ No newline at end of file
@@ -4,6 +4,8 @@
 #include "utils/log.h"
 #include "utils/string.h"
 #include "utils/assert.h"
+#include "core/engine.h"
+#include "enkiTS/TaskScheduler.h"
 #include "dxc/dxcapi.h"
 
 #include <filesystem>
@@ -21,10 +23,18 @@ public:
         eastl::string absolute_path = std::filesystem::absolute(fileName).string().c_str();
         eastl::string source = m_pShaderCache->GetCachedFileContent(absolute_path);
 
+        if (eastl::find(m_includedFiles.begin(), m_includedFiles.end(), absolute_path) == m_includedFiles.end())
+        {
+            m_includedFiles.push_back(absolute_path);
+        }
+
         *includeSource = nullptr;
         return m_pDxcUtils->CreateBlob(source.data(), (UINT32)source.size(), CP_UTF8, reinterpret_cast<IDxcBlobEncoding**>(includeSource));
     }
 
+    void ClearIncludedFiles() { m_includedFiles.clear(); }
+    const eastl::vector<eastl::string>& GetIncludedFiles() const { return m_includedFiles; }
+
     ULONG STDMETHODCALLTYPE AddRef() override
     {
         ++m_ref;
@@ -66,6 +76,7 @@ private:
     ShaderCache* m_pShaderCache = nullptr;
     IDxcUtils* m_pDxcUtils = nullptr;
     std::atomic<ULONG> m_ref = 0;
+    eastl::vector<eastl::string> m_includedFiles;
 };
 
 ShaderCompiler::ShaderCompiler(Renderer* pRenderer) : m_pRenderer(pRenderer)
@@ -75,25 +86,53 @@ ShaderCompiler::ShaderCompiler(Renderer* pRenderer) : m_pRenderer(pRenderer)
     {
         DxcCreateInstanceProc DxcCreateInstance = (DxcCreateInstanceProc)GetProcAddress(dxc, "DxcCreateInstance");
 
-        DxcCreateInstance(CLSID_DxcUtils, IID_PPV_ARGS(&m_pDxcUtils));
-        DxcCreateInstance(CLSID_DxcCompiler, IID_PPV_ARGS(&m_pDxcCompiler));
+        uint32_t thread_count = Engine::GetInstance()->GetTaskScheduler()->GetNumTaskThreads();
+        m_dxcInstances.resize(thread_count);
+
+        for (uint32_t i = 0; i < thread_count; ++i)
+        {
+            DXCInstance& instance = m_dxcInstances[i];
+            DxcCreateInstance(CLSID_DxcUtils, IID_PPV_ARGS(&instance.pDxcUtils));
+            DxcCreateInstance(CLSID_DxcCompiler, IID_PPV_ARGS(&instance.pDxcCompiler));
+
+            //m_pDxcUtils->CreateDefaultIncludeHandler(&m_pDxcIncludeHandler);
+            instance.pDxcIncludeHandler = new DXCIncludeHandler(pRenderer->GetShaderCache(), instance.pDxcUtils);
+            instance.pDxcIncludeHandler->AddRef();
+        }
 
-        //m_pDxcUtils->CreateDefaultIncludeHandler(&m_pDxcIncludeHandler);
-        m_pDxcIncludeHandler = new DXCIncludeHandler(pRenderer->GetShaderCache(), m_pDxcUtils);
-        m_pDxcIncludeHandler->AddRef();
+        CComPtr<IDxcVersionInfo> pVersionInfo;
+        if (SUCCEEDED(m_dxcInstances[0].pDxcCompiler->QueryInterface(IID_PPV_ARGS(&pVersionInfo))))
+        {
+            UINT32 major = 0, minor = 0;
+            pVersionInfo->GetVersion(&major, &minor);
+            m_version = fmt::format("{}.{}", major, minor).c_str();
+
+            CComPtr<IDxcVersionInfo2> pVersionInfo2;
+            char* commit_hash = nullptr;
+            UINT32 commit_count = 0;
+            if (SUCCEEDED(pVersionInfo->QueryInterface(IID_PPV_ARGS(&pVersionInfo2))) &&
+                SUCCEEDED(pVersionInfo2->GetCommitInfo(&commit_count, &commit_hash)))
+            {
+                m_version += fmt::format(" ({} {})", commit_count, commit_hash).c_str();
+                CoTaskMemFree(commit_hash);
+            }
+        }
     }
 }
 
 ShaderCompiler::~ShaderCompiler()
 {
-    m_pDxcIncludeHandler->Release();
-    m_pDxcCompiler->Release();
-    m_pDxcUtils->Release();
+    for (size_t i = 0; i < m_dxcInstances.size(); ++i)
+    {
+        m_dxcInstances[i].pDxcIncludeHandler->Release();
+        m_dxcInstances[i].pDxcCompiler->Release();
+        m_dxcInstances[i].pDxcUtils->Release();
+    }
 }
 
 bool ShaderCompiler::Compile(const eastl::string& source, const eastl::string& file, const eastl::string& entry_point,
     const eastl::string& profile, const eastl::vector<eastl::string>& defines, GfxShaderCompilerFlags flags,
-    eastl::vector<uint8_t>& output_blob)
+    eastl::vector<uint8_t>& output_blob, eastl::vector<eastl::string>& include_files)
 {
     DxcBuffer sourceBuffer;
     sourceBuffer.Ptr = source.data();
@@ -119,20 +158,18 @@ bool ShaderCompiler::Compile(const eastl::string& source, const eastl::string& f
         arguments.push_back(L"-D"); arguments.push_back(wstrDefines[i].c_str());
     }
 
-    arguments.push_back(L"-D");
     switch (m_pRenderer->GetDevice()->GetVendor())
     {
     case GfxVendor::AMD:
-        arguments.push_back(L"GFX_VENDOR_AMD=1");
+        arguments.push_back(L"-D"); arguments.push_back(L"GFX_VENDOR_AMD=1");
         break;
     case GfxVendor::Intel:
-        arguments.push_back(L"GFX_VENDOR_INTEL=1");
+        arguments.push_back(L"-D"); arguments.push_back(L"GFX_VENDOR_INTEL=1");
         break;
     case GfxVendor::Nvidia:
-        arguments.push_back(L"GFX_VENDOR_NV=1");
+        arguments.push_back(L"-D"); arguments.push_back(L"GFX_VENDOR_NV=1");
         break;
     default:
-        RE_ASSERT(false);
         break;
     }
 
@@ -169,8 +206,13 @@ bool ShaderCompiler::Compile(const eastl::string& source, const eastl::string& f
 #endif
     }
 
+    const DXCInstance& instance = m_dxcInstances[Engine::GetInstance()->GetTaskScheduler()->GetThreadNum()];
+    instance.pDxcIncludeHandler->ClearIncludedFiles();
+
     CComPtr<IDxcResult> pResults;
-    m_pDxcCompiler->Compile(&sourceBuffer, arguments.data(), (UINT32)arguments.size(), m_pDxcIncludeHandler, IID_PPV_ARGS(&pResults));
+    instance.pDxcCompiler->Compile(&sourceBuffer, arguments.data(), (UINT32)arguments.size(), instance.pDxcIncludeHandler, IID_PPV_ARGS(&pResults));
+
+    include_files = instance.pDxcIncludeHandler->GetIncludedFiles();
 
     CComPtr<IDxcBlobUtf8> pErrors = nullptr;
     pResults->GetOutput(DXC_OUT_ERRORS, IID_PPV_ARGS(&pErrors), nullptr);
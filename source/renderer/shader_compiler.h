@@ -1,10 +1,11 @@
 #pragma once
 
 #include "gfx/gfx_define.h"
+#include "EASTL/vector.h"
 
 struct IDxcCompiler3;
 struct IDxcUtils;
-struct IDxcIncludeHandler;
+class DXCIncludeHandler;
 
 class Renderer;
 
@@ -16,11 +17,20 @@ public:
 
     bool Compile(const eastl::string& source, const eastl::string& file, const eastl::string& entry_point, 
         const eastl::string& profile, const eastl::vector<eastl::string>& defines, GfxShaderCompilerFlags flags,
-        eastl::vector<uint8_t>& output_blob);
+        eastl::vector<uint8_t>& output_blob, eastl::vector<eastl::string>& include_files);
+
+    const eastl::string& GetVersion() const { return m_version; }
 
 private:
+    //DXC compiler instances are not thread safe, each enkiTS thread uses its own one
+    struct DXCInstance
+    {
+        IDxcCompiler3* pDxcCompiler = nullptr;
+        IDxcUtils* pDxcUtils = nullptr;
+        DXCIncludeHandler* pDxcIncludeHandler = nullptr;
+    };
+
     Renderer* m_pRenderer = nullptr;
-    IDxcCompiler3* m_pDxcCompiler = nullptr;
-    IDxcUtils* m_pDxcUtils = nullptr;
-    IDxcIncludeHandler* m_pDxcIncludeHandler = nullptr;
+    eastl::vector<DXCInstance> m_dxcInstances;
+    eastl::string m_version;
 };
\ No newline at end of file
@@ -1,82 +1,685 @@
 #include "animation.h"
 #include "skeletal_mesh.h"
+#include "utils/log.h"
+#include "EASTL/sort.h"
 
 Animation::Animation(const eastl::string& name)
 {
     m_name = name;
 }
 
-void Animation::Update(SkeletalMesh* mesh, float delta_time)
+void Animation::InitState(AnimationState& state) const
 {
-    m_currentAnimTime += delta_time;
-    if (m_currentAnimTime > m_timeDuration)
+    state.time = 0.0f;
+    state.timelines.clear();
+    state.timelines.resize(m_timelines.size());
+    state.channelKeyframes.clear();
+    state.channelKeyframes.resize(m_channels.size(), 0);
+}
+
+void Animation::Update(SkeletalMesh* mesh, AnimationState& state, float delta_time) const
+{
+    RE_ASSERT(state.timelines.size() == m_timelines.size() && state.channelKeyframes.size() == m_channels.size());
+
+    state.time += delta_time;
+    if (state.time > m_timeDuration)
+    {
+        state.time = state.time - m_timeDuration;
+    }
+
+    for (size_t i = 0; i < m_timelines.size(); ++i)
+    {
+        UpdateTimeline(m_timelines[i], state.timelines[i], state.time);
+    }
+
+    for (size_t i = 0; i < m_blocks.size(); ++i)
     {
-        m_currentAnimTime = m_currentAnimTime - m_timeDuration;
+        SampleBlock(mesh, m_blocks[i], state.timelines[m_blocks[i].timeline]);
     }
 
     for (size_t i = 0; i < m_channels.size(); ++i)
     {
-        const AnimationChannel& channel = m_channels[i];
-        UpdateChannel(mesh, channel);
+        UpdateChannel(mesh, m_channels[i], state.channelKeyframes[i], state.time);
     }
 }
 
-void Animation::UpdateChannel(SkeletalMesh* mesh, const AnimationChannel& channel)
+template<typename GetTime>
+inline uint32_t find_keyframe(uint32_t keyframe_count, float time, uint32_t& cursor, GetTime get_time)
 {
-    eastl::pair<float, float4> lower_frame;
-    eastl::pair<float, float4> upper_frame;
-
-    bool found = false;
-    for (size_t frame = 0; frame < channel.keyframes.size() - 1; ++frame)
+    //playing forward usually stays in the cached interval or moves to the next one
+    uint32_t frame = cursor;
+    for (uint32_t i = 0; i < 2 && frame + 1 < keyframe_count; ++i, ++frame)
     {
-        if (channel.keyframes[frame].first <= m_currentAnimTime &&
-            channel.keyframes[frame + 1].first >= m_currentAnimTime)
+        if (get_time(frame) > time)
         {
-            lower_frame = channel.keyframes[frame];
-            upper_frame = channel.keyframes[frame + 1];
-            found = true;
             break;
         }
+
+        if (time < get_time(frame + 1))
+        {
+            cursor = frame;
+            return frame;
+        }
     }
 
-    float interpolation_value;
-    if (found)
+    //seeking or looping, binary search for the first keyframe after time
+    uint32_t low = 0;
+    uint32_t high = keyframe_count;
+    while (low < high)
     {
-        interpolation_value = (m_currentAnimTime - lower_frame.first) / (upper_frame.first - lower_frame.first);
+        uint32_t mid = (low + high) / 2;
+        if (time < get_time(mid))
+        {
+            high = mid;
+        }
+        else
+        {
+            low = mid + 1;
+        }
     }
-    else
+
+    cursor = low > 0 ? low - 1 : 0;
+    return cursor;
+}
+
+inline float get_interpolation_value(float time, float lower_time, float upper_time)
+{
+    float delta_time = upper_time - lower_time;
+    return delta_time > 0.0f ? clamp((time - lower_time) / delta_time, 0.0f, 1.0f) : 0.0f;
+}
+
+inline float4 right_to_left_handed(AnimationChannelMode mode, const float4& value)
+{
+    switch (mode)
     {
-        lower_frame = upper_frame = channel.keyframes[0];
-        interpolation_value = 0.0f;
+    case AnimationChannelMode::Translation:
+        return float4(value.x, value.y, -value.z, value.w);
+    case AnimationChannelMode::Rotation:
+        return float4(value.x, value.y, -value.z, -value.w);
+    default:
+        return value;
     }
+}
 
-    SkeletalMeshNode* node = mesh->GetNode(channel.targetNode);
+uint32_t Animation::FindKeyframe(const AnimationChannel& channel, uint32_t& cursor, float time) const
+{
+    const eastl::vector<eastl::pair<float, float4>>& keyframes = channel.keyframes;
+
+    return find_keyframe((uint32_t)keyframes.size(), time, cursor,
+        [&](uint32_t frame) { return keyframes[frame].first; });
+}
+
+inline float4 cubic_spline(const float4& p0, const float4& m0, const float4& p1, const float4& m1, float delta_time, float t)
+{
+    //gltf 2.0 spec, Appendix C : Interpolation
+    float t2 = t * t;
+    float t3 = t2 * t;
+
+    return (2.0f * t3 - 3.0f * t2 + 1.0f) * p0 + (t3 - 2.0f * t2 + t) * delta_time * m0 +
+        (-2.0f * t3 + 3.0f * t2) * p1 + (t3 - t2) * delta_time * m1;
+}
+
+void Animation::UpdateChannel(SkeletalMesh* mesh, const AnimationChannel& channel, uint32_t& cursor, float time) const
+{
+    uint32_t frame = FindKeyframe(channel, cursor, time);
+    uint32_t next_frame = eastl::min(frame + 1, (uint32_t)channel.keyframes.size() - 1);
+
+    const eastl::pair<float, float4>& lower_frame = channel.keyframes[frame];
+    const eastl::pair<float, float4>& upper_frame = channel.keyframes[next_frame];
+
+    float interpolation_value = get_interpolation_value(time, lower_frame.first, upper_frame.first);
+
+    float4 value;
+    switch (channel.interpolation)
+    {
+    case AnimationChannelInterpolation::Step:
+        value = lower_frame.second;
+        break;
+    case AnimationChannelInterpolation::CubicSpline:
+        value = cubic_spline(lower_frame.second, channel.tangents[frame].second, upper_frame.second, channel.tangents[next_frame].first,
+            upper_frame.first - lower_frame.first, interpolation_value);
+        if (channel.mode == AnimationChannelMode::Rotation)
+        {
+            value = normalize(value);
+        }
+        break;
+    case AnimationChannelInterpolation::Linear:
+    default:
+        if (channel.mode == AnimationChannelMode::Rotation)
+        {
+            value = rotation_slerp(lower_frame.second, upper_frame.second, interpolation_value);
+        }
+        else
+        {
+            value = lerp(lower_frame.second, upper_frame.second, interpolation_value);
+        }
+        break;
+    }
+
+    //interpolation above is not affected by the handedness since it is applied to both keyframes
+    value = right_to_left_handed(channel.mode, value);
 
     switch (channel.mode)
     {
     case AnimationChannelMode::Translation:
+        mesh->SetNodeTranslation(channel.targetNode, value.xyz());
+        break;
+    case AnimationChannelMode::Rotation:
+        mesh->SetNodeRotation(channel.targetNode, value);
+        break;
+    case AnimationChannelMode::Scale:
+        mesh->SetNodeScale(channel.targetNode, value.xyz());
+        break;
+    default:
+        break;
+    }
+}
+
+inline bool same_keyframe_times(const AnimationChannel& a, const AnimationChannel& b)
+{
+    if (a.keyframes.size() != b.keyframes.size())
     {
-        float3 lower_value = float3(lower_frame.second.x, lower_frame.second.y, -lower_frame.second.z);
-        float3 upper_value = float3(upper_frame.second.x, upper_frame.second.y, -upper_frame.second.z);
+        return false;
+    }
 
-        node->translation = lerp(lower_value, upper_value, interpolation_value);
-        break;
+    for (size_t k = 0; k < a.keyframes.size(); ++k)
+    {
+        if (a.keyframes[k].first != b.keyframes[k].first)
+        {
+            return false;
+        }
     }
-    case AnimationChannelMode::Rotation:
+
+    return true;
+}
+
+inline float4 nlerp(const float4& a, float4 b, float t)
+{
+    if (dot(a, b) < 0.0f)
     {
-        float4 lower_value = float4(lower_frame.second.x, lower_frame.second.y, -lower_frame.second.z, -lower_frame.second.w);
-        float4 upper_value = float4(upper_frame.second.x, upper_frame.second.y, -upper_frame.second.z, -upper_frame.second.w);
+        b = -b;
+    }
+    return normalize(lerp(a, b, t));
+}
 
-        //node->rotation = slerp(lower_value, upper_value, interpolation_value);
-        node->rotation = rotation_slerp(lower_value, upper_value, interpolation_value);
-        break;
+inline float keyframe_error(AnimationChannelMode mode, const float4& value, const float4& reconstructed)
+{
+    if (mode == AnimationChannelMode::Rotation)
+    {
+        return min(length(value - reconstructed), length(value + reconstructed));
     }
-    case AnimationChannelMode::Scale:
+    return length(value.xyz() - reconstructed.xyz());
+}
+
+static const float ROTATION_QUANTIZE_RANGE = 0.70710678f; //components other than the largest one are in [-1/sqrt(2), 1/sqrt(2)]
+
+//half a step on the 3 stored components, and at most as much again on the reconstructed largest one
+static const float ROTATION_QUANTIZE_ERROR = 2.0f * 1.7320508f * ROTATION_QUANTIZE_RANGE / 32767.0f;
+
+//max error of a quantized keyframe of the track, translations and scales are quantized in the range of all its keyframes,
+//so it is an upper bound of the error with the range of the kept keyframes
+inline float quantization_error(const AnimationChannel& channel)
+{
+    if (channel.mode == AnimationChannelMode::Rotation)
     {
-        node->scale = lerp(lower_frame.second.xyz(), upper_frame.second.xyz(), interpolation_value);
-        break;
+        return ROTATION_QUANTIZE_ERROR;
     }
-    default:
-        break;
+
+    if (channel.keyframes.empty())
+    {
+        return 0.0f;
+    }
+
+    float3 range_min = channel.keyframes[0].second.xyz();
+    float3 range_max = range_min;
+    for (size_t i = 1; i < channel.keyframes.size(); ++i)
+    {
+        range_min = min(range_min, channel.keyframes[i].second.xyz());
+        range_max = max(range_max, channel.keyframes[i].second.xyz());
+    }
+
+    //same as rangeScale / 2 of each component
+    return length((range_max - range_min) / 65535.0f * 0.5f);
+}
+
+inline void encode_rotation(float4 q, uint16_t words[3])
+{
+    uint32_t largest = 0;
+    for (uint32_t i = 1; i < 4; ++i)
+    {
+        if (abs(q[i]) > abs(q[largest]))
+        {
+            largest = i;
+        }
+    }
+
+    //q and -q are the same rotation, so the dropped component can always be positive
+    if (q[largest] < 0.0f)
+    {
+        q = -q;
+    }
+
+    //15 bits per component, the 2 bits index of the largest component is stored in the lowest bits of the first 2 words
+    uint32_t n = 0;
+    for (uint32_t i = 0; i < 4; ++i)
+    {
+        if (i != largest)
+        {
+            float v = clamp(q[i] / ROTATION_QUANTIZE_RANGE * 0.5f + 0.5f, 0.0f, 1.0f);
+            words[n] = (uint16_t)((uint32_t)(v * 32767.0f + 0.5f) << 1);
+            n++;
+        }
+    }
+
+    words[0] |= largest & 0x1;
+    words[1] |= (largest >> 1) & 0x1;
+}
+
+inline void decode_rotations(const uint16_t* words, hlslpp::float4 result[4])
+{
+    float values[4][ANIMATION_SIMD_WIDTH];
+    uint32_t largest[ANIMATION_SIMD_WIDTH];
+
+    for (uint32_t lane = 0; lane < ANIMATION_SIMD_WIDTH; ++lane)
+    {
+        largest[lane] = (words[lane] & 0x1) | ((words[ANIMATION_SIMD_WIDTH + lane] & 0x1) << 1);
+
+        for (uint32_t n = 0; n < 3; ++n)
+        {
+            values[n][lane] = (float)(words[n * ANIMATION_SIMD_WIDTH + lane] >> 1);
+        }
+    }
+
+    const hlslpp::float4 scale(2.0f * ROTATION_QUANTIZE_RANGE / 32767.0f);
+    const hlslpp::float4 bias(-ROTATION_QUANTIZE_RANGE);
+
+    hlslpp::float4 abc[3];
+    for (uint32_t n = 0; n < 3; ++n)
+    {
+        hlslpp::load(abc[n], values[n]);
+        abc[n] = hlslpp::mad(abc[n], scale, bias);
+        hlslpp::store(abc[n], values[n]);
+    }
+
+    hlslpp::float4 d = hlslpp::sqrt(hlslpp::max(hlslpp::float4(0.0f), hlslpp::float4(1.0f) - abc[0] * abc[0] - abc[1] * abc[1] - abc[2] * abc[2]));
+    hlslpp::store(d, values[3]);
+
+    float q[4][ANIMATION_SIMD_WIDTH];
+    for (uint32_t lane = 0; lane < ANIMATION_SIMD_WIDTH; ++lane)
+    {
+        uint32_t n = 0;
+        for (uint32_t i = 0; i < 4; ++i)
+        {
+            q[i][lane] = i == largest[lane] ? values[3][lane] : values[n++][lane];
+        }
+    }
+
+    for (uint32_t i = 0; i < 4; ++i)
+    {
+        hlslpp::load(result[i], q[i]);
+    }
+}
+
+inline void decode_ranges(const uint16_t* words, const AnimationTrackBlock& block, hlslpp::float4 result[3])
+{
+    for (uint32_t c = 0; c < 3; ++c)
+    {
+        float values[ANIMATION_SIMD_WIDTH];
+        for (uint32_t lane = 0; lane < ANIMATION_SIMD_WIDTH; ++lane)
+        {
+            values[lane] = (float)words[c * ANIMATION_SIMD_WIDTH + lane];
+        }
+
+        const float* min_values = block.rangeMin[c];
+        const float* scale_values = block.rangeScale[c];
+        hlslpp::float4 range_min(min_values[0], min_values[1], min_values[2], min_values[3]);
+        hlslpp::float4 range_scale(scale_values[0], scale_values[1], scale_values[2], scale_values[3]);
+        hlslpp::load(result[c], values);
+
+        result[c] = hlslpp::mad(result[c], range_scale, range_min);
+    }
+}
+
+void Animation::PackChannels(float max_error)
+{
+    //cubic spline channels stay in m_channels and are sampled one by one
+    eastl::vector<uint32_t> packed_channels;
+    eastl::vector<uint32_t> channel_groups(m_channels.size(), (uint32_t)-1);
+
+    //gltf channels usually share their input accessors, so most of them end up in a few groups
+    for (uint32_t i = 0; i < (uint32_t)m_channels.size(); ++i)
+    {
+        if (m_channels[i].interpolation == AnimationChannelInterpolation::CubicSpline)
+        {
+            continue;
+        }
+
+        //tracks which can't be quantized within max_error are kept raw
+        if (quantization_error(m_channels[i]) > max_error)
+        {
+            continue;
+        }
+
+        channel_groups[i] = i;
+        for (size_t j = 0; j < packed_channels.size(); ++j)
+        {
+            if (same_keyframe_times(m_channels[i], m_channels[packed_channels[j]]))
+            {
+                channel_groups[i] = channel_groups[packed_channels[j]];
+                break;
+            }
+        }
+
+        packed_channels.push_back(i);
+    }
+
+    auto block_key = [&](uint32_t channel)
+    {
+        return ((uint64_t)channel_groups[channel] << 32) | ((uint64_t)m_channels[channel].mode << 8) | (uint64_t)m_channels[channel].interpolation;
+    };
+
+    //channels of a block share keyframe times, mode and interpolation, and are joint-sorted inside it
+    eastl::sort(packed_channels.begin(), packed_channels.end(), [&](uint32_t a, uint32_t b)
+        {
+            if (block_key(a) != block_key(b))
+            {
+                return block_key(a) < block_key(b);
+            }
+            return m_channels[a].targetNode < m_channels[b].targetNode;
+        });
+
+    size_t raw_size = 0;
+    size_t raw_keyframes = 0;
+    for (size_t i = 0; i < m_channels.size(); ++i)
+    {
+        raw_size += m_channels[i].keyframes.size() * sizeof(eastl::pair<float, float4>) + m_channels[i].tangents.size() * sizeof(eastl::pair<float4, float4>);
+        raw_keyframes += m_channels[i].keyframes.size();
+    }
+
+    for (size_t i = 0; i < packed_channels.size();)
+    {
+        const AnimationChannel* lanes[ANIMATION_SIMD_WIDTH];
+
+        AnimationTrackBlock block;
+        block.mode = m_channels[packed_channels[i]].mode;
+        block.step = m_channels[packed_channels[i]].interpolation == AnimationChannelInterpolation::Step;
+        block.trackCount = 0;
+
+        uint64_t key = block_key(packed_channels[i]);
+        while (i < packed_channels.size() && block.trackCount < ANIMATION_SIMD_WIDTH && block_key(packed_channels[i]) == key)
+        {
+            lanes[block.trackCount] = &m_channels[packed_channels[i]];
+            block.targetNodes[block.trackCount] = lanes[block.trackCount]->targetNode;
+            block.trackCount++;
+            i++;
+        }
+
+        //unused lanes repeat the last track, so they always hold valid values
+        for (uint32_t lane = block.trackCount; lane < ANIMATION_SIMD_WIDTH; ++lane)
+        {
+            lanes[lane] = lanes[block.trackCount - 1];
+        }
+
+        PackBlock(block, lanes, max_error);
+        m_blocks.push_back(block);
+    }
+
+    eastl::sort(m_blocks.begin(), m_blocks.end(), [](const AnimationTrackBlock& a, const AnimationTrackBlock& b)
+        {
+            return a.targetNodes[0] < b.targetNodes[0];
+        });
+
+    eastl::vector<AnimationChannel> unpacked_channels;
+    for (size_t i = 0; i < m_channels.size(); ++i)
+    {
+        if (channel_groups[i] == (uint32_t)-1)
+        {
+            unpacked_channels.push_back(eastl::move(m_channels[i]));
+        }
+    }
+    m_channels.swap(unpacked_channels);
+
+    size_t packed_size = m_times.size() * sizeof(float) + m_timelines.size() * sizeof(AnimationTimeline) + m_blocks.size() * sizeof(AnimationTrackBlock);
+    size_t packed_keyframes = 0;
+    for (uint32_t i = 0; i < 3; ++i)
+    {
+        packed_size += m_valueStreams[i].size() * sizeof(uint16_t);
+    }
+    for (size_t i = 0; i < m_blocks.size(); ++i)
+    {
+        packed_keyframes += m_timelines[m_blocks[i].timeline].keyCount * m_blocks[i].trackCount;
+    }
+    for (size_t i = 0; i < m_channels.size(); ++i)
+    {
+        packed_size += m_channels[i].keyframes.size() * sizeof(eastl::pair<float, float4>) + m_channels[i].tangents.size() * sizeof(eastl::pair<float4, float4>);
+        packed_keyframes += m_channels[i].keyframes.size();
+    }
+
+    RE_LOG("animation {} : {} keyframes -> {}, {:.1f} KB -> {:.1f} KB, compression ratio {:.1f}", m_name.c_str(),
+        raw_keyframes, packed_keyframes, raw_size / 1024.0f, packed_size / 1024.0f, (float)raw_size / eastl::max(packed_size, (size_t)1));
+}
+
+void Animation::PackBlock(AnimationTrackBlock& block, const AnimationChannel* const* lanes, float max_error)
+{
+    const uint32_t key_count = (uint32_t)lanes[0]->keyframes.size();
+
+    auto value = [&](uint32_t lane, uint32_t frame)
+    {
+        return right_to_left_handed(block.mode, lanes[lane]->keyframes[frame].second);
+    };
+
+    auto reconstruct = [&](uint32_t lane, uint32_t lower, uint32_t upper, uint32_t frame)
+    {
+        if (block.step)
+        {
+            return value(lane, lower);
+        }
+
+        float t = get_interpolation_value(lanes[lane]->keyframes[frame].first, lanes[lane]->keyframes[lower].first, lanes[lane]->keyframes[upper].first);
+        return block.mode == AnimationChannelMode::Rotation ? nlerp(value(lane, lower), value(lane, upper), t) : lerp(value(lane, lower), value(lane, upper), t);
+    };
+
+    //the quantization error adds to the reduction error, so the reduction is left with the rest of max_error (not negative, see PackChannels)
+    float reduction_error[ANIMATION_SIMD_WIDTH];
+    for (uint32_t lane = 0; lane < ANIMATION_SIMD_WIDTH; ++lane)
+    {
+        reduction_error[lane] = max_error - quantization_error(*lanes[lane]);
+    }
+
+    //greedy keyframe reduction, a keyframe is kept only if skipping it breaks the error bound of any skipped keyframe in any track of the block
+    eastl::vector<uint32_t> keys;
+    keys.push_back(0);
+
+    for (uint32_t k = 1; k + 1 < key_count; ++k)
+    {
+        uint32_t last = keys.back();
+        bool removable = true;
+
+        for (uint32_t frame = last + 1; frame <= k && removable; ++frame)
+        {
+            for (uint32_t lane = 0; lane < block.trackCount && removable; ++lane)
+            {
+                removable = keyframe_error(block.mode, value(lane, frame), reconstruct(lane, last, k + 1, frame)) <= reduction_error[lane];
+            }
+        }
+
+        if (!removable)
+        {
+            keys.push_back(k);
+        }
+    }
+
+    if (key_count > 1)
+    {
+        keys.push_back(key_count - 1);
+    }
+
+    eastl::vector<float> times(keys.size());
+    for (size_t k = 0; k < keys.size(); ++k)
+    {
+        times[k] = lanes[0]->keyframes[keys[k]].first;
+    }
+    block.timeline = FindOrAddTimeline(times);
+
+    if (block.mode != AnimationChannelMode::Rotation)
+    {
+        for (uint32_t lane = 0; lane < ANIMATION_SIMD_WIDTH; ++lane)
+        {
+            float3 range_min = value(lane, keys[0]).xyz();
+            float3 range_max = range_min;
+            for (size_t k = 1; k < keys.size(); ++k)
+            {
+                range_min = min(range_min, value(lane, keys[k]).xyz());
+                range_max = max(range_max, value(lane, keys[k]).xyz());
+            }
+
+            for (uint32_t c = 0; c < 3; ++c)
+            {
+                block.rangeMin[c][lane] = range_min[c];
+                block.rangeScale[c][lane] = (range_max[c] - range_min[c]) / 65535.0f;
+            }
+        }
+    }
+
+    eastl::vector<uint16_t>& stream = m_valueStreams[(uint32_t)block.mode];
+    block.valueOffset = (uint32_t)stream.size();
+    stream.resize(stream.size() + keys.size() * 3 * ANIMATION_SIMD_WIDTH);
+
+    for (size_t k = 0; k < keys.size(); ++k)
+    {
+        uint16_t* words = stream.data() + block.valueOffset + k * 3 * ANIMATION_SIMD_WIDTH;
+
+        for (uint32_t lane = 0; lane < ANIMATION_SIMD_WIDTH; ++lane)
+        {
+            float4 v = value(lane, keys[k]);
+
+            if (block.mode == AnimationChannelMode::Rotation)
+            {
+                uint16_t rotation[3];
+                encode_rotation(normalize(v), rotation);
+
+                for (uint32_t n = 0; n < 3; ++n)
+                {
+                    words[n * ANIMATION_SIMD_WIDTH + lane] = rotation[n];
+                }
+            }
+            else
+            {
+                for (uint32_t c = 0; c < 3; ++c)
+                {
+                    float range_scale = block.rangeScale[c][lane];
+                    float normalized = range_scale > 0.0f ? (v[c] - block.rangeMin[c][lane]) / range_scale : 0.0f;
+                    words[c * ANIMATION_SIMD_WIDTH + lane] = (uint16_t)clamp(normalized + 0.5f, 0.0f, 65535.0f);
+                }
+            }
+        }
+    }
+}
+
+uint32_t Animation::FindOrAddTimeline(const eastl::vector<float>& times)
+{
+    const uint32_t key_count = (uint32_t)times.size();
+
+    for (uint32_t i = 0; i < (uint32_t)m_timelines.size(); ++i)
+    {
+        const AnimationTimeline& timeline = m_timelines[i];
+        if (timeline.keyCount == key_count && memcmp(m_times.data() + timeline.firstKey, times.data(), sizeof(float) * key_count) == 0)
+        {
+            return i;
+        }
+    }
+
+    AnimationTimeline timeline;
+    timeline.firstKey = (uint32_t)m_times.size();
+    timeline.keyCount = key_count;
+
+    m_times.insert(m_times.end(), times.begin(), times.end());
+
+    m_timelines.push_back(timeline);
+    return (uint32_t)m_timelines.size() - 1;
+}
+
+void Animation::UpdateTimeline(const AnimationTimeline& timeline, AnimationTimelineState& state, float time) const
+{
+    const float* times = m_times.data() + timeline.firstKey;
+
+    state.lowerFrame = find_keyframe(timeline.keyCount, time, state.currentKeyframe,
+        [&](uint32_t frame) { return times[frame]; });
+    state.upperFrame = eastl::min(state.lowerFrame + 1, timeline.keyCount - 1);
+    state.interpolationValue = get_interpolation_value(time, times[state.lowerFrame], times[state.upperFrame]);
+}
+
+void Animation::SampleBlock(SkeletalMesh* mesh, const AnimationTrackBlock& block, const AnimationTimelineState& timeline) const
+{
+    static_assert(ANIMATION_SIMD_WIDTH == 4, "SampleBlock works on hlslpp::float4 lanes");
+
+    const uint32_t key_size = 3 * ANIMATION_SIMD_WIDTH;
+
+    const uint16_t* values = m_valueStreams[(uint32_t)block.mode].data() + block.valueOffset;
+    const uint16_t* lower_values = values + timeline.lowerFrame * key_size;
+    const uint16_t* upper_values = values + timeline.upperFrame * key_size;
+
+    hlslpp::float4 t(block.step ? 0.0f : timeline.interpolationValue);
+    hlslpp::float4 lower[4], upper[4], result[4];
+
+    if (block.mode == AnimationChannelMode::Rotation)
+    {
+        decode_rotations(lower_values, lower);
+        decode_rotations(upper_values, upper);
+
+        //normalized lerp along the shortest path, keyframes are dense enough that it is close to slerp
+        hlslpp::float4 d = lower[0] * upper[0] + lower[1] * upper[1] + lower[2] * upper[2] + lower[3] * upper[3];
+        hlslpp::float4 s = (d >= hlslpp::float4(0.0f)) * hlslpp::float4(2.0f) - hlslpp::float4(1.0f);
+
+        hlslpp::float4 length_sq(0.0f);
+        for (uint32_t c = 0; c < 4; ++c)
+        {
+            result[c] = hlslpp::lerp(lower[c], upper[c] * s, t);
+            length_sq += result[c] * result[c];
+        }
+
+        hlslpp::float4 inv_length = hlslpp::float4(1.0f) / hlslpp::sqrt(length_sq);
+        for (uint32_t c = 0; c < 4; ++c)
+        {
+            result[c] *= inv_length;
+        }
+    }
+    else
+    {
+        decode_ranges(lower_values, block, lower);
+        decode_ranges(upper_values, block, upper);
+
+        for (uint32_t c = 0; c < 3; ++c)
+        {
+            result[c] = hlslpp::lerp(lower[c], upper[c], t);
+        }
+    }
+
+    const uint32_t components = block.mode == AnimationChannelMode::Rotation ? 4 : 3;
+
+    float lanes[4][ANIMATION_SIMD_WIDTH];
+    for (uint32_t c = 0; c < components; ++c)
+    {
+        hlslpp::store(result[c], lanes[c]);
+    }
+
+    for (uint32_t lane = 0; lane < block.trackCount; ++lane)
+    {
+        uint32_t node = block.targetNodes[lane];
+
+        switch (block.mode)
+        {
+        case AnimationChannelMode::Translation:
+            mesh->SetNodeTranslation(node, float3(lanes[0][lane], lanes[1][lane], lanes[2][lane]));
+            break;
+        case AnimationChannelMode::Rotation:
+            mesh->SetNodeRotation(node, float4(lanes[0][lane], lanes[1][lane], lanes[2][lane], lanes[3][lane]));
+            break;
+        case AnimationChannelMode::Scale:
+            mesh->SetNodeScale(node, float3(lanes[0][lane], lanes[1][lane], lanes[2][lane]));
+            break;
+        default:
+            break;
+        }
     }
 }
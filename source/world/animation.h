@@ -11,11 +11,61 @@ enum class AnimationChannelMode
     Scale,
 };
 
+enum class AnimationChannelInterpolation
+{
+    Linear,
+    Step,
+    CubicSpline,
+};
+
 struct AnimationChannel
 {
     uint32_t targetNode;
     AnimationChannelMode mode;
+    AnimationChannelInterpolation interpolation = AnimationChannelInterpolation::Linear;
     eastl::vector<eastl::pair<float, float4>> keyframes;
+    eastl::vector<eastl::pair<float4, float4>> tangents; //in/out tangents, only for cubic spline
+};
+
+//packed clip : channels are stored SoA and sampled ANIMATION_SIMD_WIDTH at a time
+#define ANIMATION_SIMD_WIDTH 4
+
+struct AnimationTimeline
+{
+    uint32_t firstKey; //in Animation::m_times
+    uint32_t keyCount;
+};
+
+//sampled once per update, shared by all blocks of the timeline
+struct AnimationTimelineState
+{
+    uint32_t currentKeyframe = 0; //cached lower keyframe of last update
+    uint32_t lowerFrame = 0;
+    uint32_t upperFrame = 0;
+    float interpolationValue = 0.0f;
+};
+
+//playback state of an instance, Animation is not modified after loading so it is shared by the instances of a model
+struct AnimationState
+{
+    float time = 0.0f;
+    eastl::vector<AnimationTimelineState> timelines;
+    eastl::vector<uint32_t> channelKeyframes; //cached lower keyframe of the unpacked channels
+};
+
+struct AnimationTrackBlock
+{
+    AnimationChannelMode mode;
+    bool step;
+    uint32_t timeline;
+    uint32_t trackCount; //1 ~ ANIMATION_SIMD_WIDTH
+    uint32_t targetNodes[ANIMATION_SIMD_WIDTH];
+
+    //3 quantized words per track and keyframe in the value stream of its mode, layout : [keyframe][word][lane]
+    //rotations are smallest-three 48 bits, translations and scales are 16 bits relative to the track range
+    uint32_t valueOffset;
+    float rangeMin[3][ANIMATION_SIMD_WIDTH];
+    float rangeScale[3][ANIMATION_SIMD_WIDTH];
 };
 
 class SkeletalMesh;
@@ -27,14 +77,28 @@ class Animation
 public:
     Animation(const eastl::string& name);
 
-    void Update(SkeletalMesh* mesh, float delta_time);
+    void InitState(AnimationState& state) const;
+    void Update(SkeletalMesh* mesh, AnimationState& state, float delta_time) const;
 
 private:
-    void UpdateChannel(SkeletalMesh* mesh, const AnimationChannel& channel);
+    void UpdateChannel(SkeletalMesh* mesh, const AnimationChannel& channel, uint32_t& cursor, float time) const;
+    uint32_t FindKeyframe(const AnimationChannel& channel, uint32_t& cursor, float time) const;
+
+    //keyframes which linear interpolation reconstructs within max_error, including the quantization error, are removed.
+    //tracks whose quantization error alone exceeds max_error stay in m_channels
+    void PackChannels(float max_error);
+    void PackBlock(AnimationTrackBlock& block, const AnimationChannel* const* lanes, float max_error);
+    uint32_t FindOrAddTimeline(const eastl::vector<float>& times);
+    void UpdateTimeline(const AnimationTimeline& timeline, AnimationTimelineState& state, float time) const;
+    void SampleBlock(SkeletalMesh* mesh, const AnimationTrackBlock& block, const AnimationTimelineState& timeline) const;
 
 private:
     eastl::string m_name;
-    eastl::vector<AnimationChannel> m_channels;
+    eastl::vector<AnimationChannel> m_channels; //channels which can't be packed, eg. cubic spline or too large translation range
     float m_timeDuration = 0.0f;
-    float m_currentAnimTime = 0.0f;
+
+    eastl::vector<float> m_times;
+    eastl::vector<AnimationTimeline> m_timelines;
+    eastl::vector<AnimationTrackBlock> m_blocks; //sorted by target node
+    eastl::vector<uint16_t> m_valueStreams[3]; //translation, rotation, scale
 };
\ No newline at end of file
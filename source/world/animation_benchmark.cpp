@@ -0,0 +1,58 @@
+#include "animation_benchmark.h"
+#include "gltf_loader.h"
+#include "skeletal_mesh.h"
+#include "utils/log.h"
+#include "utils/parallel_for.h"
+#include "sokol/sokol_time.h"
+#include <cfloat>
+
+bool BenchmarkAnimation(const eastl::string& file, uint32_t instance_count, uint32_t ticks, float delta_time, AnimationBenchmarkResult& result)
+{
+    GLTFLoader loader(file);
+    eastl::unique_ptr<SkeletalMesh> model(loader.LoadSkeletalModel());
+    if (model == nullptr)
+    {
+        RE_LOG("failed to load a skinned model : {}", file.c_str());
+        return false;
+    }
+
+    //the instances share the animation, skeleton and static buffers of the model as in a crowd scene
+    eastl::vector<eastl::unique_ptr<SkeletalMesh>> instances;
+    instances.reserve(instance_count);
+    for (uint32_t i = 0; i < instance_count; ++i)
+    {
+        instances.emplace_back(model->Instantiate());
+    }
+
+    result = AnimationBenchmarkResult();
+    result.minTime = DBL_MAX;
+
+    for (uint32_t i = 0; i < ticks && instance_count > 0; ++i)
+    {
+        uint64_t start = stm_now();
+        ParallelFor(instance_count, [&](uint32_t index)
+            {
+                instances[index]->UpdatePose(delta_time);
+            });
+        double time = stm_ms(stm_since(start));
+
+        result.minTime = eastl::min(result.minTime, time);
+        result.maxTime = eastl::max(result.maxTime, time);
+        result.avgTime += time;
+    }
+
+    result.instances = instance_count;
+    result.nodes = model->GetNodeCount();
+    result.joints = model->GetJointCount();
+
+    if (ticks == 0 || instance_count == 0)
+    {
+        result.minTime = 0.0;
+        return true;
+    }
+
+    result.ticks = ticks;
+    result.avgTime /= ticks;
+
+    return true;
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include "EASTL/string.h"
+
+struct AnimationBenchmarkResult
+{
+    uint32_t instances = 0;
+    uint32_t ticks = 0;
+    uint32_t nodes = 0; //per instance
+    uint32_t joints = 0;
+
+    double minTime = 0.0; //ms per tick, loading and instancing the model is not included
+    double avgTime = 0.0;
+    double maxTime = 0.0;
+};
+
+//loads a skinned glTF once and updates the pose of instance_count instances of it for the given number of ticks, in parallel as World::UpdateAnimation.
+//only the CPU update is timed, the joint matrices are not uploaded since the scene constants are limited per frame
+bool BenchmarkAnimation(const eastl::string& file, uint32_t instance_count, uint32_t ticks, float delta_time, AnimationBenchmarkResult& result);
@@ -23,12 +23,8 @@ inline float3 str_to_float3(const eastl::string& str)
     return float3(v[0], v[1], v[2]);
 }
 
-inline void GetTransform(const cgltf_node* node, float4x4& matrix)
+inline void GetTransform(const cgltf_node* node, float3& translation, float4& rotation, float3& scale)
 {
-    float3 translation;
-    float4 rotation;
-    float3 scale;
-
     if (node->has_matrix)
     {
         float4x4 matrix = float4x4(node->matrix);
@@ -45,6 +41,14 @@ inline void GetTransform(const cgltf_node* node, float4x4& matrix)
     translation.z *= -1;
     rotation.z *= -1;
     rotation.w *= -1;
+}
+
+inline void GetTransform(const cgltf_node* node, float4x4& matrix)
+{
+    float3 translation;
+    float4 rotation;
+    float3 scale;
+    GetTransform(node, translation, rotation, scale);
 
     float4x4 T = translation_matrix(translation);
     float4x4 R = rotation_matrix(rotation);
@@ -121,6 +125,12 @@ GLTFLoader::GLTFLoader(World* world, tinyxml2::XMLElement* element)
     float4x4 S = scaling_matrix(m_scale);
     m_mtxWorld = mul(T, mul(R, S));
 
+    const tinyxml2::XMLAttribute* animation_error_attr = element->FindAttribute("animation_error");
+    if (animation_error_attr)
+    {
+        m_animationError = animation_error_attr->FloatValue();
+    }
+
 
     //todo : remove this once GLTF anisotropy extension is released
     const tinyxml2::XMLAttribute* anisotropyT = element->FindAttribute("anisotropyT");
@@ -130,42 +140,29 @@ GLTFLoader::GLTFLoader(World* world, tinyxml2::XMLElement* element)
     }
 }
 
-void GLTFLoader::Load()
+GLTFLoader::GLTFLoader(const eastl::string& file)
 {
-    eastl::string file = Engine::GetInstance()->GetAssetPath() + m_file;
+    m_file = file;
+}
 
-    cgltf_options options = {};
-    cgltf_data* data = NULL;
-    cgltf_result result = cgltf_parse_file(&options, file.c_str(), &data);
-    if (result != cgltf_result_success)
+void GLTFLoader::Load()
+{
+    cgltf_data* data = Parse();
+    if (data == nullptr)
     {
         return;
     }
 
-    cgltf_load_buffers(&options, data, file.c_str());
-
     if (data->animations_count > 0)
     {
-        SkeletalMesh* mesh = new SkeletalMesh(m_file);
-        mesh->m_pRenderer = Engine::GetInstance()->GetRenderer();
-        mesh->m_pAnimation.reset(LoadAnimation(data, &data->animations[0])); //currently only load the first one
-        mesh->m_pSkeleton.reset(LoadSkeleton(data, &data->skins[0]));
-
-        for (cgltf_size i = 0; i < data->nodes_count; ++i)
-        {
-            mesh->m_nodes.emplace_back(LoadSkeletalMeshNode(data, &data->nodes[i]));
-        }
-
-        for (cgltf_size i = 0; i < data->scene->nodes_count; ++i)
-        {
-            mesh->m_rootNodes.push_back(GetNodeIndex(data, data->scene->nodes[i]));
-        }
-
+        SkeletalMesh* mesh = CreateSkeletalMesh(data);
         mesh->SetPosition(m_position);
         mesh->SetRotation(m_rotation);
         mesh->SetScale(m_scale);
         mesh->Create();
         m_pWorld->AddObject(mesh);
+
+        m_pSkeletalMesh = mesh;
     }
     else
     {
@@ -181,6 +178,68 @@ void GLTFLoader::Load()
     cgltf_free(data);
 }
 
+SkeletalMesh* GLTFLoader::LoadSkeletalModel()
+{
+    cgltf_data* data = Parse();
+    if (data == nullptr)
+    {
+        return nullptr;
+    }
+
+    if (data->animations_count > 0)
+    {
+        m_pSkeletalMesh = CreateSkeletalMesh(data);
+    }
+
+    cgltf_free(data);
+    return m_pSkeletalMesh;
+}
+
+cgltf_data* GLTFLoader::Parse()
+{
+    eastl::string file = Engine::GetInstance()->GetAssetPath() + m_file;
+
+    cgltf_options options = {};
+    cgltf_data* data = NULL;
+    cgltf_result result = cgltf_parse_file(&options, file.c_str(), &data);
+    if (result != cgltf_result_success)
+    {
+        return nullptr;
+    }
+
+    cgltf_load_buffers(&options, data, file.c_str());
+    return data;
+}
+
+SkeletalMesh* GLTFLoader::CreateSkeletalMesh(const cgltf_data* data)
+{
+    SortSkeletalMeshNodes(data);
+
+    SkeletalMesh* mesh = new SkeletalMesh(m_file);
+    mesh->m_pRenderer = Engine::GetInstance()->GetRenderer();
+    mesh->m_pAnimation.reset(LoadAnimation(data, &data->animations[0])); //currently only load the first one
+    mesh->m_pAnimation->InitState(mesh->m_animationState);
+    mesh->m_pSkeleton.reset(LoadSkeleton(data, &data->skins[0]));
+    mesh->m_jointMatrices.resize(mesh->m_pSkeleton->GetJointCount());
+
+    mesh->m_nodeParents.resize(data->nodes_count);
+    mesh->m_nodeTranslations.resize(data->nodes_count);
+    mesh->m_nodeRotations.resize(data->nodes_count);
+    mesh->m_nodeScales.resize(data->nodes_count);
+    mesh->m_nodeGlobalTransforms.resize(data->nodes_count);
+
+    for (size_t i = 0; i < m_sortedNodes.size(); ++i)
+    {
+        const cgltf_node* node = &data->nodes[m_sortedNodes[i]];
+        mesh->m_nodes.emplace_back(LoadSkeletalMeshNode(data, node));
+        mesh->m_nodeParents[i] = mesh->m_nodes[i]->parent;
+
+        GetTransform(node, mesh->m_nodeTranslations[i], mesh->m_nodeRotations[i], mesh->m_nodeScales[i]);
+    }
+
+    return mesh;
+}
+
 void GLTFLoader::LoadStaticMeshNode(const cgltf_data* data, const cgltf_node* node, const float4x4& mtxParentToWorld)
 {
     float4x4 mtxLocalToParent;
@@ -366,6 +425,105 @@ meshopt_Stream LoadBufferStream(const cgltf_accessor* accessor, bool convertToLH
     return stream;
 }
 
+struct MeshletBound
+{
+    float3 center;
+    float radius;
+
+    union
+    {
+        //axis + cutoff, rgba8snorm
+        struct
+        {
+            int8_t axis_x;
+            int8_t axis_y;
+            int8_t axis_z;
+            int8_t cutoff;
+        };
+        uint32_t cone; 
+    };
+
+    uint vertexCount;
+    uint triangleCount;
+
+    uint vertexOffset;
+    uint triangleOffset;
+};
+
+inline void BuildMeshlets(const void* indices, size_t index_stride, size_t index_count, const float* positions, size_t vertex_count, size_t position_stride,
+    eastl::vector<MeshletBound>& meshlet_bounds, eastl::vector<unsigned int>& meshlet_vertices, eastl::vector<unsigned short>& meshlet_triangles16)
+{
+    size_t max_vertices = 64;
+    size_t max_triangles = 124;
+    const float cone_weight = 0.5f;
+    size_t max_meshlets = meshopt_buildMeshletsBound(index_count, max_vertices, max_triangles);
+
+    eastl::vector<meshopt_Meshlet> meshlets(max_meshlets);
+    meshlet_vertices.resize(max_meshlets * max_vertices);
+    eastl::vector<unsigned char> meshlet_triangles(max_meshlets * max_triangles * 3);
+
+    size_t meshlet_count;
+    switch (index_stride)
+    {
+    case 4:
+        meshlet_count = meshopt_buildMeshlets(meshlets.data(), meshlet_vertices.data(), meshlet_triangles.data(),
+            (const unsigned int*)indices, index_count,
+            positions, vertex_count, position_stride,
+            max_vertices, max_triangles, cone_weight);
+        break;
+    case 2:
+        meshlet_count = meshopt_buildMeshlets(meshlets.data(), meshlet_vertices.data(), meshlet_triangles.data(),
+            (const unsigned short*)indices, index_count,
+            positions, vertex_count, position_stride,
+            max_vertices, max_triangles, cone_weight);
+        break;
+    case 1:
+        meshlet_count = meshopt_buildMeshlets(meshlets.data(), meshlet_vertices.data(), meshlet_triangles.data(),
+            (const unsigned char*)indices, index_count,
+            positions, vertex_count, position_stride,
+            max_vertices, max_triangles, cone_weight);
+        break;
+    default:
+        RE_ASSERT(false);
+        break;
+    }
+
+    const meshopt_Meshlet& last = meshlets[meshlet_count - 1];
+    meshlet_vertices.resize(last.vertex_offset + last.vertex_count);
+    meshlet_triangles.resize(last.triangle_offset + ((last.triangle_count * 3 + 3) & ~3));
+    meshlets.resize(meshlet_count);
+
+    meshlet_triangles16.reserve(meshlet_triangles.size());
+    for (size_t i = 0; i < meshlet_triangles.size(); ++i)
+    {
+        meshlet_triangles16.push_back(meshlet_triangles[i]);
+    }
+
+    meshlet_bounds.resize(meshlet_count);
+
+    for (size_t i = 0; i < meshlet_count; ++i)
+    {
+        const meshopt_Meshlet& m = meshlets[i];
+
+        meshopt_Bounds meshoptBounds = meshopt_computeMeshletBounds(&meshlet_vertices[m.vertex_offset], &meshlet_triangles[m.triangle_offset],
+            m.triangle_count, positions, vertex_count, position_stride);
+
+        MeshletBound bound;
+        bound.center = float3(meshoptBounds.center);
+        bound.radius = meshoptBounds.radius;
+        bound.axis_x = meshoptBounds.cone_axis_s8[0];
+        bound.axis_y = meshoptBounds.cone_axis_s8[1];
+        bound.axis_z = meshoptBounds.cone_axis_s8[2];
+        bound.cutoff = meshoptBounds.cone_cutoff_s8;
+        bound.vertexCount = m.vertex_count;
+        bound.triangleCount = m.triangle_count;
+        bound.vertexOffset = m.vertex_offset;
+        bound.triangleOffset = m.triangle_offset;
+        
+        meshlet_bounds[i] = bound;
+    }
+}
+
 StaticMesh* GLTFLoader::LoadStaticMesh(const cgltf_primitive* primitive, const eastl::string& name)
 {
     StaticMesh* mesh = new StaticMesh(m_file + " " + name);
@@ -461,100 +619,10 @@ StaticMesh* GLTFLoader::LoadStaticMesh(const cgltf_primitive* primitive, const e
         }
     }
 
-    size_t max_vertices = 64;
-    size_t max_triangles = 124;
-    const float cone_weight = 0.5f;
-    size_t max_meshlets = meshopt_buildMeshletsBound(index_count, max_vertices, max_triangles);
-
-    eastl::vector<meshopt_Meshlet> meshlets(max_meshlets);
-    eastl::vector<unsigned int> meshlet_vertices(max_meshlets * max_vertices);
-    eastl::vector<unsigned char> meshlet_triangles(max_meshlets * max_triangles * 3);
-
-    size_t meshlet_count;
-    switch (indices.stride)
-    {
-    case 4:
-        meshlet_count = meshopt_buildMeshlets(meshlets.data(), meshlet_vertices.data(), meshlet_triangles.data(),
-            (const unsigned int*)remapped_indices, index_count,
-            (const float*)pos_vertices, remapped_vertex_count, pos_stride,
-            max_vertices, max_triangles, cone_weight);
-        break;
-    case 2:
-        meshlet_count = meshopt_buildMeshlets(meshlets.data(), meshlet_vertices.data(), meshlet_triangles.data(),
-            (const unsigned short*)remapped_indices, index_count,
-            (const float*)pos_vertices, remapped_vertex_count, pos_stride,
-            max_vertices, max_triangles, cone_weight);
-        break;
-    case 1:
-        meshlet_count = meshopt_buildMeshlets(meshlets.data(), meshlet_vertices.data(), meshlet_triangles.data(),
-            (const unsigned char*)remapped_indices, index_count,
-            (const float*)pos_vertices, remapped_vertex_count, pos_stride,
-            max_vertices, max_triangles, cone_weight);
-        break;
-    default:
-        RE_ASSERT(false);
-        break;
-    }
-
-    const meshopt_Meshlet& last = meshlets[meshlet_count - 1];
-    meshlet_vertices.resize(last.vertex_offset + last.vertex_count);
-    meshlet_triangles.resize(last.triangle_offset + ((last.triangle_count * 3 + 3) & ~3));
-    meshlets.resize(meshlet_count);
-
+    eastl::vector<MeshletBound> meshlet_bounds;
+    eastl::vector<unsigned int> meshlet_vertices;
     eastl::vector<unsigned short> meshlet_triangles16;
-    meshlet_triangles16.reserve(meshlet_triangles.size());
-    for (size_t i = 0; i < meshlet_triangles.size(); ++i)
-    {
-        meshlet_triangles16.push_back(meshlet_triangles[i]);
-    }
-
-    struct MeshletBound
-    {
-        float3 center;
-        float radius;
-
-        union
-        {
-            //axis + cutoff, rgba8snorm
-            struct
-            {
-                int8_t axis_x;
-                int8_t axis_y;
-                int8_t axis_z;
-                int8_t cutoff;
-            };
-            uint32_t cone; 
-        };
-
-        uint vertexCount;
-        uint triangleCount;
-
-        uint vertexOffset;
-        uint triangleOffset;
-    };
-    eastl::vector<MeshletBound> meshlet_bounds(meshlet_count);
-
-    for (size_t i = 0; i < meshlet_count; ++i)
-    {
-        const meshopt_Meshlet& m = meshlets[i];
-
-        meshopt_Bounds meshoptBounds = meshopt_computeMeshletBounds(&meshlet_vertices[m.vertex_offset], &meshlet_triangles[m.triangle_offset],
-            m.triangle_count, (const float*)pos_vertices, remapped_vertex_count, pos_stride);
-
-        MeshletBound bound;
-        bound.center = float3(meshoptBounds.center);
-        bound.radius = meshoptBounds.radius;
-        bound.axis_x = meshoptBounds.cone_axis_s8[0];
-        bound.axis_y = meshoptBounds.cone_axis_s8[1];
-        bound.axis_z = meshoptBounds.cone_axis_s8[2];
-        bound.cutoff = meshoptBounds.cone_cutoff_s8;
-        bound.vertexCount = m.vertex_count;
-        bound.triangleCount = m.triangle_count;
-        bound.vertexOffset = m.vertex_offset;
-        bound.triangleOffset = m.triangle_offset;
-        
-        meshlet_bounds[i] = bound;
-    }
+    BuildMeshlets(remapped_indices, indices.stride, index_count, (const float*)pos_vertices, remapped_vertex_count, pos_stride, meshlet_bounds, meshlet_vertices, meshlet_triangles16);
 
     Renderer* pRenderer = Engine::GetInstance()->GetRenderer();
     ResourceCache* cache = ResourceCache::GetInstance();
@@ -601,7 +669,7 @@ StaticMesh* GLTFLoader::LoadStaticMesh(const cgltf_primitive* primitive, const e
         }
     }
 
-    mesh->m_nMeshletCount = (uint32_t)meshlet_count;
+    mesh->m_nMeshletCount = (uint32_t)meshlet_bounds.size();
     mesh->m_meshletBufferAddress = cache->GetSceneBuffer("model(" + m_file + " " + name + ") meshlet", meshlet_bounds.data(), sizeof(MeshletBound) * (uint32_t)meshlet_bounds.size());
     mesh->m_meshletVerticesBufferAddress = cache->GetSceneBuffer("model(" + m_file + " " + name + ") meshlet vertices", meshlet_vertices.data(), sizeof(unsigned int) * (uint32_t)meshlet_vertices.size());
     mesh->m_meshletIndicesBufferAddress = cache->GetSceneBuffer("model(" + m_file + " " + name + ") meshlet indices", meshlet_triangles16.data(), sizeof(unsigned short) * (uint32_t)meshlet_triangles16.size());
@@ -634,7 +702,7 @@ Animation* GLTFLoader::LoadAnimation(const cgltf_data* data, const cgltf_animati
         const cgltf_animation_channel* gltf_channel = &gltf_animation->channels[i];
 
         AnimationChannel channel;
-        channel.targetNode = GetNodeIndex(data, gltf_channel->target_node);
+        channel.targetNode = m_nodeRemap[GetNodeIndex(data, gltf_channel->target_node)];
 
         switch (gltf_channel->target_path)
         {
@@ -653,14 +721,36 @@ Animation* GLTFLoader::LoadAnimation(const cgltf_data* data, const cgltf_animati
         }
 
         const cgltf_animation_sampler* sampler = gltf_channel->sampler;
-        RE_ASSERT(sampler->interpolation == cgltf_interpolation_type_linear); //currently only support linear sampler
+        switch (sampler->interpolation)
+        {
+        case cgltf_interpolation_type_linear:
+            channel.interpolation = AnimationChannelInterpolation::Linear;
+            break;
+        case cgltf_interpolation_type_step:
+            channel.interpolation = AnimationChannelInterpolation::Step;
+            break;
+        case cgltf_interpolation_type_cubic_spline:
+            channel.interpolation = AnimationChannelInterpolation::CubicSpline;
+            break;
+        default:
+            RE_ASSERT(false);
+            break;
+        }
 
         cgltf_accessor* time_accessor = sampler->input;
         cgltf_accessor* value_accessor = sampler->output;
-        RE_ASSERT(time_accessor->count == value_accessor->count);
+
+        //cubic spline samplers store (in-tangent, value, out-tangent) per keyframe
+        bool cubic_spline = channel.interpolation == AnimationChannelInterpolation::CubicSpline;
+        cgltf_size values_per_keyframe = cubic_spline ? 3 : 1;
+        RE_ASSERT(time_accessor->count * values_per_keyframe == value_accessor->count);
 
         cgltf_size keyframe_num = time_accessor->count;
         channel.keyframes.reserve(keyframe_num);
+        if (cubic_spline)
+        {
+            channel.tangents.reserve(keyframe_num);
+        }
 
         char* time_data = (char*)time_accessor->buffer_view->buffer->data + time_accessor->buffer_view->offset + time_accessor->offset;
         char* value_data = (char*)value_accessor->buffer_view->buffer->data + value_accessor->buffer_view->offset + value_accessor->offset;
@@ -668,12 +758,24 @@ Animation* GLTFLoader::LoadAnimation(const cgltf_data* data, const cgltf_animati
         for (cgltf_size k = 0; k < keyframe_num; ++k)
         {
             float time;
-            float4 value;
+            float4 value[3] = {};
 
             memcpy(&time, time_data + time_accessor->stride * k, time_accessor->stride);
-            memcpy(&value, value_data + value_accessor->stride * k, value_accessor->stride);
 
-            channel.keyframes.push_back(eastl::make_pair(time, value));
+            for (cgltf_size v = 0; v < values_per_keyframe; ++v)
+            {
+                memcpy(&value[v], value_data + value_accessor->stride * (k * values_per_keyframe + v), value_accessor->stride);
+            }
+
+            if (cubic_spline)
+            {
+                channel.keyframes.push_back(eastl::make_pair(time, value[1]));
+                channel.tangents.push_back(eastl::make_pair(value[0], value[2]));
+            }
+            else
+            {
+                channel.keyframes.push_back(eastl::make_pair(time, value[0]));
+            }
         }
 
         animation->m_channels.push_back(channel);
@@ -683,6 +785,8 @@ Animation* GLTFLoader::LoadAnimation(const cgltf_data* data, const cgltf_animati
         animation->m_timeDuration = max(duration, animation->m_timeDuration);
     }
 
+    animation->PackChannels(m_animationError);
+
     return animation;
 }
 
@@ -696,11 +800,10 @@ Skeleton* GLTFLoader::LoadSkeleton(const cgltf_data* data, const cgltf_skin* ski
     Skeleton* skeleton = new Skeleton(skin->name ? skin->name : "");
     skeleton->m_joints.resize(skin->joints_count);
     skeleton->m_inverseBindMatrices.resize(skin->joints_count);
-    skeleton->m_jointMatrices.resize(skin->joints_count);
 
     for (cgltf_size i = 0; i < skin->joints_count; ++i)
     {
-        skeleton->m_joints[i] = GetNodeIndex(data, skin->joints[i]);
+        skeleton->m_joints[i] = m_nodeRemap[GetNodeIndex(data, skin->joints[i])];
     }
 
     const cgltf_accessor* accessor = skin->inverse_bind_matrices;
@@ -733,34 +836,51 @@ Skeleton* GLTFLoader::LoadSkeleton(const cgltf_data* data, const cgltf_skin* ski
     return skeleton;
 }
 
-SkeletalMeshNode* GLTFLoader::LoadSkeletalMeshNode(const cgltf_data* data, const cgltf_node* gltf_node)
+void GLTFLoader::SortSkeletalMeshNodes(const cgltf_data* data)
 {
-    SkeletalMeshNode* node = new SkeletalMeshNode;
-    node->id = GetNodeIndex(data, gltf_node);
-    node->name = gltf_node->name ? gltf_node->name : fmt::format("node_{}", node->id).c_str();
-    node->parent = gltf_node->parent ? GetNodeIndex(data, gltf_node->parent) : -1;
-    for (cgltf_size i = 0; i < gltf_node->children_count; ++i)
+    m_sortedNodes.clear();
+    m_sortedNodes.reserve(data->nodes_count);
+    m_nodeRemap.resize(data->nodes_count);
+
+    for (cgltf_size i = 0; i < data->nodes_count; ++i)
     {
-        node->children.push_back(GetNodeIndex(data, gltf_node->children[i]));
+        if (data->nodes[i].parent == nullptr)
+        {
+            m_sortedNodes.push_back((uint32_t)i);
+        }
     }
 
-    if (gltf_node->has_matrix)
+    //breadth first, every node is placed after its parent
+    for (size_t i = 0; i < m_sortedNodes.size(); ++i)
     {
-        float4x4 matrix = float4x4(gltf_node->matrix);
-        decompose(matrix, node->translation, node->rotation, node->scale);
+        const cgltf_node* node = &data->nodes[m_sortedNodes[i]];
+        for (cgltf_size c = 0; c < node->children_count; ++c)
+        {
+            m_sortedNodes.push_back(GetNodeIndex(data, node->children[c]));
+        }
     }
-    else
+
+    RE_ASSERT(m_sortedNodes.size() == data->nodes_count);
+
+    for (size_t i = 0; i < m_sortedNodes.size(); ++i)
     {
-        node->translation = float3(gltf_node->translation);
-        node->rotation = float4(gltf_node->rotation);
-        node->scale = float3(gltf_node->scale);
+        m_nodeRemap[m_sortedNodes[i]] = (uint32_t)i;
+    }
+}
+
+SkeletalMeshNode* GLTFLoader::LoadSkeletalMeshNode(const cgltf_data* data, const cgltf_node* gltf_node)
+{
+    uint32_t gltf_node_index = GetNodeIndex(data, gltf_node);
+
+    SkeletalMeshNode* node = new SkeletalMeshNode;
+    node->id = m_nodeRemap[gltf_node_index];
+    node->name = gltf_node->name ? gltf_node->name : fmt::format("node_{}", gltf_node_index).c_str();
+    node->parent = gltf_node->parent ? m_nodeRemap[GetNodeIndex(data, gltf_node->parent)] : -1;
+    for (cgltf_size i = 0; i < gltf_node->children_count; ++i)
+    {
+        node->children.push_back(m_nodeRemap[GetNodeIndex(data, gltf_node->children[i])]);
     }
 
-    //right-hand to left-hand
-    node->translation.z *= -1;
-    node->rotation.z *= -1;
-    node->rotation.w *= -1;
-    
     if (gltf_node->mesh)
     {
         bool vertex_skinning = gltf_node->skin != nullptr;
@@ -783,6 +903,50 @@ SkeletalMeshNode* GLTFLoader::LoadSkeletalMeshNode(const cgltf_data* data, const
     return node;
 }
 
+inline eastl::vector<SkeletalMeshJointBound> BuildJointBounds(const eastl::vector<float3>& positions, const eastl::vector<ushort4>& joint_ids, const eastl::vector<float4>& joint_weights)
+{
+    RE_ASSERT(positions.size() == joint_ids.size() && positions.size() == joint_weights.size());
+
+    eastl::vector<float3> bound_min;
+    eastl::vector<float3> bound_max;
+
+    for (size_t v = 0; v < positions.size(); ++v)
+    {
+        for (uint32_t i = 0; i < 4; ++i)
+        {
+            if (joint_weights[v][i] <= 0.0f)
+            {
+                continue;
+            }
+
+            uint32_t joint = joint_ids[v][i];
+            if (joint >= bound_min.size())
+            {
+                bound_min.resize(joint + 1, float3(FLT_MAX, FLT_MAX, FLT_MAX));
+                bound_max.resize(joint + 1, float3(-FLT_MAX, -FLT_MAX, -FLT_MAX));
+            }
+
+            bound_min[joint] = min(bound_min[joint], positions[v]);
+            bound_max[joint] = max(bound_max[joint], positions[v]);
+        }
+    }
+
+    eastl::vector<SkeletalMeshJointBound> bounds;
+    for (uint32_t joint = 0; joint < (uint32_t)bound_min.size(); ++joint)
+    {
+        if (bound_min[joint].x <= bound_max[joint].x)
+        {
+            SkeletalMeshJointBound bound;
+            bound.joint = joint;
+            bound.center = (bound_min[joint] + bound_max[joint]) * 0.5f;
+            bound.extent = (bound_max[joint] - bound_min[joint]) * 0.5f;
+            bounds.push_back(bound);
+        }
+    }
+
+    return bounds;
+}
+
 SkeletalMeshData* GLTFLoader::LoadSkeletalMesh(const cgltf_primitive* primitive, const eastl::string& name)
 {
     SkeletalMeshData* mesh = new SkeletalMeshData;
@@ -801,6 +965,10 @@ SkeletalMeshData* GLTFLoader::LoadSkeletalMesh(const cgltf_primitive* primitive,
     size_t vertex_count;
     meshopt_Stream vertices;
 
+    eastl::vector<float3> positions;
+    eastl::vector<ushort4> jointIDs;
+    eastl::vector<float4> jointWeights;
+
     for (cgltf_size i = 0; i < primitive->attributes_count; ++i)
     {
         switch (primitive->attributes[i].type)
@@ -809,6 +977,12 @@ SkeletalMeshData* GLTFLoader::LoadSkeletalMesh(const cgltf_primitive* primitive,
             vertices = LoadBufferStream(primitive->attributes[i].data, true, vertex_count);
             mesh->staticPosBufferAddress = cache->GetSceneBuffer("model(" + m_file + " " + name + ") pos", vertices.data, (uint32_t)vertices.stride * (uint32_t)vertex_count);
 
+            positions.resize(vertex_count);
+            for (size_t v = 0; v < vertex_count; ++v)
+            {
+                positions[v] = *(const float3*)((const char*)vertices.data + vertices.stride * v);
+            }
+
             {
                 float3 min = float3(primitive->attributes[i].data->min);
                 min.z = -min.z;
@@ -843,8 +1017,7 @@ SkeletalMeshData* GLTFLoader::LoadSkeletalMesh(const cgltf_primitive* primitive,
         {
             const cgltf_accessor* accessor = primitive->attributes[i].data;
 
-            eastl::vector<ushort4> jointIDs;
-            jointIDs.reserve(accessor->count * 4);
+            jointIDs.reserve(accessor->count);
 
             for (cgltf_size j = 0; j < accessor->count; ++j)
             {
@@ -861,7 +1034,6 @@ SkeletalMeshData* GLTFLoader::LoadSkeletalMesh(const cgltf_primitive* primitive,
         {
             const cgltf_accessor* accessor = primitive->attributes[i].data;
 
-            eastl::vector<float4> jointWeights;
             jointWeights.reserve(accessor->count);
 
             for (cgltf_size j = 0; j < accessor->count; ++j)
@@ -880,5 +1052,20 @@ SkeletalMeshData* GLTFLoader::LoadSkeletalMesh(const cgltf_primitive* primitive,
 
     mesh->vertexCount = (uint32_t)vertex_count;
 
+    if (!jointIDs.empty() && !jointWeights.empty())
+    {
+        mesh->jointBounds = BuildJointBounds(positions, jointIDs, jointWeights);
+    }
+
+    eastl::vector<MeshletBound> meshlet_bounds;
+    eastl::vector<unsigned int> meshlet_vertices;
+    eastl::vector<unsigned short> meshlet_triangles16;
+    BuildMeshlets(indices.data, indices.stride, index_count, (const float*)positions.data(), positions.size(), sizeof(float3), meshlet_bounds, meshlet_vertices, meshlet_triangles16);
+
+    mesh->meshletCount = (uint32_t)meshlet_bounds.size();
+    mesh->meshletBufferAddress = cache->GetSceneBuffer("model(" + m_file + " " + name + ") meshlet", meshlet_bounds.data(), sizeof(MeshletBound) * (uint32_t)meshlet_bounds.size());
+    mesh->meshletVerticesBufferAddress = cache->GetSceneBuffer("model(" + m_file + " " + name + ") meshlet vertices", meshlet_vertices.data(), sizeof(unsigned int) * (uint32_t)meshlet_vertices.size());
+    mesh->meshletIndicesBufferAddress = cache->GetSceneBuffer("model(" + m_file + " " + name + ") meshlet indices", meshlet_triangles16.data(), sizeof(unsigned short) * (uint32_t)meshlet_triangles16.size());
+
     return mesh;
 }
@@ -2,9 +2,11 @@
 
 #include "utils/math.h"
 #include "EASTL/string.h"
+#include "EASTL/vector.h"
 
 class World;
 class StaticMesh;
+class SkeletalMesh;
 class MeshMaterial;
 class Texture2D;
 class Animation;
@@ -29,15 +31,26 @@ class GLTFLoader
 {
 public:
     GLTFLoader(World* world, tinyxml2::XMLElement* element);
+    GLTFLoader(const eastl::string& file); //only for LoadSkeletalModel
 
     void Load();
+
+    //loads the skeletal mesh without creating it or adding it to the world, returns nullptr if the file has no animation
+    SkeletalMesh* LoadSkeletalModel();
+
+    //the skeletal mesh created by Load, nullptr for static models
+    SkeletalMesh* GetSkeletalMesh() const { return m_pSkeletalMesh; }
     
 private:
+    cgltf_data* Parse();
+    SkeletalMesh* CreateSkeletalMesh(const cgltf_data* data);
+
     void LoadStaticMeshNode(const cgltf_data* data, const cgltf_node* node, const float4x4& mtxParentToWorld);
     StaticMesh* LoadStaticMesh(const cgltf_primitive* primitive, const eastl::string& name);
 
     Animation* LoadAnimation(const cgltf_data* data, const cgltf_animation* animation);
     Skeleton* LoadSkeleton(const cgltf_data* data, const cgltf_skin* skin);
+    void SortSkeletalMeshNodes(const cgltf_data* data);
     SkeletalMeshNode* LoadSkeletalMeshNode(const cgltf_data* data, const cgltf_node* node);
     SkeletalMeshData* LoadSkeletalMesh(const cgltf_primitive* primitive, const eastl::string& name);
 
@@ -47,11 +60,17 @@ private:
 private:
     World* m_pWorld = nullptr;
     eastl::string m_file;
+    SkeletalMesh* m_pSkeletalMesh = nullptr;
 
     float3 m_position = float3(0, 0, 0);
     float3 m_rotation = float3(0, 0, 0);
     float3 m_scale = float3(1, 1, 1);
     float4x4 m_mtxWorld;
 
+    float m_animationError = 0.0005f; //max error of keyframe reduction
+
+    eastl::vector<uint32_t> m_sortedNodes; //sorted node -> gltf node
+    eastl::vector<uint32_t> m_nodeRemap; //gltf node -> sorted node
+
     eastl::string m_anisotropicTexture;
 };
\ No newline at end of file
@@ -1,6 +1,7 @@
 #include "mesh_material.h"
 #include "resource_cache.h"
 #include "core/engine.h"
+#include "renderer/pipeline_cache.h"
 #include "utils/gui_util.h"
 
 MeshMaterial::~MeshMaterial()
@@ -45,9 +46,9 @@ IGfxPipelineState* MeshMaterial::GetPSO()
         psoDesc.rt_format[4] = GfxFormat::RGBA8UNORM;
         psoDesc.depthstencil_format = GfxFormat::D32F;
 
-        m_pPSO = pRenderer->GetPipelineState(psoDesc, "model PSO");
+        m_pPSO = pRenderer->GetPipelineState(psoDesc, "model PSO", true);
     }
-    return m_pPSO;
+    return GetReadyPSO(m_pPSO);
 }
 
 IGfxPipelineState* MeshMaterial::GetMeshletPSO()
@@ -74,9 +75,9 @@ IGfxPipelineState* MeshMaterial::GetMeshletPSO()
         psoDesc.rt_format[4] = GfxFormat::RGBA8UNORM;
         psoDesc.depthstencil_format = GfxFormat::D32F;
 
-        m_pMeshletPSO = pRenderer->GetPipelineState(psoDesc, "model meshlet PSO");
+        m_pMeshletPSO = pRenderer->GetPipelineState(psoDesc, "model meshlet PSO", true);
     }
-    return m_pMeshletPSO;
+    return GetReadyPSO(m_pMeshletPSO);
 }
 
 IGfxPipelineState* MeshMaterial::GetShadowPSO()
@@ -106,9 +107,9 @@ IGfxPipelineState* MeshMaterial::GetShadowPSO()
         psoDesc.depthstencil_state.depth_func = GfxCompareFunc::LessEqual;
         psoDesc.depthstencil_format = GfxFormat::D16;
 
-        m_pShadowPSO = pRenderer->GetPipelineState(psoDesc, "model shadow PSO");
+        m_pShadowPSO = pRenderer->GetPipelineState(psoDesc, "model shadow PSO", true);
     }
-    return m_pShadowPSO;
+    return GetReadyPSO(m_pShadowPSO);
 }
 
 IGfxPipelineState* MeshMaterial::GetVelocityPSO()
@@ -136,9 +137,9 @@ IGfxPipelineState* MeshMaterial::GetVelocityPSO()
         psoDesc.rt_format[0] = GfxFormat::RGBA16F;
         psoDesc.depthstencil_format = GfxFormat::D32F;
 
-        m_pVelocityPSO = pRenderer->GetPipelineState(psoDesc, "model velocity PSO");
+        m_pVelocityPSO = pRenderer->GetPipelineState(psoDesc, "model velocity PSO", true);
     }
-    return m_pVelocityPSO;
+    return GetReadyPSO(m_pVelocityPSO);
 }
 
 IGfxPipelineState* MeshMaterial::GetIDPSO()
@@ -165,9 +166,9 @@ IGfxPipelineState* MeshMaterial::GetIDPSO()
         psoDesc.rt_format[0] = GfxFormat::R32UI;
         psoDesc.depthstencil_format = GfxFormat::D32F;
 
-        m_pIDPSO = pRenderer->GetPipelineState(psoDesc, "model ID PSO");
+        m_pIDPSO = pRenderer->GetPipelineState(psoDesc, "model ID PSO", true);
     }
-    return m_pIDPSO;
+    return GetReadyPSO(m_pIDPSO);
 }
 
 IGfxPipelineState* MeshMaterial::GetOutlinePSO()
@@ -194,9 +195,9 @@ IGfxPipelineState* MeshMaterial::GetOutlinePSO()
         psoDesc.rt_format[0] = GfxFormat::RGBA16F;
         psoDesc.depthstencil_format = GfxFormat::D32F;
 
-        m_pOutlinePSO = pRenderer->GetPipelineState(psoDesc, "model outline PSO");
+        m_pOutlinePSO = pRenderer->GetPipelineState(psoDesc, "model outline PSO", true);
     }
-    return m_pOutlinePSO;
+    return GetReadyPSO(m_pOutlinePSO);
 }
 
 IGfxPipelineState* MeshMaterial::GetVertexSkinningPSO()
@@ -212,6 +213,26 @@ IGfxPipelineState* MeshMaterial::GetVertexSkinningPSO()
     return m_pVertexSkinningPSO;
 }
 
+IGfxPipelineState* MeshMaterial::GetSkinnedMeshletPSO()
+{
+    if (m_pSkinnedMeshletPSO == nullptr)
+    {
+        Renderer* pRenderer = Engine::GetInstance()->GetRenderer();
+
+        GfxComputePipelineDesc desc;
+        desc.cs = pRenderer->GetShader("skinned_meshlet.hlsl", "main", "cs_6_6", {});
+        m_pSkinnedMeshletPSO = pRenderer->GetPipelineState(desc, "skinned meshlet PSO");
+    }
+    return m_pSkinnedMeshletPSO;
+}
+
+IGfxPipelineState* MeshMaterial::GetReadyPSO(IGfxPipelineState* pso) const
+{
+    //in the async creation mode, the mesh skips the pass until the PSO is created
+    PipelineStateCache* pipelineCache = Engine::GetInstance()->GetRenderer()->GetPipelineStateCache();
+    return pipelineCache->IsReady(pso) ? pso : nullptr;
+}
+
 void MeshMaterial::UpdateConstants()
 {
     m_materialCB.shadingModel = (uint)m_shadingModel;
@@ -10,6 +10,7 @@ class MeshMaterial
 public:
     ~MeshMaterial();
 
+    //the material PSOs are created asynchronously, they are nullptr before ready
     IGfxPipelineState* GetPSO();
     IGfxPipelineState* GetShadowPSO();
     IGfxPipelineState* GetVelocityPSO();
@@ -19,6 +20,7 @@ public:
     IGfxPipelineState* GetMeshletPSO();
 
     IGfxPipelineState* GetVertexSkinningPSO();
+    IGfxPipelineState* GetSkinnedMeshletPSO();
 
     void UpdateConstants();
     const ModelMaterialConstant* GetConstants() const { return &m_materialCB; }
@@ -31,6 +33,7 @@ public:
 
 private:
     void AddMaterialDefines(eastl::vector<eastl::string>& defines);
+    IGfxPipelineState* GetReadyPSO(IGfxPipelineState* pso) const;
 
 private:
     eastl::string m_name;
@@ -43,6 +46,7 @@ private:
     IGfxPipelineState* m_pOutlinePSO = nullptr;
     IGfxPipelineState* m_pMeshletPSO = nullptr;
     IGfxPipelineState* m_pVertexSkinningPSO = nullptr;
+    IGfxPipelineState* m_pSkinnedMeshletPSO = nullptr;
 
     ShadingModel m_shadingModel = ShadingModel::Default;
 
@@ -72,6 +72,25 @@ uint32_t ResourceCache::GetSceneBuffer(const eastl::string& name, const void* da
     return buffer.address;
 }
 
+void ResourceCache::RetainSceneBuffer(uint32_t address)
+{
+    if (address == -1)
+    {
+        return;
+    }
+
+    for (auto iter = m_cachedSceneBuffer.begin(); iter != m_cachedSceneBuffer.end(); ++iter)
+    {
+        if (iter->second.address == address)
+        {
+            iter->second.refCount++;
+            return;
+        }
+    }
+
+    RE_ASSERT(false);
+}
+
 void ResourceCache::RelaseSceneBuffer(uint32_t address)
 {
     if (address == -1)
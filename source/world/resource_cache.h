@@ -12,6 +12,7 @@ public:
     void ReleaseTexture2D(Texture2D* texture);
 
     uint32_t GetSceneBuffer(const eastl::string& name, const void* data, uint32_t size);
+    void RetainSceneBuffer(uint32_t address); //for sharing a buffer whose name is unknown, e.g. instancing a loaded model
     void RelaseSceneBuffer(uint32_t address);
 
 private:
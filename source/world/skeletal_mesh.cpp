@@ -5,6 +5,7 @@
 #include "resource_cache.h"
 #include "core/engine.h"
 #include "utils/gui_util.h"
+#include "meshlet.hlsli"
 
 SkeletalMeshData::~SkeletalMeshData()
 {
@@ -20,12 +21,18 @@ SkeletalMeshData::~SkeletalMeshData()
 
     cache->RelaseSceneBuffer(indexBufferAddress);
 
+    cache->RelaseSceneBuffer(meshletBufferAddress);
+    cache->RelaseSceneBuffer(meshletVerticesBufferAddress);
+    cache->RelaseSceneBuffer(meshletIndicesBufferAddress);
+
     Renderer* pRenderer = Engine::GetInstance()->GetRenderer();
     pRenderer->FreeSceneAnimationBuffer(animPosBufferAddress);
     pRenderer->FreeSceneAnimationBuffer(animNormalBufferAddress);
     pRenderer->FreeSceneAnimationBuffer(animTangentBufferAddress);
 
     pRenderer->FreeSceneAnimationBuffer(prevAnimPosBufferAddress);
+
+    pRenderer->FreeSceneAnimationBuffer(animMeshletBufferAddress);
 }
 
 SkeletalMesh::SkeletalMesh(const eastl::string& name)
@@ -64,6 +71,11 @@ void SkeletalMesh::Create(SkeletalMeshData* mesh)
         {
             mesh->animTangentBufferAddress = m_pRenderer->AllocateSceneAnimationBuffer(sizeof(float4) * mesh->vertexCount);
         }
+
+        if (mesh->meshletCount > 0)
+        {
+            mesh->animMeshletBufferAddress = m_pRenderer->AllocateSceneAnimationBuffer(sizeof(Meshlet) * mesh->meshletCount);
+        }
     }
 
     GfxRayTracingGeometry geometry;
@@ -109,22 +121,110 @@ void SkeletalMesh::Tick(float delta_time)
     float4x4 S = scaling_matrix(m_scale);
     m_mtxWorld = mul(T, mul(R, S));
 
-    m_pAnimation->Update(this, delta_time); //update node local transform
+    UpdateMeshConstants();
+}
+
+void SkeletalMesh::UpdateAnimation(float delta_time)
+{
+    UpdatePose(delta_time);
 
-    for (size_t i = 0; i < m_rootNodes.size(); ++i)
+    if (m_pSkeleton)
     {
-        UpdateNodeTransform(GetNode(m_rootNodes[i])); //update node global transform
+        m_jointMatricesAddress = m_pRenderer->AllocateSceneConstant(m_jointMatrices.data(), sizeof(float4x4) * (uint32_t)m_jointMatrices.size());
     }
+}
+
+void SkeletalMesh::UpdatePose(float delta_time)
+{
+    m_pAnimation->Update(this, m_animationState, delta_time); //update node local transform
+
+    UpdateNodeTransforms(); //update node global transform
 
     if (m_pSkeleton)
     {
-        m_pSkeleton->Update(this);
+        m_pSkeleton->Update(this, m_jointMatrices.data());
+
+        UpdateSkinnedBounds();
     }
+}
+
+SkeletalMesh* SkeletalMesh::Instantiate() const
+{
+    ResourceCache* cache = ResourceCache::GetInstance();
+
+    SkeletalMesh* instance = new SkeletalMesh(m_name);
+    instance->m_pRenderer = m_pRenderer;
+    instance->m_pSkeleton = m_pSkeleton;
+    instance->m_pAnimation = m_pAnimation;
+    m_pAnimation->InitState(instance->m_animationState);
+    instance->m_jointMatrices.resize(m_jointMatrices.size());
+
+    instance->m_nodeParents = m_nodeParents;
+    instance->m_nodeTranslations = m_nodeTranslations;
+    instance->m_nodeRotations = m_nodeRotations;
+    instance->m_nodeScales = m_nodeScales;
+    instance->m_nodeGlobalTransforms = m_nodeGlobalTransforms;
 
-    for (size_t i = 0; i < m_rootNodes.size(); ++i)
+    for (size_t i = 0; i < m_nodes.size(); ++i)
     {
-        UpdateMeshConstants(GetNode(m_rootNodes[i]));
+        const SkeletalMeshNode* node = m_nodes[i].get();
+
+        SkeletalMeshNode* new_node = new SkeletalMeshNode;
+        new_node->name = node->name;
+        new_node->id = node->id;
+        new_node->parent = node->parent;
+        new_node->children = node->children;
+
+        for (size_t j = 0; j < node->meshes.size(); ++j)
+        {
+            const SkeletalMeshData* mesh = node->meshes[j].get();
+
+            //the anim buffers and the BLAS are per instance, they are created in Create()
+            SkeletalMeshData* new_mesh = new SkeletalMeshData;
+            new_mesh->name = mesh->name;
+            new_mesh->nodeID = mesh->nodeID;
+            new_mesh->material = mesh->material;
+
+            new_mesh->uvBufferAddress = mesh->uvBufferAddress;
+            new_mesh->jointIDBufferAddress = mesh->jointIDBufferAddress;
+            new_mesh->jointWeightBufferAddress = mesh->jointWeightBufferAddress;
+            new_mesh->staticPosBufferAddress = mesh->staticPosBufferAddress;
+            new_mesh->staticNormalBufferAddress = mesh->staticNormalBufferAddress;
+            new_mesh->staticTangentBufferAddress = mesh->staticTangentBufferAddress;
+            new_mesh->indexBufferAddress = mesh->indexBufferAddress;
+            new_mesh->meshletBufferAddress = mesh->meshletBufferAddress;
+            new_mesh->meshletVerticesBufferAddress = mesh->meshletVerticesBufferAddress;
+            new_mesh->meshletIndicesBufferAddress = mesh->meshletIndicesBufferAddress;
+
+            cache->RetainSceneBuffer(new_mesh->uvBufferAddress);
+            cache->RetainSceneBuffer(new_mesh->jointIDBufferAddress);
+            cache->RetainSceneBuffer(new_mesh->jointWeightBufferAddress);
+            cache->RetainSceneBuffer(new_mesh->staticPosBufferAddress);
+            cache->RetainSceneBuffer(new_mesh->staticNormalBufferAddress);
+            cache->RetainSceneBuffer(new_mesh->staticTangentBufferAddress);
+            cache->RetainSceneBuffer(new_mesh->indexBufferAddress);
+            cache->RetainSceneBuffer(new_mesh->meshletBufferAddress);
+            cache->RetainSceneBuffer(new_mesh->meshletVerticesBufferAddress);
+            cache->RetainSceneBuffer(new_mesh->meshletIndicesBufferAddress);
+
+            new_mesh->indexBufferFormat = mesh->indexBufferFormat;
+            new_mesh->indexCount = mesh->indexCount;
+            new_mesh->vertexCount = mesh->vertexCount;
+            new_mesh->meshletCount = mesh->meshletCount;
+
+            new_mesh->center = mesh->center;
+            new_mesh->radius = mesh->radius;
+            new_mesh->jointBounds = mesh->jointBounds;
+            new_mesh->animBoundMin = mesh->animBoundMin;
+            new_mesh->animBoundMax = mesh->animBoundMax;
+
+            new_node->meshes.emplace_back(new_mesh);
+        }
+
+        instance->m_nodes.emplace_back(new_node);
     }
+
+    return instance;
 }
 
 void SkeletalMesh::Render(Renderer* pRenderer)
@@ -141,7 +241,7 @@ void SkeletalMesh::Render(Renderer* pRenderer)
 
 bool SkeletalMesh::FrustumCull(const float4* planes, uint32_t plane_count) const
 {
-    return ::FrustumCull(planes, plane_count, m_pos, m_radius); //todo : not correct
+    return ::FrustumCull(planes, plane_count, m_boundCenter, m_boundRadius);
 }
 
 SkeletalMeshNode* SkeletalMesh::GetNode(uint32_t node_id) const
@@ -150,22 +250,74 @@ SkeletalMeshNode* SkeletalMesh::GetNode(uint32_t node_id) const
     return m_nodes[node_id].get();
 }
 
-void SkeletalMesh::UpdateNodeTransform(SkeletalMeshNode* node)
+void SkeletalMesh::UpdateNodeTransforms()
 {
-    float4x4 T = translation_matrix(node->translation);
-    float4x4 R = rotation_matrix(node->rotation);
-    float4x4 S = scaling_matrix(node->scale);
-    node->globalTransform = mul(T, mul(R, S));
+    for (size_t i = 0; i < m_nodeGlobalTransforms.size(); ++i)
+    {
+        float4x4 T = translation_matrix(m_nodeTranslations[i]);
+        float4x4 R = rotation_matrix(m_nodeRotations[i]);
+        float4x4 S = scaling_matrix(m_nodeScales[i]);
+        float4x4 mtxLocal = mul(T, mul(R, S));
 
-    if (node->parent != -1)
+        uint32_t parent = m_nodeParents[i];
+        m_nodeGlobalTransforms[i] = parent != -1 ? mul(m_nodeGlobalTransforms[parent], mtxLocal) : mtxLocal;
+    }
+}
+
+void SkeletalMesh::UpdateSkinnedBounds()
+{
+    for (size_t n = 0; n < m_nodes.size(); ++n)
     {
-        node->globalTransform = mul(GetNode(node->parent)->globalTransform, node->globalTransform);
+        for (size_t i = 0; i < m_nodes[n]->meshes.size(); ++i)
+        {
+            SkeletalMeshData* mesh = m_nodes[n]->meshes[i].get();
+            if (mesh->jointBounds.empty())
+            {
+                continue;
+            }
+
+            //skinned vertices are weighted averages of their joint transformed positions,
+            //so they are inside the union of the transformed bounds of their joints
+            float3 bound_min = float3(FLT_MAX, FLT_MAX, FLT_MAX);
+            float3 bound_max = float3(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+
+            for (size_t j = 0; j < mesh->jointBounds.size(); ++j)
+            {
+                const SkeletalMeshJointBound& bound = mesh->jointBounds[j];
+                const float4x4& mtxJoint = m_jointMatrices[bound.joint];
+
+                float3 center = mul(mtxJoint, float4(bound.center, 1.0f)).xyz();
+                float3 extent = abs(mtxJoint[0].xyz()) * bound.extent.x + abs(mtxJoint[1].xyz()) * bound.extent.y + abs(mtxJoint[2].xyz()) * bound.extent.z;
+
+                bound_min = min(bound_min, center - extent);
+                bound_max = max(bound_max, center + extent);
+            }
+
+            mesh->animBoundMin = bound_min;
+            mesh->animBoundMax = bound_max;
+        }
     }
+}
 
-    for (size_t i = 0; i < node->children.size(); ++i)
+void SkeletalMesh::UpdateMeshConstants()
+{
+    float3 bound_min = float3(FLT_MAX, FLT_MAX, FLT_MAX);
+    float3 bound_max = float3(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+
+    for (size_t n = 0; n < m_nodes.size(); ++n)
     {
-        UpdateNodeTransform(GetNode(node->children[i]));
+        UpdateMeshConstants(m_nodes[n].get());
+
+        for (size_t i = 0; i < m_nodes[n]->meshes.size(); ++i)
+        {
+            const InstanceData& instanceData = m_nodes[n]->meshes[i]->instanceData;
+            bound_min = min(bound_min, instanceData.center - instanceData.radius);
+            bound_max = max(bound_max, instanceData.center + instanceData.radius);
+        }
     }
+
+    m_boundCenter = (bound_min + bound_max) * 0.5f;
+    m_boundRadius = length(bound_max - bound_min) * 0.5f;
 }
 
 void SkeletalMesh::UpdateMeshConstants(SkeletalMeshNode* node)
@@ -185,32 +337,44 @@ void SkeletalMesh::UpdateMeshConstants(SkeletalMeshNode* node)
 
         mesh->instanceData.uvBufferAddress = mesh->uvBufferAddress;
 
+        mesh->instanceData.meshletCount = mesh->meshletCount;
+        mesh->instanceData.meshletVerticesBufferAddress = mesh->meshletVerticesBufferAddress;
+        mesh->instanceData.meshletIndicesBufferAddress = mesh->meshletIndicesBufferAddress;
+
         bool isSkinnedMesh = mesh->material->IsVertexSkinned();
         if (isSkinnedMesh)
         {
             mesh->instanceData.posBufferAddress = mesh->animPosBufferAddress;
             mesh->instanceData.normalBufferAddress = mesh->animNormalBufferAddress;
             mesh->instanceData.tangentBufferAddress = mesh->animTangentBufferAddress;
+            mesh->instanceData.meshletBufferAddress = mesh->animMeshletBufferAddress;
         }
         else
         {
             mesh->instanceData.posBufferAddress = mesh->staticPosBufferAddress;
             mesh->instanceData.normalBufferAddress = mesh->staticNormalBufferAddress;
             mesh->instanceData.tangentBufferAddress = mesh->staticTangentBufferAddress;
+            mesh->instanceData.meshletBufferAddress = mesh->meshletBufferAddress;
         }
 
         mesh->instanceData.bVertexAnimation = isSkinnedMesh;
         mesh->instanceData.materialDataAddress = m_pRenderer->AllocateSceneConstant((void*)mesh->material->GetConstants(), sizeof(ModelMaterialConstant));
         mesh->instanceData.objectID = m_nID;
 
-        SkeletalMeshNode* node = GetNode(mesh->nodeID);
-        float4x4 mtxNodeWorld = mul(m_mtxWorld, node->globalTransform);
+        float4x4 mtxNodeWorld = mul(m_mtxWorld, GetNodeGlobalTransform(mesh->nodeID));
+        const float4x4& mtxBoundWorld = isSkinnedMesh ? m_mtxWorld : mtxNodeWorld;
 
-        mesh->instanceData.scale = max(max(abs(m_scale.x), abs(m_scale.y)), abs(m_scale.z)) * m_boundScaleFactor;
+        float3 center = mesh->center;
+        float radius = mesh->radius;
+        if (isSkinnedMesh && !mesh->jointBounds.empty())
+        {
+            center = (mesh->animBoundMin + mesh->animBoundMax) * 0.5f;
+            radius = length(mesh->animBoundMax - mesh->animBoundMin) * 0.5f;
+        }
 
-        mesh->instanceData.center = mul(m_mtxWorld, float4(mesh->center, 1.0)).xyz(); //todo : not correct
-        mesh->instanceData.radius = mesh->radius * mesh->instanceData.scale;
-        m_radius = max(m_radius, mesh->instanceData.radius);
+        mesh->instanceData.scale = max(max(length(mtxBoundWorld[0].xyz()), length(mtxBoundWorld[1].xyz())), length(mtxBoundWorld[2].xyz()));
+        mesh->instanceData.center = mul(mtxBoundWorld, float4(center, 1.0)).xyz();
+        mesh->instanceData.radius = radius * mesh->instanceData.scale;
 
         mesh->instanceData.mtxPrevWorld = mesh->instanceData.mtxWorld;
         mesh->instanceData.mtxWorld = isSkinnedMesh ? m_mtxWorld : mtxNodeWorld;
@@ -224,11 +388,6 @@ void SkeletalMesh::UpdateMeshConstants(SkeletalMeshNode* node)
             m_pRenderer->UpdateRayTracingBLAS(mesh->blas.get(), m_pRenderer->GetSceneAnimationBuffer(), mesh->animPosBufferAddress);
         }
     }
-
-    for (size_t i = 0; i < node->children.size(); ++i)
-    {
-        UpdateMeshConstants(GetNode(node->children[i]));
-    }
 }
 
 void SkeletalMesh::Draw(const SkeletalMeshData* mesh)
@@ -242,27 +401,57 @@ void SkeletalMesh::Draw(const SkeletalMeshData* mesh)
     {
         ComputeBatch& batch = m_pRenderer->AddAnimationBatch();
         UpdateVertexSkinning(batch, mesh);
+
+        if (mesh->meshletCount > 0)
+        {
+            ComputeBatch& meshletBatch = m_pRenderer->AddSkinnedMeshletBatch();
+            UpdateMeshletBounds(meshletBatch, mesh);
+        }
     }
 
-    RenderBatch& batch = m_pRenderer->AddBasePassBatch();
-    Draw(batch, mesh, mesh->material->GetPSO());
+    //the material PSOs are nullptr until they are created
+    IGfxPipelineState* pBasePassPSO = mesh->meshletCount > 0 ? mesh->material->GetMeshletPSO() : mesh->material->GetPSO();
+    if (pBasePassPSO)
+    {
+        RenderBatch& batch = m_pRenderer->AddBasePassBatch();
+        if (mesh->meshletCount > 0)
+        {
+            Dispatch(batch, mesh, pBasePassPSO);
+        }
+        else
+        {
+            Draw(batch, mesh, pBasePassPSO);
+        }
+    }
 
     if (mesh->material->IsVertexSkinned() || !nearly_equal(mesh->instanceData.mtxPrevWorld, mesh->instanceData.mtxWorld))
     {
-        RenderBatch& velocityPassBatch = m_pRenderer->AddVelocityPassBatch();
-        Draw(velocityPassBatch, mesh, mesh->material->GetVelocityPSO());
+        IGfxPipelineState* pVelocityPSO = mesh->material->GetVelocityPSO();
+        if (pVelocityPSO)
+        {
+            RenderBatch& velocityPassBatch = m_pRenderer->AddVelocityPassBatch();
+            Draw(velocityPassBatch, mesh, pVelocityPSO);
+        }
     }
 
     if (m_pRenderer->IsEnableMouseHitTest())
     {
-        RenderBatch& idPassBatch = m_pRenderer->AddObjectIDPassBatch();
-        Draw(idPassBatch, mesh, mesh->material->GetIDPSO());
+        IGfxPipelineState* pIDPSO = mesh->material->GetIDPSO();
+        if (pIDPSO)
+        {
+            RenderBatch& idPassBatch = m_pRenderer->AddObjectIDPassBatch();
+            Draw(idPassBatch, mesh, pIDPSO);
+        }
     }
 
     if (m_nID == m_pRenderer->GetMouseHitObjectID())
     {
-        RenderBatch& outlinePassBatch = m_pRenderer->AddForwardPassBatch();
-        Draw(outlinePassBatch, mesh, mesh->material->GetOutlinePSO());
+        IGfxPipelineState* pOutlinePSO = mesh->material->GetOutlinePSO();
+        if (pOutlinePSO)
+        {
+            RenderBatch& outlinePassBatch = m_pRenderer->AddForwardPassBatch();
+            Draw(outlinePassBatch, mesh, pOutlinePSO);
+        }
     }
 }
 
@@ -284,13 +473,31 @@ void SkeletalMesh::UpdateVertexSkinning(ComputeBatch& batch, const SkeletalMeshD
 
         mesh->jointIDBufferAddress,
         mesh->jointWeightBufferAddress,
-        m_pSkeleton->GetJointMatricesAddress(),
+        m_jointMatricesAddress,
     };
 
     batch.SetConstantBuffer(1, cb, sizeof(cb));
     batch.Dispatch((mesh->vertexCount + 63) / 64, 1, 1);
 }
 
+void SkeletalMesh::UpdateMeshletBounds(ComputeBatch& batch, const SkeletalMeshData* mesh)
+{
+    batch.label = m_name.c_str();
+    batch.SetPipelineState(mesh->material->GetSkinnedMeshletPSO());
+
+    uint32_t cb[5] = {
+        mesh->meshletCount,
+        mesh->meshletBufferAddress,
+        mesh->meshletVerticesBufferAddress,
+
+        mesh->animPosBufferAddress,
+        mesh->animMeshletBufferAddress,
+    };
+
+    batch.SetConstantBuffer(1, cb, sizeof(cb));
+    batch.Dispatch((mesh->meshletCount + 63) / 64, 1, 1);
+}
+
 void SkeletalMesh::Draw(RenderBatch& batch, const SkeletalMeshData* mesh, IGfxPipelineState* pso)
 {
     uint32_t root_consts[2] = { mesh->instanceIndex, mesh->prevAnimPosBufferAddress };
@@ -303,6 +510,16 @@ void SkeletalMesh::Draw(RenderBatch& batch, const SkeletalMeshData* mesh, IGfxPi
     batch.DrawIndexed(mesh->indexCount);
 }
 
+void SkeletalMesh::Dispatch(RenderBatch& batch, const SkeletalMeshData* mesh, IGfxPipelineState* pso)
+{
+    batch.label = m_name.c_str();
+    batch.SetPipelineState(pso);
+    batch.center = mesh->instanceData.center;
+    batch.radius = mesh->instanceData.radius;
+    batch.meshletCount = mesh->meshletCount;
+    batch.instanceIndex = mesh->instanceIndex;
+}
+
 void SkeletalMesh::OnGui()
 {
     IVisibleObject::OnGui();
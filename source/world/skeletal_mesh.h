@@ -1,17 +1,25 @@
 #pragma once
 
 #include "visible_object.h"
+#include "animation.h"
+#include "EASTL/shared_ptr.h"
 
 class Skeleton;
-class Animation;
 class MeshMaterial;
 
+struct SkeletalMeshJointBound
+{
+    uint32_t joint; //index in the skeleton
+    float3 center; //bind space
+    float3 extent;
+};
+
 struct SkeletalMeshData
 {
     eastl::string name;
     uint32_t nodeID;
 
-    eastl::unique_ptr<MeshMaterial> material;
+    eastl::shared_ptr<MeshMaterial> material; //shared by the instances
     eastl::unique_ptr<IGfxRayTracingBLAS> blas;
 
     uint32_t uvBufferAddress = -1;
@@ -33,12 +41,25 @@ struct SkeletalMeshData
     uint32_t indexCount = 0;
     uint32_t vertexCount = 0;
 
+    uint32_t meshletCount = 0;
+    uint32_t meshletBufferAddress = -1; //bind pose
+    uint32_t meshletVerticesBufferAddress = -1;
+    uint32_t meshletIndicesBufferAddress = -1;
+    uint32_t animMeshletBufferAddress = -1; //skinned bounds, updated every frame
+
     InstanceData instanceData = {};
     uint32_t instanceIndex = 0;
 
     float3 center;
     float radius = 0.0;
 
+    //bind space bounds of the vertices influenced by each joint
+    eastl::vector<SkeletalMeshJointBound> jointBounds;
+
+    //skinned bounds in model space, updated every frame
+    float3 animBoundMin;
+    float3 animBoundMax;
+
     ~SkeletalMeshData();
 };
 
@@ -49,13 +70,6 @@ struct SkeletalMeshNode
     uint32_t parent;
     eastl::vector<uint32_t> children;
     eastl::vector<eastl::unique_ptr<SkeletalMeshData>> meshes;
-
-    //local transform
-    float3 translation;
-    float4 rotation;
-    float3 scale;
-
-    float4x4 globalTransform;
 };
 
 class SkeletalMesh : public IVisibleObject
@@ -67,20 +81,39 @@ public:
 
     virtual bool Create() override;
     virtual void Tick(float delta_time) override;
+    virtual bool IsAnimated() const override { return true; }
+    virtual void UpdateAnimation(float delta_time) override;
     virtual void Render(Renderer* pRenderer) override;
     virtual bool FrustumCull(const float4* planes, uint32_t plane_count) const override;
     virtual void OnGui() override;
 
     SkeletalMeshNode* GetNode(uint32_t node_id) const;
+    uint32_t GetNodeCount() const { return (uint32_t)m_nodes.size(); }
+    uint32_t GetJointCount() const { return (uint32_t)m_jointMatrices.size(); }
+
+    //CPU part of UpdateAnimation : node transforms, joint matrices and skinned bounds, without uploading the joint matrices
+    void UpdatePose(float delta_time);
+
+    //new instance sharing the animation, skeleton, materials and static buffers, it is not created yet
+    SkeletalMesh* Instantiate() const;
+
+    void SetNodeTranslation(uint32_t node_id, const float3& translation) { m_nodeTranslations[node_id] = translation; }
+    void SetNodeRotation(uint32_t node_id, const float4& rotation) { m_nodeRotations[node_id] = rotation; }
+    void SetNodeScale(uint32_t node_id, const float3& scale) { m_nodeScales[node_id] = scale; }
+    const float4x4& GetNodeGlobalTransform(uint32_t node_id) const { return m_nodeGlobalTransforms[node_id]; }
 
 private:
     void Create(SkeletalMeshData* mesh);
 
-    void UpdateNodeTransform(SkeletalMeshNode* node);
+    void UpdateNodeTransforms();
+    void UpdateSkinnedBounds();
+    void UpdateMeshConstants();
     void UpdateMeshConstants(SkeletalMeshNode* node);
 
     void Draw(const SkeletalMeshData* mesh);
     void UpdateVertexSkinning(ComputeBatch& batch, const SkeletalMeshData* mesh);
+    void UpdateMeshletBounds(ComputeBatch& batch, const SkeletalMeshData* mesh);
+    void Dispatch(RenderBatch& batch, const SkeletalMeshData* mesh, IGfxPipelineState* pso);
     void Draw(RenderBatch& batch, const SkeletalMeshData* mesh, IGfxPipelineState* pso);
 
 private:
@@ -89,12 +122,21 @@ private:
 
     float4x4 m_mtxWorld;
 
-    eastl::unique_ptr<Skeleton> m_pSkeleton;
-    eastl::unique_ptr<Animation> m_pAnimation;
+    eastl::shared_ptr<Skeleton> m_pSkeleton;
+    eastl::shared_ptr<Animation> m_pAnimation;
+    AnimationState m_animationState;
 
-    eastl::vector<eastl::unique_ptr<SkeletalMeshNode>> m_nodes;
-    eastl::vector<uint32_t> m_rootNodes;
+    eastl::vector<float4x4> m_jointMatrices;
+    uint32_t m_jointMatricesAddress = 0;
 
-    float m_radius = 0.0f;
-    float m_boundScaleFactor = 3.0f;
+    //nodes are sorted parent-before-child, so global transforms can be updated in one linear pass
+    eastl::vector<eastl::unique_ptr<SkeletalMeshNode>> m_nodes;
+    eastl::vector<uint32_t> m_nodeParents;
+    eastl::vector<float3> m_nodeTranslations; //local transform
+    eastl::vector<float4> m_nodeRotations;
+    eastl::vector<float3> m_nodeScales;
+    eastl::vector<float4x4> m_nodeGlobalTransforms;
+
+    float3 m_boundCenter = { 0.0f, 0.0f, 0.0f }; //world space
+    float m_boundRadius = 0.0f;
 };
\ No newline at end of file
@@ -5,8 +5,8 @@
 #include "EASTL/vector.h"
 
 class SkeletalMesh;
-class Renderer;
 
+//not modified after loading, so it is shared by the instances of a model. the joint matrices are stored in SkeletalMesh
 class Skeleton
 {
     friend class GLTFLoader;
@@ -14,16 +14,13 @@ class Skeleton
 public:
     Skeleton(const eastl::string& name);
 
-    void Update(const SkeletalMesh* mesh);
+    uint32_t GetJointCount() const { return (uint32_t)m_joints.size(); }
 
-    uint32_t GetJointMatricesAddress() const { return m_jointMatricesAddress; }
+    //joint_matrices should have GetJointCount() elements
+    void Update(const SkeletalMesh* mesh, float4x4* joint_matrices) const;
 
 private:
-    Renderer* m_pRenderer;
     eastl::string m_name;
     eastl::vector<uint32_t> m_joints;
     eastl::vector<float4x4> m_inverseBindMatrices;
-
-    eastl::vector<float4x4> m_jointMatrices;
-    uint32_t m_jointMatricesAddress;
-};
\ No newline at end of file
+};
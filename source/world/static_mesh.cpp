@@ -114,29 +114,51 @@ void StaticMesh::Render(Renderer* pRenderer)
         return; //todo
     }
 
-    RenderBatch& bassPassBatch = pRenderer->AddBasePassBatch();
+    //the material PSOs are nullptr until they are created
 #if 1
-    Dispatch(bassPassBatch, m_pMaterial->GetMeshletPSO());
+    IGfxPipelineState* pBasePassPSO = m_pMaterial->GetMeshletPSO();
+    if (pBasePassPSO)
+    {
+        RenderBatch& bassPassBatch = pRenderer->AddBasePassBatch();
+        Dispatch(bassPassBatch, pBasePassPSO);
+    }
 #else
-    Draw(bassPassBatch, m_pMaterial->GetPSO());
+    IGfxPipelineState* pBasePassPSO = m_pMaterial->GetPSO();
+    if (pBasePassPSO)
+    {
+        RenderBatch& bassPassBatch = pRenderer->AddBasePassBatch();
+        Draw(bassPassBatch, pBasePassPSO);
+    }
 #endif
 
     if (!nearly_equal(m_instanceData.mtxPrevWorld, m_instanceData.mtxWorld))
     {
-        RenderBatch& velocityPassBatch = pRenderer->AddVelocityPassBatch();
-        Draw(velocityPassBatch, m_pMaterial->GetVelocityPSO());
+        IGfxPipelineState* pVelocityPSO = m_pMaterial->GetVelocityPSO();
+        if (pVelocityPSO)
+        {
+            RenderBatch& velocityPassBatch = pRenderer->AddVelocityPassBatch();
+            Draw(velocityPassBatch, pVelocityPSO);
+        }
     }
 
     if (pRenderer->IsEnableMouseHitTest())
     {
-        RenderBatch& idPassBatch = pRenderer->AddObjectIDPassBatch();
-        Draw(idPassBatch, m_pMaterial->GetIDPSO());
+        IGfxPipelineState* pIDPSO = m_pMaterial->GetIDPSO();
+        if (pIDPSO)
+        {
+            RenderBatch& idPassBatch = pRenderer->AddObjectIDPassBatch();
+            Draw(idPassBatch, pIDPSO);
+        }
     }
 
     if (m_nID == pRenderer->GetMouseHitObjectID())
     {
-        RenderBatch& outlinePassBatch = pRenderer->AddForwardPassBatch();
-        Draw(outlinePassBatch, m_pMaterial->GetOutlinePSO());
+        IGfxPipelineState* pOutlinePSO = m_pMaterial->GetOutlinePSO();
+        if (pOutlinePSO)
+        {
+            RenderBatch& outlinePassBatch = pRenderer->AddForwardPassBatch();
+            Draw(outlinePassBatch, pOutlinePSO);
+        }
     }
 }
 
@@ -10,6 +10,8 @@ public:
 
     virtual bool Create() = 0;
     virtual void Tick(float delta_time) = 0;
+    virtual bool IsAnimated() const { return false; }
+    virtual void UpdateAnimation(float delta_time) {} //called on worker threads before Tick
     virtual void Render(Renderer* pRenderer) {}
     virtual bool FrustumCull(const float4* planes, uint32_t plane_count) const { return true; }
     virtual void OnGui();
@@ -1,6 +1,7 @@
 #include "world.h"
 #include "core/engine.h"
 #include "gltf_loader.h"
+#include "skeletal_mesh.h"
 #include "sky_sphere.h"
 #include "directional_light.h"
 #include "utils/assert.h"
@@ -45,6 +46,11 @@ void World::AddObject(IVisibleObject* object)
 
     object->SetID((uint32_t)m_objects.size());
     m_objects.push_back(eastl::unique_ptr<IVisibleObject>(object));
+
+    if (object->IsAnimated())
+    {
+        m_animatedObjects.push_back(object);
+    }
 }
 
 void World::AddLight(ILight* light)
@@ -59,6 +65,8 @@ void World::Tick(float delta_time)
 
     m_pCamera->Tick(delta_time);
 
+    UpdateAnimation(delta_time);
+
     for (auto iter = m_objects.begin(); iter != m_objects.end(); ++iter)
     {
         (*iter)->Tick(delta_time);
@@ -109,11 +117,27 @@ ILight* World::GetPrimaryLight() const
 
 void World::ClearScene()
 {
+    m_skeletalMeshes.clear();
+    m_animatedObjects.clear();
     m_objects.clear();
     m_lights.clear();
     m_pPrimaryLight = nullptr;
 }
 
+void World::UpdateAnimation(float delta_time)
+{
+    CPU_EVENT("Tick", "World::UpdateAnimation");
+
+    //each skeleton is independent, only the scene constant allocation is shared and it is thread safe
+    if (!m_animatedObjects.empty())
+    {
+        ParallelFor((uint32_t)m_animatedObjects.size(), [&](uint32_t i)
+            {
+                m_animatedObjects[i]->UpdateAnimation(delta_time);
+            });
+    }
+}
+
 inline float3 str_to_float3(const eastl::string& str)
 {
     eastl::vector<float> v;
@@ -240,8 +264,33 @@ void World::CreateCamera(tinyxml2::XMLElement* element)
 
 void World::CreateModel(tinyxml2::XMLElement* element)
 {
+    //skinned models of the same file share their animation, skeleton, materials and static buffers,
+    //only the transform is read for the later instances, other attributes come from the first one
+    const eastl::string file = element->FindAttribute("file")->Value();
+
+    auto iter = m_skeletalMeshes.find(file);
+    if (iter != m_skeletalMeshes.end())
+    {
+        SkeletalMesh* mesh = iter->second->Instantiate();
+        LoadVisibleObject(element, mesh);
+
+        if (!mesh->Create())
+        {
+            delete mesh;
+            return;
+        }
+
+        AddObject(mesh);
+        return;
+    }
+
     GLTFLoader loader(this, element);
     loader.Load();
+
+    if (loader.GetSkeletalMesh())
+    {
+        m_skeletalMeshes.insert(eastl::make_pair(file, loader.GetSkeletalMesh()));
+    }
 }
 
 void World::CreateSky(tinyxml2::XMLElement* element)
@@ -2,6 +2,9 @@
 
 #include "camera.h"
 #include "light.h"
+#include "EASTL/hash_map.h"
+
+class SkeletalMesh;
 
 namespace tinyxml2
 {
@@ -28,6 +31,7 @@ public:
 
 private:
     void ClearScene();
+    void UpdateAnimation(float delta_time);
 
     void CreateVisibleObject(tinyxml2::XMLElement* element);
     void CreateLight(tinyxml2::XMLElement* element);
@@ -39,7 +43,9 @@ private:
     eastl::unique_ptr<Camera> m_pCamera;
 
     eastl::vector<eastl::unique_ptr<IVisibleObject>> m_objects;
+    eastl::vector<IVisibleObject*> m_animatedObjects;
     eastl::vector<eastl::unique_ptr<ILight>> m_lights;
+    eastl::hash_map<eastl::string, SkeletalMesh*> m_skeletalMeshes; //file -> first loaded instance, the later ones are instantiated from it
 
     ILight* m_pPrimaryLight = nullptr;
 };
\ No newline at end of file